@@ -1,4 +1,4 @@
-#version 130
+#version 140
 
 //input variables are automatically interpolated between vertices.
 in vec3 color;
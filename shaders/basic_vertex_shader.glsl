@@ -1,6 +1,14 @@
-#version 130
+#version 140
 
-uniform mat4 modelViewProjectionMatrix;
+//camera and light, the same for all objects in a frame. Updated once per frame, see RenderQueue.
+layout(std140) uniform SceneParameters {
+    mat4 viewMatrix;
+    mat4 projectionMatrix;
+    vec4 lightPosition;//in camera space (x, y, z).
+    vec4 lightIntensity;//light source intensity per color component (r, g, b).
+    vec4 ambientLightIntensity;//ambient lighting intensity per color component (r, g, b).
+};
+uniform mat4 modelMatrix;
 
 in vec3 vertexPosition;//in model space.
 in vec3 vertexColor;
@@ -9,7 +17,7 @@ in vec3 vertexColor;
 out vec3 color;
 
 void main() {
-    gl_Position = modelViewProjectionMatrix * vec4(vertexPosition, 1);
+    gl_Position = projectionMatrix * (viewMatrix * (modelMatrix * vec4(vertexPosition, 1)));
 
     color = vertexColor;
 }
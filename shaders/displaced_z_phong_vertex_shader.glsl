@@ -1,7 +1,14 @@
-#version 130
+#version 140
 
-uniform mat4 modelViewProjectionMatrix;
-uniform mat4 modelViewMatrix;
+//camera and light, the same for all objects in a frame. Updated once per frame, see RenderQueue.
+layout(std140) uniform SceneParameters {
+    mat4 viewMatrix;
+    mat4 projectionMatrix;
+    vec4 lightPosition;//in camera space (x, y, z).
+    vec4 lightIntensity;//light source intensity per color component (r, g, b).
+    vec4 ambientLightIntensity;//ambient lighting intensity per color component (r, g, b).
+};
+uniform mat4 modelMatrix;
 
 in vec3 vertexPosition;//in model space.
 in vec3 vertexNormal;//in model space.
@@ -19,8 +26,9 @@ out vec3 fragmentDiffuseColor;//diffuse reflection coefficient per color compone
  * This can be used for example to change the shape of a horizontal fluid surface every frame.
  */
 void main() {
+    mat4 modelViewMatrix = viewMatrix * modelMatrix;
     vec3 displacedVertexPosition = vec3(vertexPosition.xy, vertexPosition.z + vertexZDisplacement);
-    gl_Position = modelViewProjectionMatrix * vec4(displacedVertexPosition, 1);
+    gl_Position = projectionMatrix * (modelViewMatrix * vec4(displacedVertexPosition, 1));
 
     vec4 displacedVertexPositionInCameraSpace = modelViewMatrix * vec4(displacedVertexPosition, 1);
     vec4 vertexNormalInCameraSpace = modelViewMatrix * vec4(vertexNormal, 0);
@@ -0,0 +1,59 @@
+#version 140
+
+//camera and light, the same for all objects in a frame. Updated once per frame, see RenderQueue.
+layout(std140) uniform SceneParameters {
+    mat4 viewMatrix;
+    mat4 projectionMatrix;
+    vec4 lightPosition;//in camera space (x, y, z).
+    vec4 lightIntensity;//light source intensity per color component (r, g, b).
+    vec4 ambientLightIntensity;//ambient lighting intensity per color component (r, g, b).
+};
+uniform mat4 modelMatrix;
+uniform sampler2D heightTexture;//z displacements relative to the (constant) vertexPosition in model space, one texel per vertex.
+uniform int rowPitch;//number of texels between the starts of two consecutive rows.
+uniform ivec2 gridSize;//number of columns and rows.
+uniform vec2 gridSpacing;//distance between adjacent columns and rows in model space.
+
+in vec3 vertexPosition;//in model space.
+in vec3 vertexColor;
+
+//output variables are sent to the fragment shader and are automatically interpolated between vertices.
+out vec3 fragmentPosition;//in camera space.
+out vec3 fragmentNormalVector;//in camera space.
+out vec3 fragmentDiffuseColor;//diffuse reflection coefficient per color component (r, g, b).
+
+float getZDisplacement(int column, int row) {
+    return texelFetch(heightTexture, ivec2(column, row), 0).r;
+}
+
+/**
+ * Implements Phong shading, see https://en.wikipedia.org/wiki/Phong_shading
+ * The z coordinate of each vertex is displaced by the value in a height texture and the normal vector
+ * is reconstructed from the neighbouring heights, so that only one float per vertex needs to be updated every frame.
+ * This can be used for example to change the shape of a horizontal fluid surface every frame.
+ */
+void main() {
+    mat4 modelViewMatrix = viewMatrix * modelMatrix;
+    //the vertex with a given row and column has index row * rowPitch + column (gl_VertexID includes the base vertex of the draw call).
+    int row = gl_VertexID / rowPitch;
+    int column = gl_VertexID - row * rowPitch;
+    vec3 displacedVertexPosition = vec3(vertexPosition.xy, vertexPosition.z + getZDisplacement(column, row));
+    gl_Position = projectionMatrix * (modelViewMatrix * vec4(displacedVertexPosition, 1));
+
+    //central difference approximations of the first derivatives for interior vertices,
+    //forward or backward difference approximations at the edges, the same as WaterSurface.
+    int westColumn = max(column - 1, 0);
+    int eastColumn = min(column + 1, gridSize.x - 1);
+    int southRow = max(row - 1, 0);
+    int northRow = min(row + 1, gridSize.y - 1);
+    float gradientX = (getZDisplacement(eastColumn, row) - getZDisplacement(westColumn, row)) / (float(eastColumn - westColumn) * gridSpacing.x);
+    float gradientY = (getZDisplacement(column, northRow) - getZDisplacement(column, southRow)) / (float(northRow - southRow) * gridSpacing.y);
+    //surface normal vector = cross product of the tangent vectors (1, 0, gradientX) and (0, 1, gradientY).
+    vec3 vertexNormal = normalize(vec3(-gradientX, -gradientY, 1));
+
+    vec4 displacedVertexPositionInCameraSpace = modelViewMatrix * vec4(displacedVertexPosition, 1);
+    vec4 vertexNormalInCameraSpace = modelViewMatrix * vec4(vertexNormal, 0);
+    fragmentPosition = displacedVertexPositionInCameraSpace.xyz;
+    fragmentNormalVector = vertexNormalInCameraSpace.xyz;
+    fragmentDiffuseColor = vertexColor;
+}
@@ -0,0 +1,39 @@
+#version 140
+
+//camera and light, the same for all objects in a frame. Updated once per frame, see RenderQueue.
+layout(std140) uniform SceneParameters {
+    mat4 viewMatrix;
+    mat4 projectionMatrix;
+    vec4 lightPosition;//in camera space (x, y, z).
+    vec4 lightIntensity;//light source intensity per color component (r, g, b).
+    vec4 ambientLightIntensity;//ambient lighting intensity per color component (r, g, b).
+};
+
+in vec3 vertexPosition;//in model space.
+in vec3 vertexNormal;//in model space.
+in vec3 vertexColor;
+//per instance: translation (x, y, z) from model space to world space and uniform scale factor (w).
+in vec4 instanceTransform;
+//per instance: factor per color component (r, g, b) of the vertex colors.
+in vec3 instanceColor;
+
+//output variables are sent to the fragment shader and are automatically interpolated between vertices.
+out vec3 fragmentPosition;//in camera space.
+out vec3 fragmentNormalVector;//in camera space.
+out vec3 fragmentDiffuseColor;//diffuse reflection coefficient per color component (r, g, b).
+
+/**
+ * Implements Phong shading, see https://en.wikipedia.org/wiki/Phong_shading
+ * Draws many instances of the same mesh, each with its own position, size and color, see InstancedPhongShader.
+ * The scale is uniform, so the normal vectors can be transformed with the view matrix.
+ */
+void main() {
+    vec4 vertexPositionInWorldSpace = vec4(instanceTransform.xyz + instanceTransform.w * vertexPosition, 1);
+    vec4 vertexPositionInCameraSpace = viewMatrix * vertexPositionInWorldSpace;
+    gl_Position = projectionMatrix * vertexPositionInCameraSpace;
+
+    vec4 vertexNormalInCameraSpace = viewMatrix * vec4(vertexNormal, 0);
+    fragmentPosition = vertexPositionInCameraSpace.xyz;
+    fragmentNormalVector = vertexNormalInCameraSpace.xyz;
+    fragmentDiffuseColor = instanceColor * vertexColor;
+}
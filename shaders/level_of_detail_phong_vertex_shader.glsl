@@ -0,0 +1,78 @@
+#version 140
+
+//camera and light, the same for all objects in a frame. Updated once per frame, see RenderQueue.
+layout(std140) uniform SceneParameters {
+    mat4 viewMatrix;
+    mat4 projectionMatrix;
+    vec4 lightPosition;//in camera space (x, y, z).
+    vec4 lightIntensity;//light source intensity per color component (r, g, b).
+    vec4 ambientLightIntensity;//ambient lighting intensity per color component (r, g, b).
+};
+uniform mat4 modelMatrix;
+uniform sampler2D heightTexture;//z displacements in model space, one texel per grid vertex, with mipmaps.
+uniform ivec2 gridSize;//number of columns and rows.
+uniform vec2 gridSpacing;//distance between adjacent columns and rows in model space.
+uniform float lodRange;//distance from the camera (in model space) at which level 0 is completely morphed into level 1, doubles per level.
+uniform float morphStartFraction;//fraction of the distance between the ranges of two levels after which the morph starts.
+uniform vec3 diffuseColor;
+
+in vec2 vertexPosition;//column and row of the vertex within its patch.
+in vec3 patchTransform;//per patch: first column and row of the patch in the grid and number of grid cells between adjacent vertices of the patch.
+
+//output variables are sent to the fragment shader and are automatically interpolated between vertices.
+out vec3 fragmentPosition;//in camera space.
+out vec3 fragmentNormalVector;//in camera space.
+out vec3 fragmentDiffuseColor;//diffuse reflection coefficient per color component (r, g, b).
+
+//returns the flat position in model space of the given fractional column and row of the grid.
+vec3 getPosition(vec2 gridPosition) {
+    return vec3((gridPosition - 0.5 * vec2(gridSize - 1)) * gridSpacing, 0);
+}
+
+//returns the bilinearly interpolated z displacement at the given fractional column and row, at the given mipmap level.
+float getZDisplacement(vec2 gridPosition, float mipmapLevel) {
+    return textureLod(heightTexture, (gridPosition + 0.5) / vec2(gridSize), mipmapLevel).r;
+}
+
+/**
+ * Implements Phong shading (see https://en.wikipedia.org/wiki/Phong_shading) for a patch of a level of detail water surface,
+ * see LevelOfDetailWaterSurfaceView. All patches share the same vertex grid, which is scaled and translated per patch.
+ * A patch of level L has 2^L grid cells between adjacent vertices. Towards the end of the range of its level, every vertex
+ * gradually moves onto the vertex grid of level L + 1 (geomorphing), so that there are no cracks or popping at the seams
+ * between patches of different levels. The z displacements are read from the height texture at the matching mipmap level.
+ */
+void main() {
+    mat4 modelViewMatrix = viewMatrix * modelMatrix;
+    float cellsPerVertex = patchTransform.z;
+    vec2 maxGridPosition = vec2(gridSize - 1);
+
+    //distance of the flat vertex from the camera, the same distance that is used for selecting the patches.
+    vec2 gridPosition = min(patchTransform.xy + vertexPosition * cellsPerVertex, maxGridPosition);
+    float distanceToCamera = length((modelViewMatrix * vec4(getPosition(gridPosition), 1)).xyz);
+
+    //morph the odd vertices onto the midpoint between their even neighbours, i.e. onto the vertex grid of the next level.
+    float morphEnd = lodRange * cellsPerVertex;
+    float morphStart = morphEnd * (0.5 + 0.5 * morphStartFraction);
+    float morph = clamp((distanceToCamera - morphStart) / (morphEnd - morphStart), 0, 1);
+    vec2 morphedVertexPosition = vertexPosition - fract(vertexPosition * 0.5) * 2 * morph;
+    gridPosition = min(patchTransform.xy + morphedVertexPosition * cellsPerVertex, maxGridPosition);
+
+    //sample the heights at the resolution of the patch, blending into the next mipmap level while morphing.
+    float mipmapLevel = log2(cellsPerVertex) + morph;
+    float sampleDistance = exp2(mipmapLevel);//in grid cells.
+    vec3 displacedVertexPosition = getPosition(gridPosition);
+    displacedVertexPosition.z = getZDisplacement(gridPosition, mipmapLevel);
+    gl_Position = projectionMatrix * (modelViewMatrix * vec4(displacedVertexPosition, 1));
+
+    //central difference approximations of the first derivatives at the resolution of the patch.
+    float gradientX = (getZDisplacement(gridPosition + vec2(sampleDistance, 0), mipmapLevel) - getZDisplacement(gridPosition - vec2(sampleDistance, 0), mipmapLevel)) / (2 * sampleDistance * gridSpacing.x);
+    float gradientY = (getZDisplacement(gridPosition + vec2(0, sampleDistance), mipmapLevel) - getZDisplacement(gridPosition - vec2(0, sampleDistance), mipmapLevel)) / (2 * sampleDistance * gridSpacing.y);
+    //surface normal vector = cross product of the tangent vectors (1, 0, gradientX) and (0, 1, gradientY).
+    vec3 vertexNormal = normalize(vec3(-gradientX, -gradientY, 1));
+
+    vec4 displacedVertexPositionInCameraSpace = modelViewMatrix * vec4(displacedVertexPosition, 1);
+    vec4 vertexNormalInCameraSpace = modelViewMatrix * vec4(vertexNormal, 0);
+    fragmentPosition = displacedVertexPositionInCameraSpace.xyz;
+    fragmentNormalVector = vertexNormalInCameraSpace.xyz;
+    fragmentDiffuseColor = diffuseColor;
+}
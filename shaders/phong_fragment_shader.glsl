@@ -1,8 +1,13 @@
-#version 130
-
-uniform vec3 lightPosition;//in camera space.
-uniform vec3 lightIntensity;//light source intensity per color component (r, g, b).
-uniform vec3 ambientLightIntensity;//ambient lighting intensity per color component (r, g, b).
+#version 140
+
+//camera and light, the same for all objects in a frame. Updated once per frame, see RenderQueue.
+layout(std140) uniform SceneParameters {
+    mat4 viewMatrix;
+    mat4 projectionMatrix;
+    vec4 lightPosition;//in camera space (x, y, z).
+    vec4 lightIntensity;//light source intensity per color component (r, g, b).
+    vec4 ambientLightIntensity;//ambient lighting intensity per color component (r, g, b).
+};
 uniform float specularReflectionCoefficient;
 uniform float shininess;
 
@@ -19,7 +24,7 @@ out vec4 fragmentColor;
  */
 void main() {
     //calculate directions as seen from fragmentPosition.
-    vec3 lightDirection = lightPosition - fragmentPosition;
+    vec3 lightDirection = lightPosition.xyz - fragmentPosition;
     float distanceFromFragmentToLight = length(lightDirection);
     lightDirection = normalize(lightDirection);
     vec3 viewDirection = normalize(-fragmentPosition);
@@ -27,10 +32,10 @@ void main() {
     vec3 reflectionDirection = reflect(-lightDirection, surfaceNormal);
 
     //incident intensity.
-    vec3 incidentIntensity = lightIntensity/pow(distanceFromFragmentToLight, 2);
+    vec3 incidentIntensity = lightIntensity.rgb/pow(distanceFromFragmentToLight, 2);
 
     //ambient light.
-    vec3 ambientIntensity = fragmentDiffuseColor * ambientLightIntensity;
+    vec3 ambientIntensity = fragmentDiffuseColor * ambientLightIntensity.rgb;
 
     //diffuse reflection.
     float lambertian = max(dot(surfaceNormal, lightDirection), 0);
@@ -1,7 +1,14 @@
-#version 130
+#version 140
 
-uniform mat4 modelViewProjectionMatrix;
-uniform mat4 modelViewMatrix;
+//camera and light, the same for all objects in a frame. Updated once per frame, see RenderQueue.
+layout(std140) uniform SceneParameters {
+    mat4 viewMatrix;
+    mat4 projectionMatrix;
+    vec4 lightPosition;//in camera space (x, y, z).
+    vec4 lightIntensity;//light source intensity per color component (r, g, b).
+    vec4 ambientLightIntensity;//ambient lighting intensity per color component (r, g, b).
+};
+uniform mat4 modelMatrix;
 
 in vec3 vertexPosition;//in model space.
 in vec3 vertexNormal;//in model space.
@@ -16,7 +23,8 @@ out vec3 fragmentDiffuseColor;//diffuse reflection coefficient per color compone
  * Implements Phong shading, see https://en.wikipedia.org/wiki/Phong_shading
  */
 void main() {
-    gl_Position = modelViewProjectionMatrix * vec4(vertexPosition, 1);
+    mat4 modelViewMatrix = viewMatrix * modelMatrix;
+    gl_Position = projectionMatrix * (modelViewMatrix * vec4(vertexPosition, 1));
 
     vec4 vertexPositionInCameraSpace = modelViewMatrix * vec4(vertexPosition, 1);
     vec4 vertexNormalInCameraSpace = modelViewMatrix * vec4(vertexNormal, 0);
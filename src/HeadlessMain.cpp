@@ -0,0 +1,359 @@
+/*
+ * Copyright (c) 2018 A.C. Kockx, All Rights Reserved.
+ *
+ * Runs the toy model simulation of a beach ball floating on a water surface without rendering,
+ * i.e. without a window, OpenGL context or graphics card. The simulation is advanced
+ * for a given number of time steps as fast as possible and the achieved number of steps/second is reported.
+ * This can be used to run, scale-test and profile the solver on machines without a GPU.
+ *
+ * Usage: SimulationHeadless [--steps stepCount] [--rows rowCount] [--columns columnCount] [--threads threadCount] [--instruction-set scalar|sse|avx2|avx512] [--solver explicit|adi|spectral] [--substeps substepCount] [--temporal-block-size temporalBlockSize] [--active-tiles on|off] [--beach-balls beachBallCount] [--water-displacement on|off] [--profile traceFileName] [--verify]
+ *
+ * --threads sets the number of threads, by default one thread per hardware thread is used.
+ * --instruction-set selects the implementation of the solver kernels, by default the widest instruction set that the processor supports is used.
+ * --solver selects the numerical scheme of the water surface, see WaterSurface::setSolverType (default explicit).
+ * --substeps sets the minimum number of time steps of the water surface per simulation step (default 1).
+ * More time steps are used automatically if that is needed for the water surface solver to be stable.
+ * --temporal-block-size sets the maximum number of water surface time steps that are advanced per cache-resident tile (default 8).
+ * --active-tiles sets whether the explicit solver only advances the disturbed tiles of the water surface, see WaterSurface::setActiveTilesEnabled (default on).
+ * --beach-balls adds the given number of small beach balls at pseudo-random positions above the water surface (default 0), to scale-test the body solver.
+ * --water-displacement sets whether the bodies push the water surface, see Simulation::setWaterDisplacementEnabled (default on).
+ * --profile measures the phases of every time step, prints their statistics and writes a Chrome trace to the given file, see Profiler.
+ * --verify additionally runs the same simulation with the same solver and active tiles setting with the scalar reference kernels on a single thread
+ * without temporal blocking and checks that the results (water surface and bodies) are bitwise identical. If active tiles are enabled,
+ * it also runs the water surface without extra beach balls and water displacement with and without active tiles (full sweep) and checks
+ * that the largest difference in surface height is at most the total height that the updates of the active tiles can have flattened
+ * (a heuristic bound), see WaterSurface::getActiveTileUpdateCount.
+ *
+ * This program requires the following external dependencies in order to work:
+ * - OpenGL Mathematics (GLM) version 0.9.9.0
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+
+#include "scene/Simulation.h"
+#include "util/CpuFeatures.h"
+#include "util/ModelUtils.h"
+#include "util/Profiler.h"
+
+using namespace std::chrono;
+
+static const int DEFAULT_STEP_COUNT = 1000;
+static const int DEFAULT_ROW_COUNT = 100;
+static const int DEFAULT_COLUMN_COUNT = 100;
+static const float DELTA_T = 1 / 60.0f;//simulation time step in seconds.
+static const float SMALL_BEACH_BALL_MASS = 0.001f;//in kg, light enough to float.
+static const float SMALL_BEACH_BALL_RADIUS = 0.02f;//in m.
+
+static void printUsage() {
+    fprintf(stderr, "Usage: SimulationHeadless [--steps stepCount] [--rows rowCount] [--columns columnCount] [--threads threadCount] [--instruction-set scalar|sse|avx2|avx512] [--solver explicit|adi|spectral] [--substeps substepCount] [--temporal-block-size temporalBlockSize] [--active-tiles on|off] [--beach-balls beachBallCount] [--water-displacement on|off] [--profile traceFileName] [--verify]\n");
+}
+
+/**
+ * Creates a simulation with some waves in it, so that the solver has something to do.
+ */
+static Simulation* createSimulation(int rowCount, int columnCount, int threadCount, int instructionSet, int solverType, int substepCount, int temporalBlockSize, bool activeTilesEnabled, int beachBallCount, bool waterDisplacementEnabled) {
+    Simulation* simulation = new Simulation(rowCount, columnCount, threadCount);
+    simulation->setMinimumWaterSurfaceSubstepCount(substepCount);
+    simulation->getWaterSurface()->setSolverType(solverType);
+    simulation->setInstructionSet(instructionSet);
+    if (temporalBlockSize > 0) {
+        simulation->getWaterSurface()->setTemporalBlockSize(temporalBlockSize);
+    }
+    simulation->getWaterSurface()->setActiveTilesEnabled(activeTilesEnabled);
+    simulation->setWaterDisplacementEnabled(waterDisplacementEnabled);
+    simulation->interact(ADD_WAVE_IN_SOUTH_WEST_CORNER_INTERACTION_TYPE);
+    simulation->interact(ADD_WAVE_IN_NORTH_EAST_CORNER_INTERACTION_TYPE);
+
+    //the positions are generated with a fixed seed, so that every run gets the same positions.
+    unsigned int seed = 1;
+    for (int n = 0; n < beachBallCount; n++) {
+        float coordinates[3];
+        for (int k = 0; k < 3; k++) {
+            seed = seed * 1664525u + 1013904223u;
+            coordinates[k] = (seed >> 8) / 16777216.0f;
+        }
+        simulation->addBeachBall(SMALL_BEACH_BALL_MASS, SMALL_BEACH_BALL_RADIUS, 1.9f * coordinates[0] - 0.95f, 1.9f * coordinates[1] - 0.95f, 0.6f + 0.8f * coordinates[2]);
+    }
+    return simulation;
+}
+
+/**
+ * Returns the average cache miss ratio (see getAverageCacheMissRatio) of the triangles of a band of the given water surface
+ * in the given index order, where a band has as many rows as WaterSurfaceView draws with 16-bit indices. Returns 0 if not even a single row fits.
+ */
+static float getWaterSurfaceCacheMissRatio(WaterSurface* waterSurface, int indexOrder) {
+    int columnCount = waterSurface->getColumnCount();
+    int bandQuadRowCount = std::min(getMaxShortIndexQuadRowCount(columnCount, waterSurface->getRowPitch()), waterSurface->getRowCount() - 1);
+    if (bandQuadRowCount == 0) {
+        return 0;
+    }
+    vector<unsigned int> indices;
+    createGridIndices(0, 0, bandQuadRowCount, columnCount - 1, waterSurface->getRowPitch(), indexOrder, VERTEX_CACHE_SIZE, indices);
+    return getAverageCacheMissRatio(indices, false, VERTEX_CACHE_SIZE);
+}
+
+/**
+ * Returns the number of vertices for which the surface heights or surface gradients of the given water surfaces are not bitwise identical.
+ */
+static int countDifferences(WaterSurface* waterSurface, WaterSurface* referenceWaterSurface) {
+    int rowPitch = waterSurface->getRowPitch();
+    int differenceCount = 0;
+    for (int row = 0; row < waterSurface->getRowCount(); row++) {
+        const float* values = waterSurface->getSurfaceHeightValues() + row * rowPitch;
+        const float* referenceValues = referenceWaterSurface->getSurfaceHeightValues() + row * rowPitch;
+        for (int column = 0; column < waterSurface->getColumnCount(); column++) {
+            int vertexIndex = row * rowPitch + column;
+            vec2 gradient = waterSurface->getSurfaceGradient(vertexIndex);
+            vec2 referenceGradient = referenceWaterSurface->getSurfaceGradient(vertexIndex);
+            if (memcmp(&values[column], &referenceValues[column], sizeof(float)) != 0 || memcmp(&gradient, &referenceGradient, sizeof(vec2)) != 0) {
+                differenceCount++;
+            }
+        }
+    }
+    return differenceCount;
+}
+
+/**
+ * Returns the largest absolute difference (in m) between the surface heights of the given water surfaces.
+ */
+static float getMaxHeightDifference(WaterSurface* waterSurface, WaterSurface* referenceWaterSurface) {
+    int rowPitch = waterSurface->getRowPitch();
+    float maxDifference = 0;
+    for (int row = 0; row < waterSurface->getRowCount(); row++) {
+        const float* values = waterSurface->getSurfaceHeightValues() + row * rowPitch;
+        const float* referenceValues = referenceWaterSurface->getSurfaceHeightValues() + row * rowPitch;
+        for (int column = 0; column < waterSurface->getColumnCount(); column++) {
+            maxDifference = std::max(maxDifference, fabsf(values[column] - referenceValues[column]));
+        }
+    }
+    return maxDifference;
+}
+
+/**
+ * Returns the number of bodies for which the positions or velocities in the given body stores are not bitwise identical.
+ */
+static int countDifferences(BodyStore* bodyStore, BodyStore* referenceBodyStore) {
+    int differenceCount = 0;
+    for (int body = 0; body < bodyStore->getBodyCount(); body++) {
+        vec3 position = bodyStore->getPosition(body);
+        vec3 referencePosition = referenceBodyStore->getPosition(body);
+        vec3 velocity = bodyStore->getVelocity(body);
+        vec3 referenceVelocity = referenceBodyStore->getVelocity(body);
+        if (memcmp(&position, &referencePosition, sizeof(vec3)) != 0 || memcmp(&velocity, &referenceVelocity, sizeof(vec3)) != 0) {
+            differenceCount++;
+        }
+    }
+    return differenceCount;
+}
+
+int main(int argc, char* argv[]) {
+    //parse arguments.
+    int stepCount = DEFAULT_STEP_COUNT;
+    int rowCount = DEFAULT_ROW_COUNT;
+    int columnCount = DEFAULT_COLUMN_COUNT;
+    int threadCount = 0;
+    int instructionSet = getBestSupportedInstructionSet();
+    int solverType = EXPLICIT_SOLVER_TYPE;
+    int substepCount = 1;
+    int temporalBlockSize = 0;//0 means use the default.
+    bool activeTilesEnabled = true;
+    int beachBallCount = 0;
+    bool waterDisplacementEnabled = true;
+    const char* traceFileName = NULL;
+    bool verify = false;
+    for (int n = 1; n < argc; n++) {
+        if (strcmp(argv[n], "--verify") == 0) {
+            verify = true;
+            continue;
+        }
+        if (n + 1 >= argc) {//if option without value.
+            printUsage();
+            return -1;
+        }
+
+        if (strcmp(argv[n], "--steps") == 0) {
+            stepCount = atoi(argv[++n]);
+        } else if (strcmp(argv[n], "--rows") == 0) {
+            rowCount = atoi(argv[++n]);
+        } else if (strcmp(argv[n], "--columns") == 0) {
+            columnCount = atoi(argv[++n]);
+        } else if (strcmp(argv[n], "--threads") == 0) {
+            threadCount = atoi(argv[++n]);
+        } else if (strcmp(argv[n], "--solver") == 0) {
+            n++;
+            if (strcmp(argv[n], "explicit") == 0) {
+                solverType = EXPLICIT_SOLVER_TYPE;
+            } else if (strcmp(argv[n], "adi") == 0) {
+                solverType = ADI_SOLVER_TYPE;
+            } else if (strcmp(argv[n], "spectral") == 0) {
+                solverType = SPECTRAL_SOLVER_TYPE;
+            } else {
+                printUsage();
+                return -1;
+            }
+        } else if (strcmp(argv[n], "--substeps") == 0) {
+            substepCount = atoi(argv[++n]);
+        } else if (strcmp(argv[n], "--temporal-block-size") == 0) {
+            temporalBlockSize = atoi(argv[++n]);
+            if (temporalBlockSize <= 0) {
+                printUsage();
+                return -1;
+            }
+        } else if (strcmp(argv[n], "--active-tiles") == 0) {
+            n++;
+            if (strcmp(argv[n], "on") == 0) {
+                activeTilesEnabled = true;
+            } else if (strcmp(argv[n], "off") == 0) {
+                activeTilesEnabled = false;
+            } else {
+                printUsage();
+                return -1;
+            }
+        } else if (strcmp(argv[n], "--beach-balls") == 0) {
+            beachBallCount = atoi(argv[++n]);
+            if (beachBallCount < 0) {
+                printUsage();
+                return -1;
+            }
+        } else if (strcmp(argv[n], "--water-displacement") == 0) {
+            n++;
+            if (strcmp(argv[n], "on") == 0) {
+                waterDisplacementEnabled = true;
+            } else if (strcmp(argv[n], "off") == 0) {
+                waterDisplacementEnabled = false;
+            } else {
+                printUsage();
+                return -1;
+            }
+        } else if (strcmp(argv[n], "--profile") == 0) {
+            traceFileName = argv[++n];
+        } else if (strcmp(argv[n], "--instruction-set") == 0) {
+            instructionSet = getInstructionSetByName(argv[++n]);
+            if (instructionSet == -1) {
+                printUsage();
+                return -1;
+            }
+            if (!isInstructionSetSupported(instructionSet)) {
+                fprintf(stderr, "Instruction set %s is not supported by this processor\n", argv[n]);
+                return -1;
+            }
+        } else {
+            printUsage();
+            return -1;
+        }
+    }
+    //the finite-difference approximations at the edges need at least 3 rows and columns.
+    if (stepCount <= 0 || rowCount < 3 || columnCount < 3 || threadCount < 0 || substepCount <= 0) {
+        printUsage();
+        return -1;
+    }
+
+    //create simulation.
+    Simulation* simulation = createSimulation(rowCount, columnCount, threadCount, instructionSet, solverType, substepCount, temporalBlockSize, activeTilesEnabled, beachBallCount, waterDisplacementEnabled);
+
+    //simulation loop.
+    if (traceFileName != NULL) {
+        Profiler::setThreadName("main");
+        Profiler::setEnabled(true);
+    }
+    high_resolution_clock::time_point startTime = high_resolution_clock::now();
+    for (int step = 0; step < stepCount; step++) {
+        simulation->advanceSimulation(DELTA_T);
+        if (traceFileName != NULL) {
+            Profiler::collect();
+        }
+    }
+    high_resolution_clock::time_point endTime = high_resolution_clock::now();
+    duration<double> calculationTime = (duration_cast<nanoseconds>) (endTime - startTime);
+
+    //checksum of the final state, can be used to compare results between runs.
+    WaterSurface* waterSurface = simulation->getWaterSurface();
+    const float* surfaceHeightValues = waterSurface->getSurfaceHeightValues();
+    int rowPitch = waterSurface->getRowPitch();
+    double checksum = 0;
+    for (int row = 0; row < rowCount; row++) {
+        for (int column = 0; column < columnCount; column++) {
+            checksum += surfaceHeightValues[row * rowPitch + column];
+        }
+    }
+    BodyStore* sphereBodies = simulation->getSphereBodies();
+    double bodyChecksum = 0;
+    for (int body = 0; body < sphereBodies->getBodyCount(); body++) {
+        bodyChecksum += sphereBodies->getPosition(body)[2];
+    }
+
+    //report results.
+    printf("Grid size = %i x %i\n", rowCount, columnCount);
+    printf("Threads = %i\n", simulation->getThreadPool()->getThreadCount());
+    printf("Instruction set = %s\n", getInstructionSetName(instructionSet));
+    printf("Solver = %s\n", solverType == SPECTRAL_SOLVER_TYPE ? "spectral" : solverType == ADI_SOLVER_TYPE ? "adi" : "explicit");
+    printf("Steps = %i\n", stepCount);
+    printf("Substeps = %i (CFL margin = %.3f)\n", simulation->getWaterSurfaceSubstepCount(), simulation->getWaterSurfaceCflMargin());
+    printf("Temporal block size = %i\n", waterSurface->getTemporalBlockSize());
+    printf("Active tiles = %i of %i\n", waterSurface->getActiveTileCount(), waterSurface->getTileRowCount() * waterSurface->getTileColumnCount());
+    printf("Water surface ACMR = %.3f (row-major order = %.3f)\n", getWaterSurfaceCacheMissRatio(waterSurface, BLOCK_INDEX_ORDER),
+            getWaterSurfaceCacheMissRatio(waterSurface, ROW_MAJOR_INDEX_ORDER));
+    printf("Time = %.3f s\n", calculationTime.count());
+    printf("Steps/second = %.1f\n", stepCount / calculationTime.count());
+    printf("Beach balls = %i (%i collisions in the last step)\n", sphereBodies->getBodyCount(), simulation->getSphereCollisions()->getCollisionCount());
+    printf("Checksum = %.9g\n", checksum);
+    printf("Body checksum = %.9g\n", bodyChecksum);
+    if (traceFileName != NULL) {
+        Profiler::setEnabled(false);
+        Profiler::printStatistics(stdout);
+        if (!Profiler::writeChromeTrace(traceFileName)) {
+            fprintf(stderr, "Error while writing %s\n", traceFileName);
+        }
+    }
+
+    //compare with scalar reference implementation.
+    int exitCode = 0;
+    if (verify) {
+        Simulation* referenceSimulation = createSimulation(rowCount, columnCount, 1, SCALAR_INSTRUCTION_SET, solverType, substepCount, 1, activeTilesEnabled, beachBallCount, waterDisplacementEnabled);
+        for (int step = 0; step < stepCount; step++) {
+            referenceSimulation->advanceSimulation(DELTA_T);
+        }
+        int differenceCount = countDifferences(waterSurface, referenceSimulation->getWaterSurface());
+        int bodyDifferenceCount = countDifferences(sphereBodies, referenceSimulation->getSphereBodies());
+        printf("Verification = %s (%i vertices and %i bodies differ from scalar reference)\n", differenceCount == 0 && bodyDifferenceCount == 0 ? "passed" : "FAILED",
+                differenceCount, bodyDifferenceCount);
+        if (differenceCount != 0 || bodyDifferenceCount != 0) {
+            exitCode = -1;
+        }
+        delete referenceSimulation;
+
+        //the active tiles only skip vertices whose surface heights are at most ACTIVE_TILE_EPSILON, so compare with a full sweep.
+        //The bodies react to the small differences in surface height, which change the waves that they make, so both runs only
+        //contain the water (without extra beach balls and water displacement). Every update of the active tiles flattens surface heights
+        //of at most ACTIVE_TILE_EPSILON, but the waves that are dropped at the edges of inactive tiles are not strictly bounded by that,
+        //so the allowed difference is a heuristic.
+        if (activeTilesEnabled && solverType == EXPLICIT_SOLVER_TYPE) {
+            Simulation* activeTilesSimulation = createSimulation(rowCount, columnCount, threadCount, instructionSet, solverType, substepCount, temporalBlockSize, true, 0, false);
+            Simulation* fullSweepSimulation = createSimulation(rowCount, columnCount, threadCount, instructionSet, solverType, substepCount, temporalBlockSize, false, 0, false);
+            for (int step = 0; step < stepCount; step++) {
+                activeTilesSimulation->advanceSimulation(DELTA_T);
+                fullSweepSimulation->advanceSimulation(DELTA_T);
+            }
+            WaterSurface* activeTilesWaterSurface = activeTilesSimulation->getWaterSurface();
+            float maxHeightDifference = getMaxHeightDifference(activeTilesWaterSurface, fullSweepSimulation->getWaterSurface());
+            float maxAllowedHeightDifference = activeTilesWaterSurface->getActiveTileUpdateCount() * WaterSurface::ACTIVE_TILE_EPSILON;
+            printf("Active tiles verification = %s (largest height difference from full sweep = %.3g m, at most %.3g m allowed)\n",
+                    maxHeightDifference <= maxAllowedHeightDifference ? "passed" : "FAILED", maxHeightDifference, maxAllowedHeightDifference);
+            if (maxHeightDifference > maxAllowedHeightDifference) {
+                exitCode = -1;
+            }
+            delete activeTilesSimulation;
+            delete fullSweepSimulation;
+        }
+    }
+
+    //tidy up.
+    delete simulation;
+
+    return exitCode;
+}
@@ -3,6 +3,9 @@
  *
  * Uses OpenGL 3 to render a toy model simulation of a beach ball floating on a water surface in 3D.
  * The user can press the Q, W, A and S keys to create waves.
+ * The P key starts profiling, pressing it again stops profiling, prints the statistics of the phases of a frame
+ * and writes a Chrome trace to PROFILE_FILE_NAME, see Profiler.
+ * The simulation runs on its own thread, while the main thread handles input and renders the latest state of the simulation.
  *
  * This program requires the following external dependencies in order to work:
  * - A graphics card that supports OpenGL version 3 or higher.
@@ -15,6 +18,9 @@
 #include <chrono>
 
 #include "util/OpenGLUtils.h"
+#include "util/Profiler.h"
+#include "scene/Simulation.h"
+#include "scene/SimulationThread.h"
 #include "scene/Scene.h"
 
 using namespace std::chrono;
@@ -22,19 +28,32 @@ using namespace std::chrono;
 static const int WINDOW_WIDTH = 1200;//in pixels.
 static const int WINDOW_HEIGHT = 900;//in pixels.
 static const int DESIRED_FRAME_RATE = 60;//in frames/second.
-static const float DELTA_T = 1 / (float)DESIRED_FRAME_RATE;//simulation time step in seconds.
+static const float FRAME_TIME = 1 / (float)DESIRED_FRAME_RATE;//in seconds.
+static const float DELTA_T = 1 / 60.0f;//simulation time step in seconds.
+static const char* PROFILE_FILE_NAME = "profile.json";
+static const int WATER_SURFACE_ROW_COUNT = 100;
+static const int WATER_SURFACE_COLUMN_COUNT = 100;
+static const int SIMULATION_THREAD_COUNT = 0;//0 means one thread per hardware thread.
 
 int main() {
     //create window.
+    Profiler::setThreadName("main");
     GLFWwindow* window = createOpenGLWindow(WINDOW_WIDTH, WINDOW_HEIGHT, "Simulation");
 
-    //create scene.
-    Scene* scene = new Scene();
+    //create simulation and scene.
+    Simulation* simulation = new Simulation(WATER_SURFACE_ROW_COUNT, WATER_SURFACE_COLUMN_COUNT, SIMULATION_THREAD_COUNT);
+    Scene* scene = new Scene(simulation);
+
+    //start simulation thread, from now on the simulation is only accessed via the simulation thread.
+    SimulationThread* simulationThread = new SimulationThread(simulation, DELTA_T);
 
     //render loop.
     glfwSetInputMode(window, GLFW_STICKY_KEYS, GL_TRUE);
+    bool profileKeyPressed = false;
     while (!glfwWindowShouldClose(window)) {
         high_resolution_clock::time_point startTime = high_resolution_clock::now();
+        //move the phases that were measured by the simulation thread and during the previous frame to the profiler statistics.
+        Profiler::collect();
 
         //handle keyboard input.
         glfwPollEvents();
@@ -42,29 +61,41 @@ int main() {
             glfwSetWindowShouldClose(window, 1);//exit.
         }
         if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS) {//'a' key.
-            scene->interact(ADD_WAVE_IN_SOUTH_WEST_CORNER_INTERACTION_TYPE);//add wave.
+            simulationThread->interact(ADD_WAVE_IN_SOUTH_WEST_CORNER_INTERACTION_TYPE);//add wave.
         }
         if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS) {//'s' key.
-            scene->interact(ADD_WAVE_IN_SOUTH_EAST_CORNER_INTERACTION_TYPE);//add wave.
+            simulationThread->interact(ADD_WAVE_IN_SOUTH_EAST_CORNER_INTERACTION_TYPE);//add wave.
         }
         if (glfwGetKey(window, GLFW_KEY_Q) == GLFW_PRESS) {//'q' key.
-            scene->interact(ADD_WAVE_IN_NORTH_WEST_CORNER_INTERACTION_TYPE);//add wave.
+            simulationThread->interact(ADD_WAVE_IN_NORTH_WEST_CORNER_INTERACTION_TYPE);//add wave.
         }
         if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS) {//'w' key.
-            scene->interact(ADD_WAVE_IN_NORTH_EAST_CORNER_INTERACTION_TYPE);//add wave.
+            simulationThread->interact(ADD_WAVE_IN_NORTH_EAST_CORNER_INTERACTION_TYPE);//add wave.
+        }
+        if ((glfwGetKey(window, GLFW_KEY_P) == GLFW_PRESS) != profileKeyPressed) {//'p' key, toggle once per press.
+            profileKeyPressed = !profileKeyPressed;
+            if (profileKeyPressed) {
+                if (Profiler::isEnabled()) {
+                    Profiler::setEnabled(false);
+                    Profiler::collect();
+                    Profiler::printStatistics(stdout);
+                    if (!Profiler::writeChromeTrace(PROFILE_FILE_NAME)) {
+                        fprintf(stderr, "Error while writing %s\n", PROFILE_FILE_NAME);
+                    }
+                } else {
+                    Profiler::setEnabled(true);
+                }
+            }
         }
 
-        //update physics.
-        scene->advanceSimulation(DELTA_T);
-
-        //render scene.
-        scene->render(WINDOW_WIDTH, WINDOW_HEIGHT);
+        //render latest state of the simulation.
+        scene->render(simulationThread->getLatestSnapshot(), WINDOW_WIDTH, WINDOW_HEIGHT);
 
         //sleep for time remaining until next frame.
         high_resolution_clock::time_point endTime = high_resolution_clock::now();
         //truncate calculationTime to nanoseconds.
         duration<double> calculationTime = (duration_cast<nanoseconds>) (endTime - startTime);
-        double sleepTime = DELTA_T - calculationTime.count();
+        double sleepTime = FRAME_TIME - calculationTime.count();
         if (sleepTime > 0) {
             Sleep((DWORD) (sleepTime * 1000));
         }
@@ -74,8 +105,11 @@ int main() {
     }
 
     //tidy up.
-    glfwTerminate();
+    delete simulationThread;
+    //the scene releases OpenGL objects, so delete it while the OpenGL context still exists.
     delete scene;
+    glfwTerminate();
+    delete simulation;
 
     return 0;
 }
@@ -3,53 +3,34 @@
  */
 
 #include "model/ObjectInterface.h"
-#include "shader/PhongShader.h"
+#include "model/BodyStore.h"
 
 #ifndef INCLUDED_BEACHBALL_H
 #define INCLUDED_BEACHBALL_H
 
 /**
- * 3D model of a beach ball.
+ * Physical model of a beach ball.
+ * The state of the beach ball is stored in a BodyStore of spherical bodies, this class is a view onto one body in that store.
  */
 class BeachBall : public ObjectInterface {
     private:
-        //physical properties.
-        float mass;//in kg.
-        float radius;//in m.
-        float x;//in m.
-        float y;//in m.
-        float z;//in m.
-        float vX;//in m/s.
-        float vY;//in m/s.
-        float vZ;//in m/s.
-        mat4 modelMatrix;
-
-        //geometry.
-        const int verticalLevelOfDetail = 60;
-        const int triangleStripCount = 6;
-        GLuint vertexArrayObjectId;
-        GLsizei vertexCountPerTriangleStrip;
-
-        //material.
-        PhongShader shader = PhongShader(0.9f, 15);
-        const float triangleStripColors[3][3] = {
-            {0, 0, 0.9f},//blue.
-            {1, 1, 1},//white.
-            {1, 1, 0},//yellow.
-        };
-
-        void updateModelMatrix();
+        BodyStore* bodyStore;
+        int body;//index in bodyStore.
 
     public:
         /**
-         * Creates a beach ball with the given mass and radius centered on the given coordinates (in world space).
+         * Creates a beach ball with the given mass and radius centered on the given coordinates (in world space), initially at rest.
+         * The beach ball is added to the given store, which must contain spherical bodies and must exist as long as this beach ball.
          */
-        BeachBall(float mass, float radius, float x, float y, float z);
+        BeachBall(BodyStore* bodyStore, float mass, float radius, float x, float y, float z);
+
+        virtual int getObjectType();
 
         /**
          * Getters and setters.
          */
         virtual float getMass();
+        float getRadius();//in m.
         virtual vec3 getPosition();
         virtual void setPosition(vec3 position);
         virtual vec3 getVelocity();
@@ -60,11 +41,6 @@ class BeachBall : public ObjectInterface {
          * Returns the volume (in m3) of the space occupied by this object below the plane with the given z coordinate (in world space).
          */
         virtual float getVolumeBelowZ(float z);
-
-        /**
-         * Draws this object to the current OpenGL context.
-         */
-        virtual void draw(mat4 viewMatrix, mat4 projectionMatrix, float lightPositionInWorldSpace[], float lightIntensity[], float ambientLightIntensity[]);
 };
 
 #endif
@@ -0,0 +1,205 @@
+/*
+ * Copyright (c) 2018 A.C. Kockx, All Rights Reserved.
+ */
+
+#include "model/BodyKernels.h"
+
+#include <algorithm>
+#define _USE_MATH_DEFINES
+#include <math.h>
+#include <emmintrin.h>
+
+#include "util/CpuFeatures.h"
+
+float calculateSphereVolumeBelowZ(float depth, float radius) {
+    //volume of the spherical cap below the plane, which is the whole sphere if the cap is as high as the sphere.
+    float h = std::min(depth, radius + radius);
+    return (float) M_PI * h * h * (3 * radius - h) / 3;
+}
+
+void advanceBodiesScalar(float* positionsX, float* positionsY, float* positionsZ, float* velocitiesX, float* velocitiesY, float* velocitiesZ,
+        const float* radii, int count, const float* boundaries, float deltaT, float gravityVelocityChange) {
+    for (int i = 0; i < count; i++) {
+        float radius = radii[i];
+        float vX = velocitiesX[i];
+        float vY = velocitiesY[i];
+        float vZ = velocitiesZ[i];
+        float x = positionsX[i] + vX * deltaT;
+        float y = positionsY[i] + vY * deltaT;
+        float z = positionsZ[i] + vZ * deltaT;
+        positionsX[i] = x;
+        positionsY[i] = y;
+        positionsZ[i] = z;
+
+        //bounce at the boundaries.
+        if (x - radius <= boundaries[0] && vX < 0) {
+            vX = -vX;
+        }
+        if (x + radius >= boundaries[1] && vX > 0) {
+            vX = -vX;
+        }
+        if (y - radius <= boundaries[2] && vY < 0) {
+            vY = -vY;
+        }
+        if (y + radius >= boundaries[3] && vY > 0) {
+            vY = -vY;
+        }
+        bool zBounce = false;
+        if (z - radius <= boundaries[4] && vZ < 0) {
+            vZ = -vZ;
+            zBounce = true;
+        }
+        if (z + radius >= boundaries[5] && vZ > 0) {
+            vZ = -vZ;
+            zBounce = true;
+        }
+
+        //gravity.
+        if (!zBounce) {
+            vZ -= gravityVelocityChange;
+        }
+        velocitiesX[i] = vX;
+        velocitiesY[i] = vY;
+        velocitiesZ[i] = vZ;
+    }
+}
+
+void advanceBodiesSse(float* positionsX, float* positionsY, float* positionsZ, float* velocitiesX, float* velocitiesY, float* velocitiesZ,
+        const float* radii, int count, const float* boundaries, float deltaT, float gravityVelocityChange) {
+    const __m128 deltaTVector = _mm_set1_ps(deltaT);
+    const __m128 gravityVector = _mm_set1_ps(gravityVelocityChange);
+    const __m128 signBit = _mm_set1_ps(-0.0f);
+    const __m128 zero = _mm_setzero_ps();
+
+    //4 bodies at a time. A velocity component is negated by flipping its sign bit where the bounce condition holds.
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 radius = _mm_loadu_ps(radii + i);
+        __m128 vX = _mm_loadu_ps(velocitiesX + i);
+        __m128 vY = _mm_loadu_ps(velocitiesY + i);
+        __m128 vZ = _mm_loadu_ps(velocitiesZ + i);
+        __m128 x = _mm_add_ps(_mm_loadu_ps(positionsX + i), _mm_mul_ps(vX, deltaTVector));
+        __m128 y = _mm_add_ps(_mm_loadu_ps(positionsY + i), _mm_mul_ps(vY, deltaTVector));
+        __m128 z = _mm_add_ps(_mm_loadu_ps(positionsZ + i), _mm_mul_ps(vZ, deltaTVector));
+        _mm_storeu_ps(positionsX + i, x);
+        _mm_storeu_ps(positionsY + i, y);
+        _mm_storeu_ps(positionsZ + i, z);
+
+        //bounce at the boundaries.
+        __m128 bounce = _mm_and_ps(_mm_cmple_ps(_mm_sub_ps(x, radius), _mm_set1_ps(boundaries[0])), _mm_cmplt_ps(vX, zero));
+        vX = _mm_xor_ps(vX, _mm_and_ps(bounce, signBit));
+        bounce = _mm_and_ps(_mm_cmpge_ps(_mm_add_ps(x, radius), _mm_set1_ps(boundaries[1])), _mm_cmpgt_ps(vX, zero));
+        vX = _mm_xor_ps(vX, _mm_and_ps(bounce, signBit));
+        bounce = _mm_and_ps(_mm_cmple_ps(_mm_sub_ps(y, radius), _mm_set1_ps(boundaries[2])), _mm_cmplt_ps(vY, zero));
+        vY = _mm_xor_ps(vY, _mm_and_ps(bounce, signBit));
+        bounce = _mm_and_ps(_mm_cmpge_ps(_mm_add_ps(y, radius), _mm_set1_ps(boundaries[3])), _mm_cmpgt_ps(vY, zero));
+        vY = _mm_xor_ps(vY, _mm_and_ps(bounce, signBit));
+        __m128 zBounce = _mm_and_ps(_mm_cmple_ps(_mm_sub_ps(z, radius), _mm_set1_ps(boundaries[4])), _mm_cmplt_ps(vZ, zero));
+        vZ = _mm_xor_ps(vZ, _mm_and_ps(zBounce, signBit));
+        bounce = _mm_and_ps(_mm_cmpge_ps(_mm_add_ps(z, radius), _mm_set1_ps(boundaries[5])), _mm_cmpgt_ps(vZ, zero));
+        vZ = _mm_xor_ps(vZ, _mm_and_ps(bounce, signBit));
+        zBounce = _mm_or_ps(zBounce, bounce);
+
+        //gravity, bouncing bodies subtract zero instead, which does not change their velocity.
+        vZ = _mm_sub_ps(vZ, _mm_andnot_ps(zBounce, gravityVector));
+        _mm_storeu_ps(velocitiesX + i, vX);
+        _mm_storeu_ps(velocitiesY + i, vY);
+        _mm_storeu_ps(velocitiesZ + i, vZ);
+    }
+
+    //remaining bodies.
+    advanceBodiesScalar(positionsX + i, positionsY + i, positionsZ + i, velocitiesX + i, velocitiesY + i, velocitiesZ + i,
+            radii + i, count - i, boundaries, deltaT, gravityVelocityChange);
+}
+
+void applySphereWaterForcesScalar(const float* positionsZ, float* velocitiesX, float* velocitiesY, float* velocitiesZ, const float* radii, const float* masses,
+        const float* waterHeights, const float* waterGradientsX, const float* waterGradientsY, int count, float deltaT, float buoyancyFactor) {
+    for (int i = 0; i < count; i++) {
+        float radius = radii[i];
+        float zMin = positionsZ[i] - radius;
+        if (zMin > waterHeights[i]) {//if body is above the water surface.
+            continue;
+        }
+
+        //horizontal force proportional and opposite to gradient of water surface, and buoyancy.
+        float forceX = -WATER_GRADIENT_COUPLING_CONSTANT * waterGradientsX[i];
+        float forceY = -WATER_GRADIENT_COUPLING_CONSTANT * waterGradientsY[i];
+        float forceZ = calculateSphereVolumeBelowZ(waterHeights[i] - zMin, radius) * buoyancyFactor;
+
+        //apply force and friction due to moving through water.
+        float mass = masses[i];
+        velocitiesX[i] = (velocitiesX[i] + (forceX / mass) * deltaT) * WATER_HORIZONTAL_DRAG_FACTOR;
+        velocitiesY[i] = (velocitiesY[i] + (forceY / mass) * deltaT) * WATER_HORIZONTAL_DRAG_FACTOR;
+        velocitiesZ[i] = (velocitiesZ[i] + (forceZ / mass) * deltaT) * WATER_VERTICAL_DRAG_FACTOR;
+    }
+}
+
+void applySphereWaterForcesSse(const float* positionsZ, float* velocitiesX, float* velocitiesY, float* velocitiesZ, const float* radii, const float* masses,
+        const float* waterHeights, const float* waterGradientsX, const float* waterGradientsY, int count, float deltaT, float buoyancyFactor) {
+    const __m128 deltaTVector = _mm_set1_ps(deltaT);
+    const __m128 buoyancyVector = _mm_set1_ps(buoyancyFactor);
+    const __m128 couplingVector = _mm_set1_ps(-WATER_GRADIENT_COUPLING_CONSTANT);
+    const __m128 horizontalDragVector = _mm_set1_ps(WATER_HORIZONTAL_DRAG_FACTOR);
+    const __m128 verticalDragVector = _mm_set1_ps(WATER_VERTICAL_DRAG_FACTOR);
+
+    //4 bodies at a time. The new velocities are calculated for all bodies and only stored where the body is in the water.
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 radius = _mm_loadu_ps(radii + i);
+        __m128 zMin = _mm_sub_ps(_mm_loadu_ps(positionsZ + i), radius);
+        __m128 waterHeight = _mm_loadu_ps(waterHeights + i);
+        __m128 inWater = _mm_cmple_ps(zMin, waterHeight);
+        if (_mm_movemask_ps(inWater) == 0) {
+            continue;
+        }
+
+        //volume of the spherical cap below the water surface, see calculateSphereVolumeBelowZ.
+        __m128 h = _mm_min_ps(_mm_sub_ps(waterHeight, zMin), _mm_add_ps(radius, radius));
+        __m128 volume = _mm_mul_ps(_mm_mul_ps(_mm_set1_ps((float) M_PI), h), h);
+        volume = _mm_div_ps(_mm_mul_ps(volume, _mm_sub_ps(_mm_mul_ps(_mm_set1_ps(3), radius), h)), _mm_set1_ps(3));
+
+        __m128 forceX = _mm_mul_ps(couplingVector, _mm_loadu_ps(waterGradientsX + i));
+        __m128 forceY = _mm_mul_ps(couplingVector, _mm_loadu_ps(waterGradientsY + i));
+        __m128 forceZ = _mm_mul_ps(volume, buoyancyVector);
+        __m128 mass = _mm_loadu_ps(masses + i);
+        __m128 vX = _mm_loadu_ps(velocitiesX + i);
+        __m128 vY = _mm_loadu_ps(velocitiesY + i);
+        __m128 vZ = _mm_loadu_ps(velocitiesZ + i);
+        __m128 newVX = _mm_mul_ps(_mm_add_ps(vX, _mm_mul_ps(_mm_div_ps(forceX, mass), deltaTVector)), horizontalDragVector);
+        __m128 newVY = _mm_mul_ps(_mm_add_ps(vY, _mm_mul_ps(_mm_div_ps(forceY, mass), deltaTVector)), horizontalDragVector);
+        __m128 newVZ = _mm_mul_ps(_mm_add_ps(vZ, _mm_mul_ps(_mm_div_ps(forceZ, mass), deltaTVector)), verticalDragVector);
+        _mm_storeu_ps(velocitiesX + i, _mm_or_ps(_mm_and_ps(inWater, newVX), _mm_andnot_ps(inWater, vX)));
+        _mm_storeu_ps(velocitiesY + i, _mm_or_ps(_mm_and_ps(inWater, newVY), _mm_andnot_ps(inWater, vY)));
+        _mm_storeu_ps(velocitiesZ + i, _mm_or_ps(_mm_and_ps(inWater, newVZ), _mm_andnot_ps(inWater, vZ)));
+    }
+
+    //remaining bodies.
+    applySphereWaterForcesScalar(positionsZ + i, velocitiesX + i, velocitiesY + i, velocitiesZ + i, radii + i, masses + i,
+            waterHeights + i, waterGradientsX + i, waterGradientsY + i, count - i, deltaT, buoyancyFactor);
+}
+
+BodyMotionKernel getBodyMotionKernel(int instructionSet) {
+    switch (instructionSet) {
+        case AVX512_INSTRUCTION_SET:
+            return advanceBodiesAvx512;
+        case AVX2_INSTRUCTION_SET:
+            return advanceBodiesAvx2;
+        case SSE_INSTRUCTION_SET:
+            return advanceBodiesSse;
+        default:
+            return advanceBodiesScalar;
+    }
+}
+
+SphereWaterForceKernel getSphereWaterForceKernel(int instructionSet) {
+    switch (instructionSet) {
+        case AVX512_INSTRUCTION_SET:
+            return applySphereWaterForcesAvx512;
+        case AVX2_INSTRUCTION_SET:
+            return applySphereWaterForcesAvx2;
+        case SSE_INSTRUCTION_SET:
+            return applySphereWaterForcesSse;
+        default:
+            return applySphereWaterForcesScalar;
+    }
+}
@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2018 A.C. Kockx, All Rights Reserved.
+ */
+
+#ifndef INCLUDED_BODYKERNELS_H
+#define INCLUDED_BODYKERNELS_H
+
+//constants of the forces of the water surface on floating bodies. They are shared by all implementations, so that these produce identical results.
+static const float WATER_GRADIENT_COUPLING_CONSTANT = 0.1f;//arbitrary coupling constant in kg*m/s2.
+static const float WATER_HORIZONTAL_DRAG_FACTOR = 0.99f;//arbitrary factor of the horizontal velocity per time step, friction due to moving through water.
+static const float WATER_VERTICAL_DRAG_FACTOR = 0.5f;//arbitrary factor of the vertical velocity per time step.
+
+/**
+ * Kernel that advances count bodies (stored as a structure of arrays, see BodyStore) by one time step:
+ *
+ * position += velocity * deltaT
+ *
+ * Then each velocity component is negated if the body touches the corresponding boundary and moves towards it (elastic bounce),
+ * with the bounding box of a body extending radius from its position in every direction. boundaries contains xMin, xMax, yMin, yMax, zMin and zMax.
+ * Finally gravityVelocityChange (G * deltaT) is subtracted from the z velocity, except during a bounce against the ground or ceiling,
+ * so that energy is conserved.
+ *
+ * All implementations perform exactly the same floating point operations in the same order without fused multiply-add,
+ * so all implementations produce bitwise identical results.
+ */
+typedef void (*BodyMotionKernel)(float* positionsX, float* positionsY, float* positionsZ, float* velocitiesX, float* velocitiesY, float* velocitiesZ,
+        const float* radii, int count, const float* boundaries, float deltaT, float gravityVelocityChange);
+
+/**
+ * Kernel that applies the forces of the water surface to count spherical bodies (stored as a structure of arrays, see BodyStore).
+ * waterHeights, waterGradientsX and waterGradientsY contain the surface height (in world space) and gradient of the water surface below each body,
+ * with a height of -infinity for bodies that are not above or below the water surface. Bodies whose lowest point is at or below the water surface get
+ *
+ * force = (-WATER_GRADIENT_COUPLING_CONSTANT * gradientX, -WATER_GRADIENT_COUPLING_CONSTANT * gradientY, volume below the water surface * buoyancyFactor)
+ * velocity += (force / mass) * deltaT
+ *
+ * after which the velocity is multiplied by the drag factors. buoyancyFactor is the density of water times G.
+ *
+ * All implementations perform exactly the same floating point operations in the same order without fused multiply-add,
+ * so all implementations produce bitwise identical results.
+ */
+typedef void (*SphereWaterForceKernel)(const float* positionsZ, float* velocitiesX, float* velocitiesY, float* velocitiesZ, const float* radii, const float* masses,
+        const float* waterHeights, const float* waterGradientsX, const float* waterGradientsY, int count, float deltaT, float buoyancyFactor);
+
+/**
+ * Implementations for the different instruction sets.
+ * The scalar implementations are the reference that the vectorized implementations can be compared to.
+ */
+void advanceBodiesScalar(float* positionsX, float* positionsY, float* positionsZ, float* velocitiesX, float* velocitiesY, float* velocitiesZ,
+        const float* radii, int count, const float* boundaries, float deltaT, float gravityVelocityChange);
+void advanceBodiesSse(float* positionsX, float* positionsY, float* positionsZ, float* velocitiesX, float* velocitiesY, float* velocitiesZ,
+        const float* radii, int count, const float* boundaries, float deltaT, float gravityVelocityChange);
+void advanceBodiesAvx2(float* positionsX, float* positionsY, float* positionsZ, float* velocitiesX, float* velocitiesY, float* velocitiesZ,
+        const float* radii, int count, const float* boundaries, float deltaT, float gravityVelocityChange);
+void advanceBodiesAvx512(float* positionsX, float* positionsY, float* positionsZ, float* velocitiesX, float* velocitiesY, float* velocitiesZ,
+        const float* radii, int count, const float* boundaries, float deltaT, float gravityVelocityChange);
+void applySphereWaterForcesScalar(const float* positionsZ, float* velocitiesX, float* velocitiesY, float* velocitiesZ, const float* radii, const float* masses,
+        const float* waterHeights, const float* waterGradientsX, const float* waterGradientsY, int count, float deltaT, float buoyancyFactor);
+void applySphereWaterForcesSse(const float* positionsZ, float* velocitiesX, float* velocitiesY, float* velocitiesZ, const float* radii, const float* masses,
+        const float* waterHeights, const float* waterGradientsX, const float* waterGradientsY, int count, float deltaT, float buoyancyFactor);
+void applySphereWaterForcesAvx2(const float* positionsZ, float* velocitiesX, float* velocitiesY, float* velocitiesZ, const float* radii, const float* masses,
+        const float* waterHeights, const float* waterGradientsX, const float* waterGradientsY, int count, float deltaT, float buoyancyFactor);
+void applySphereWaterForcesAvx512(const float* positionsZ, float* velocitiesX, float* velocitiesY, float* velocitiesZ, const float* radii, const float* masses,
+        const float* waterHeights, const float* waterGradientsX, const float* waterGradientsY, int count, float deltaT, float buoyancyFactor);
+
+/**
+ * Returns the implementations for the given instruction set (see CpuFeatures.h).
+ * The caller is responsible for checking that the instruction set is supported.
+ */
+BodyMotionKernel getBodyMotionKernel(int instructionSet);
+SphereWaterForceKernel getSphereWaterForceKernel(int instructionSet);
+
+/**
+ * Returns the volume (in m3) of the part of a sphere with the given radius that is below a horizontal plane,
+ * where depth (positive) is the distance of the lowest point of the sphere below the plane.
+ * This is the same calculation as in the kernels that apply the forces of the water surface.
+ */
+float calculateSphereVolumeBelowZ(float depth, float radius);
+
+#endif
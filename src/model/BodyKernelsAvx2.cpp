@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2018 A.C. Kockx, All Rights Reserved.
+ *
+ * AVX2 implementations of the kernels in BodyKernels.h.
+ * The functions in this file must only be called if the processor supports AVX2 (see CpuFeatures.h).
+ */
+
+//GCC and Clang only allow AVX2 intrinsics in code that is compiled for AVX2. Do not enable FMA,
+//since fused multiply-add would change the rounding compared to the scalar reference implementation.
+#if defined(__GNUC__) && !defined(__AVX2__)
+#pragma GCC target("avx2")
+#endif
+
+#include "model/BodyKernels.h"
+
+#define _USE_MATH_DEFINES
+#include <math.h>
+#include <immintrin.h>
+
+void advanceBodiesAvx2(float* positionsX, float* positionsY, float* positionsZ, float* velocitiesX, float* velocitiesY, float* velocitiesZ,
+        const float* radii, int count, const float* boundaries, float deltaT, float gravityVelocityChange) {
+    const __m256 deltaTVector = _mm256_set1_ps(deltaT);
+    const __m256 gravityVector = _mm256_set1_ps(gravityVelocityChange);
+    const __m256 signBit = _mm256_set1_ps(-0.0f);
+    const __m256 zero = _mm256_setzero_ps();
+
+    //8 bodies at a time. A velocity component is negated by flipping its sign bit where the bounce condition holds.
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 radius = _mm256_loadu_ps(radii + i);
+        __m256 vX = _mm256_loadu_ps(velocitiesX + i);
+        __m256 vY = _mm256_loadu_ps(velocitiesY + i);
+        __m256 vZ = _mm256_loadu_ps(velocitiesZ + i);
+        __m256 x = _mm256_add_ps(_mm256_loadu_ps(positionsX + i), _mm256_mul_ps(vX, deltaTVector));
+        __m256 y = _mm256_add_ps(_mm256_loadu_ps(positionsY + i), _mm256_mul_ps(vY, deltaTVector));
+        __m256 z = _mm256_add_ps(_mm256_loadu_ps(positionsZ + i), _mm256_mul_ps(vZ, deltaTVector));
+        _mm256_storeu_ps(positionsX + i, x);
+        _mm256_storeu_ps(positionsY + i, y);
+        _mm256_storeu_ps(positionsZ + i, z);
+
+        //bounce at the boundaries.
+        __m256 bounce = _mm256_and_ps(_mm256_cmp_ps(_mm256_sub_ps(x, radius), _mm256_set1_ps(boundaries[0]), _CMP_LE_OQ), _mm256_cmp_ps(vX, zero, _CMP_LT_OQ));
+        vX = _mm256_xor_ps(vX, _mm256_and_ps(bounce, signBit));
+        bounce = _mm256_and_ps(_mm256_cmp_ps(_mm256_add_ps(x, radius), _mm256_set1_ps(boundaries[1]), _CMP_GE_OQ), _mm256_cmp_ps(vX, zero, _CMP_GT_OQ));
+        vX = _mm256_xor_ps(vX, _mm256_and_ps(bounce, signBit));
+        bounce = _mm256_and_ps(_mm256_cmp_ps(_mm256_sub_ps(y, radius), _mm256_set1_ps(boundaries[2]), _CMP_LE_OQ), _mm256_cmp_ps(vY, zero, _CMP_LT_OQ));
+        vY = _mm256_xor_ps(vY, _mm256_and_ps(bounce, signBit));
+        bounce = _mm256_and_ps(_mm256_cmp_ps(_mm256_add_ps(y, radius), _mm256_set1_ps(boundaries[3]), _CMP_GE_OQ), _mm256_cmp_ps(vY, zero, _CMP_GT_OQ));
+        vY = _mm256_xor_ps(vY, _mm256_and_ps(bounce, signBit));
+        __m256 zBounce = _mm256_and_ps(_mm256_cmp_ps(_mm256_sub_ps(z, radius), _mm256_set1_ps(boundaries[4]), _CMP_LE_OQ), _mm256_cmp_ps(vZ, zero, _CMP_LT_OQ));
+        vZ = _mm256_xor_ps(vZ, _mm256_and_ps(zBounce, signBit));
+        bounce = _mm256_and_ps(_mm256_cmp_ps(_mm256_add_ps(z, radius), _mm256_set1_ps(boundaries[5]), _CMP_GE_OQ), _mm256_cmp_ps(vZ, zero, _CMP_GT_OQ));
+        vZ = _mm256_xor_ps(vZ, _mm256_and_ps(bounce, signBit));
+        zBounce = _mm256_or_ps(zBounce, bounce);
+
+        //gravity, bouncing bodies subtract zero instead, which does not change their velocity.
+        vZ = _mm256_sub_ps(vZ, _mm256_andnot_ps(zBounce, gravityVector));
+        _mm256_storeu_ps(velocitiesX + i, vX);
+        _mm256_storeu_ps(velocitiesY + i, vY);
+        _mm256_storeu_ps(velocitiesZ + i, vZ);
+    }
+
+    //remaining bodies.
+    advanceBodiesSse(positionsX + i, positionsY + i, positionsZ + i, velocitiesX + i, velocitiesY + i, velocitiesZ + i,
+            radii + i, count - i, boundaries, deltaT, gravityVelocityChange);
+}
+
+void applySphereWaterForcesAvx2(const float* positionsZ, float* velocitiesX, float* velocitiesY, float* velocitiesZ, const float* radii, const float* masses,
+        const float* waterHeights, const float* waterGradientsX, const float* waterGradientsY, int count, float deltaT, float buoyancyFactor) {
+    const __m256 deltaTVector = _mm256_set1_ps(deltaT);
+    const __m256 buoyancyVector = _mm256_set1_ps(buoyancyFactor);
+    const __m256 couplingVector = _mm256_set1_ps(-WATER_GRADIENT_COUPLING_CONSTANT);
+    const __m256 horizontalDragVector = _mm256_set1_ps(WATER_HORIZONTAL_DRAG_FACTOR);
+    const __m256 verticalDragVector = _mm256_set1_ps(WATER_VERTICAL_DRAG_FACTOR);
+
+    //8 bodies at a time. The new velocities are calculated for all bodies and only stored where the body is in the water.
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 radius = _mm256_loadu_ps(radii + i);
+        __m256 zMin = _mm256_sub_ps(_mm256_loadu_ps(positionsZ + i), radius);
+        __m256 waterHeight = _mm256_loadu_ps(waterHeights + i);
+        __m256 inWater = _mm256_cmp_ps(zMin, waterHeight, _CMP_LE_OQ);
+        if (_mm256_movemask_ps(inWater) == 0) {
+            continue;
+        }
+
+        //volume of the spherical cap below the water surface, see calculateSphereVolumeBelowZ.
+        __m256 h = _mm256_min_ps(_mm256_sub_ps(waterHeight, zMin), _mm256_add_ps(radius, radius));
+        __m256 volume = _mm256_mul_ps(_mm256_mul_ps(_mm256_set1_ps((float) M_PI), h), h);
+        volume = _mm256_div_ps(_mm256_mul_ps(volume, _mm256_sub_ps(_mm256_mul_ps(_mm256_set1_ps(3), radius), h)), _mm256_set1_ps(3));
+
+        __m256 forceX = _mm256_mul_ps(couplingVector, _mm256_loadu_ps(waterGradientsX + i));
+        __m256 forceY = _mm256_mul_ps(couplingVector, _mm256_loadu_ps(waterGradientsY + i));
+        __m256 forceZ = _mm256_mul_ps(volume, buoyancyVector);
+        __m256 mass = _mm256_loadu_ps(masses + i);
+        __m256 vX = _mm256_loadu_ps(velocitiesX + i);
+        __m256 vY = _mm256_loadu_ps(velocitiesY + i);
+        __m256 vZ = _mm256_loadu_ps(velocitiesZ + i);
+        __m256 newVX = _mm256_mul_ps(_mm256_add_ps(vX, _mm256_mul_ps(_mm256_div_ps(forceX, mass), deltaTVector)), horizontalDragVector);
+        __m256 newVY = _mm256_mul_ps(_mm256_add_ps(vY, _mm256_mul_ps(_mm256_div_ps(forceY, mass), deltaTVector)), horizontalDragVector);
+        __m256 newVZ = _mm256_mul_ps(_mm256_add_ps(vZ, _mm256_mul_ps(_mm256_div_ps(forceZ, mass), deltaTVector)), verticalDragVector);
+        _mm256_storeu_ps(velocitiesX + i, _mm256_or_ps(_mm256_and_ps(inWater, newVX), _mm256_andnot_ps(inWater, vX)));
+        _mm256_storeu_ps(velocitiesY + i, _mm256_or_ps(_mm256_and_ps(inWater, newVY), _mm256_andnot_ps(inWater, vY)));
+        _mm256_storeu_ps(velocitiesZ + i, _mm256_or_ps(_mm256_and_ps(inWater, newVZ), _mm256_andnot_ps(inWater, vZ)));
+    }
+
+    //remaining bodies.
+    applySphereWaterForcesSse(positionsZ + i, velocitiesX + i, velocitiesY + i, velocitiesZ + i, radii + i, masses + i,
+            waterHeights + i, waterGradientsX + i, waterGradientsY + i, count - i, deltaT, buoyancyFactor);
+}
@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2018 A.C. Kockx, All Rights Reserved.
+ *
+ * AVX-512 implementations of the kernels in BodyKernels.h.
+ * The functions in this file must only be called if the processor supports AVX-512F (see CpuFeatures.h).
+ */
+
+//GCC and Clang only allow AVX-512 intrinsics in code that is compiled for AVX-512. AVX-512F implies FMA,
+//so also disable floating point contraction, since fused multiply-add would change the rounding compared to the scalar reference implementation.
+#if defined(__GNUC__)
+#if !defined(__AVX512F__)
+#pragma GCC target("avx512f")
+#endif
+#if !defined(__clang__)
+#pragma GCC optimize("fp-contract=off")
+#else
+#pragma clang fp contract(off)
+#endif
+#endif
+
+#include "model/BodyKernels.h"
+
+#define _USE_MATH_DEFINES
+#include <math.h>
+#include <immintrin.h>
+
+void advanceBodiesAvx512(float* positionsX, float* positionsY, float* positionsZ, float* velocitiesX, float* velocitiesY, float* velocitiesZ,
+        const float* radii, int count, const float* boundaries, float deltaT, float gravityVelocityChange) {
+    const __m512 deltaTVector = _mm512_set1_ps(deltaT);
+    const __m512 gravityVector = _mm512_set1_ps(gravityVelocityChange);
+    const __m512 zero = _mm512_setzero_ps();
+
+    //16 bodies at a time, the remaining bodies are handled with a masked iteration.
+    //A velocity component is negated with a masked subtraction from zero where the bounce condition holds.
+    for (int i = 0; i < count; i += 16) {
+        int remainingCount = count - i;
+        __mmask16 mask = remainingCount >= 16 ? (__mmask16) 0xFFFF : (__mmask16) ((1u << remainingCount) - 1);
+
+        __m512 radius = _mm512_maskz_loadu_ps(mask, radii + i);
+        __m512 vX = _mm512_maskz_loadu_ps(mask, velocitiesX + i);
+        __m512 vY = _mm512_maskz_loadu_ps(mask, velocitiesY + i);
+        __m512 vZ = _mm512_maskz_loadu_ps(mask, velocitiesZ + i);
+        __m512 x = _mm512_add_ps(_mm512_maskz_loadu_ps(mask, positionsX + i), _mm512_mul_ps(vX, deltaTVector));
+        __m512 y = _mm512_add_ps(_mm512_maskz_loadu_ps(mask, positionsY + i), _mm512_mul_ps(vY, deltaTVector));
+        __m512 z = _mm512_add_ps(_mm512_maskz_loadu_ps(mask, positionsZ + i), _mm512_mul_ps(vZ, deltaTVector));
+        _mm512_mask_storeu_ps(positionsX + i, mask, x);
+        _mm512_mask_storeu_ps(positionsY + i, mask, y);
+        _mm512_mask_storeu_ps(positionsZ + i, mask, z);
+
+        //bounce at the boundaries.
+        __mmask16 bounce = _mm512_cmp_ps_mask(_mm512_sub_ps(x, radius), _mm512_set1_ps(boundaries[0]), _CMP_LE_OQ) & _mm512_cmp_ps_mask(vX, zero, _CMP_LT_OQ);
+        vX = _mm512_mask_sub_ps(vX, bounce, zero, vX);
+        bounce = _mm512_cmp_ps_mask(_mm512_add_ps(x, radius), _mm512_set1_ps(boundaries[1]), _CMP_GE_OQ) & _mm512_cmp_ps_mask(vX, zero, _CMP_GT_OQ);
+        vX = _mm512_mask_sub_ps(vX, bounce, zero, vX);
+        bounce = _mm512_cmp_ps_mask(_mm512_sub_ps(y, radius), _mm512_set1_ps(boundaries[2]), _CMP_LE_OQ) & _mm512_cmp_ps_mask(vY, zero, _CMP_LT_OQ);
+        vY = _mm512_mask_sub_ps(vY, bounce, zero, vY);
+        bounce = _mm512_cmp_ps_mask(_mm512_add_ps(y, radius), _mm512_set1_ps(boundaries[3]), _CMP_GE_OQ) & _mm512_cmp_ps_mask(vY, zero, _CMP_GT_OQ);
+        vY = _mm512_mask_sub_ps(vY, bounce, zero, vY);
+        __mmask16 zBounce = _mm512_cmp_ps_mask(_mm512_sub_ps(z, radius), _mm512_set1_ps(boundaries[4]), _CMP_LE_OQ) & _mm512_cmp_ps_mask(vZ, zero, _CMP_LT_OQ);
+        vZ = _mm512_mask_sub_ps(vZ, zBounce, zero, vZ);
+        bounce = _mm512_cmp_ps_mask(_mm512_add_ps(z, radius), _mm512_set1_ps(boundaries[5]), _CMP_GE_OQ) & _mm512_cmp_ps_mask(vZ, zero, _CMP_GT_OQ);
+        vZ = _mm512_mask_sub_ps(vZ, bounce, zero, vZ);
+        zBounce |= bounce;
+
+        //gravity.
+        vZ = _mm512_mask_sub_ps(vZ, (__mmask16) ~zBounce, vZ, gravityVector);
+        _mm512_mask_storeu_ps(velocitiesX + i, mask, vX);
+        _mm512_mask_storeu_ps(velocitiesY + i, mask, vY);
+        _mm512_mask_storeu_ps(velocitiesZ + i, mask, vZ);
+    }
+}
+
+void applySphereWaterForcesAvx512(const float* positionsZ, float* velocitiesX, float* velocitiesY, float* velocitiesZ, const float* radii, const float* masses,
+        const float* waterHeights, const float* waterGradientsX, const float* waterGradientsY, int count, float deltaT, float buoyancyFactor) {
+    const __m512 deltaTVector = _mm512_set1_ps(deltaT);
+    const __m512 buoyancyVector = _mm512_set1_ps(buoyancyFactor);
+    const __m512 couplingVector = _mm512_set1_ps(-WATER_GRADIENT_COUPLING_CONSTANT);
+    const __m512 horizontalDragVector = _mm512_set1_ps(WATER_HORIZONTAL_DRAG_FACTOR);
+    const __m512 verticalDragVector = _mm512_set1_ps(WATER_VERTICAL_DRAG_FACTOR);
+
+    //16 bodies at a time, the remaining bodies are handled with a masked iteration.
+    //The new velocities are only stored where the body is in the water.
+    for (int i = 0; i < count; i += 16) {
+        int remainingCount = count - i;
+        __mmask16 mask = remainingCount >= 16 ? (__mmask16) 0xFFFF : (__mmask16) ((1u << remainingCount) - 1);
+
+        __m512 radius = _mm512_maskz_loadu_ps(mask, radii + i);
+        __m512 zMin = _mm512_sub_ps(_mm512_maskz_loadu_ps(mask, positionsZ + i), radius);
+        __m512 waterHeight = _mm512_maskz_loadu_ps(mask, waterHeights + i);
+        __mmask16 inWater = mask & _mm512_cmp_ps_mask(zMin, waterHeight, _CMP_LE_OQ);
+        if (inWater == 0) {
+            continue;
+        }
+
+        //volume of the spherical cap below the water surface, see calculateSphereVolumeBelowZ.
+        __m512 h = _mm512_min_ps(_mm512_sub_ps(waterHeight, zMin), _mm512_add_ps(radius, radius));
+        __m512 volume = _mm512_mul_ps(_mm512_mul_ps(_mm512_set1_ps((float) M_PI), h), h);
+        volume = _mm512_div_ps(_mm512_mul_ps(volume, _mm512_sub_ps(_mm512_mul_ps(_mm512_set1_ps(3), radius), h)), _mm512_set1_ps(3));
+
+        __m512 forceX = _mm512_mul_ps(couplingVector, _mm512_maskz_loadu_ps(inWater, waterGradientsX + i));
+        __m512 forceY = _mm512_mul_ps(couplingVector, _mm512_maskz_loadu_ps(inWater, waterGradientsY + i));
+        __m512 forceZ = _mm512_mul_ps(volume, buoyancyVector);
+        //masses of the other bodies are set to one to avoid divisions by zero.
+        __m512 mass = _mm512_mask_loadu_ps(_mm512_set1_ps(1), inWater, masses + i);
+        __m512 vX = _mm512_maskz_loadu_ps(inWater, velocitiesX + i);
+        __m512 vY = _mm512_maskz_loadu_ps(inWater, velocitiesY + i);
+        __m512 vZ = _mm512_maskz_loadu_ps(inWater, velocitiesZ + i);
+        vX = _mm512_mul_ps(_mm512_add_ps(vX, _mm512_mul_ps(_mm512_div_ps(forceX, mass), deltaTVector)), horizontalDragVector);
+        vY = _mm512_mul_ps(_mm512_add_ps(vY, _mm512_mul_ps(_mm512_div_ps(forceY, mass), deltaTVector)), horizontalDragVector);
+        vZ = _mm512_mul_ps(_mm512_add_ps(vZ, _mm512_mul_ps(_mm512_div_ps(forceZ, mass), deltaTVector)), verticalDragVector);
+        _mm512_mask_storeu_ps(velocitiesX + i, inWater, vX);
+        _mm512_mask_storeu_ps(velocitiesY + i, inWater, vY);
+        _mm512_mask_storeu_ps(velocitiesZ + i, inWater, vZ);
+    }
+}
@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2018 A.C. Kockx, All Rights Reserved.
+ */
+
+#include "model/BodyStore.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "model/BodyKernels.h"
+
+BodyStore::BodyStore(int shapeType) {
+    if (shapeType != SPHERE_SHAPE_TYPE) {
+        fprintf(stderr, "Unknown shape type: %i\n", shapeType);
+        exit(-1);
+    }
+    this->shapeType = shapeType;
+}
+
+int BodyStore::addBody(float mass, float radius, vec3 position) {
+    positionsX.push_back(position[0]);
+    positionsY.push_back(position[1]);
+    positionsZ.push_back(position[2]);
+    velocitiesX.push_back(0);
+    velocitiesY.push_back(0);
+    velocitiesZ.push_back(0);
+    masses.push_back(mass);
+    radii.push_back(radius);
+    return (int) masses.size() - 1;
+}
+
+int BodyStore::getShapeType() {
+    return shapeType;
+}
+
+int BodyStore::getBodyCount() {
+    return (int) masses.size();
+}
+
+float BodyStore::getMass(int body) {
+    return masses[body];
+}
+
+float BodyStore::getRadius(int body) {
+    return radii[body];
+}
+
+vec3 BodyStore::getPosition(int body) {
+    return vec3(positionsX[body], positionsY[body], positionsZ[body]);
+}
+
+void BodyStore::setPosition(int body, vec3 position) {
+    positionsX[body] = position[0];
+    positionsY[body] = position[1];
+    positionsZ[body] = position[2];
+}
+
+vec3 BodyStore::getVelocity(int body) {
+    return vec3(velocitiesX[body], velocitiesY[body], velocitiesZ[body]);
+}
+
+void BodyStore::setVelocity(int body, vec3 velocity) {
+    velocitiesX[body] = velocity[0];
+    velocitiesY[body] = velocity[1];
+    velocitiesZ[body] = velocity[2];
+}
+
+BoundingBox BodyStore::getBoundingBox(int body) {
+    float radius = radii[body];
+    return BoundingBox(positionsX[body] - radius, positionsX[body] + radius, positionsY[body] - radius, positionsY[body] + radius,
+            positionsZ[body] - radius, positionsZ[body] + radius);
+}
+
+float BodyStore::getVolumeBelowZ(int body, float z) {
+    //the same calculation as in the kernels that apply the forces of the water surface.
+    float radius = radii[body];
+    float zMin = positionsZ[body] - radius;
+    if (z <= zMin) {//if body is entirely above z.
+        return 0;
+    }
+    return calculateSphereVolumeBelowZ(z - zMin, radius);
+}
+
+float* BodyStore::getPositionsX() {
+    return &positionsX[0];
+}
+
+float* BodyStore::getPositionsY() {
+    return &positionsY[0];
+}
+
+float* BodyStore::getPositionsZ() {
+    return &positionsZ[0];
+}
+
+float* BodyStore::getVelocitiesX() {
+    return &velocitiesX[0];
+}
+
+float* BodyStore::getVelocitiesY() {
+    return &velocitiesY[0];
+}
+
+float* BodyStore::getVelocitiesZ() {
+    return &velocitiesZ[0];
+}
+
+const float* BodyStore::getMasses() {
+    return &masses[0];
+}
+
+const float* BodyStore::getRadii() {
+    return &radii[0];
+}
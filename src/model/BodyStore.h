@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2018 A.C. Kockx, All Rights Reserved.
+ */
+
+#include "util/ModelUtils.h"
+#include "util/AlignedAllocator.h"
+#include "util/BoundingBox.h"
+
+#ifndef INCLUDED_BODYSTORE_H
+#define INCLUDED_BODYSTORE_H
+
+enum {
+    SPHERE_SHAPE_TYPE
+};
+
+/**
+ * Physical state of a collection of rigid bodies that all have the same shape.
+ * The state is stored as a structure of arrays, i.e. one contiguous array per property with one element per body,
+ * so that all bodies can be advanced together with vectorized kernels, see BodyKernels.h.
+ * Single bodies can be accessed through views that implement ObjectInterface on top of this store, e.g. BeachBall.
+ */
+class BodyStore {
+    private:
+        int shapeType;
+
+        //per body, in the order in which the bodies were added.
+        vector<float, AlignedAllocator<float, CACHE_LINE_SIZE>> positionsX;//in m, in world space.
+        vector<float, AlignedAllocator<float, CACHE_LINE_SIZE>> positionsY;
+        vector<float, AlignedAllocator<float, CACHE_LINE_SIZE>> positionsZ;
+        vector<float, AlignedAllocator<float, CACHE_LINE_SIZE>> velocitiesX;//in m/s, in world space.
+        vector<float, AlignedAllocator<float, CACHE_LINE_SIZE>> velocitiesY;
+        vector<float, AlignedAllocator<float, CACHE_LINE_SIZE>> velocitiesZ;
+        vector<float, AlignedAllocator<float, CACHE_LINE_SIZE>> masses;//in kg.
+        vector<float, AlignedAllocator<float, CACHE_LINE_SIZE>> radii;//in m, half the size of the bounding box in every direction.
+
+    public:
+        /**
+         * Creates an empty store for bodies with the given shape type.
+         */
+        BodyStore(int shapeType);
+
+        /**
+         * Adds a body with the given mass and radius centered on the given position (in world space), initially at rest.
+         * Returns the index of the new body, which does not change when more bodies are added.
+         */
+        int addBody(float mass, float radius, vec3 position);
+
+        /**
+         * Getters.
+         */
+        int getShapeType();
+        int getBodyCount();
+
+        /**
+         * Getters and setters for single bodies, see ObjectInterface.
+         */
+        float getMass(int body);
+        float getRadius(int body);
+        vec3 getPosition(int body);
+        void setPosition(int body, vec3 position);
+        vec3 getVelocity(int body);
+        void setVelocity(int body, vec3 velocity);
+        BoundingBox getBoundingBox(int body);
+
+        /**
+         * Returns the volume (in m3) of the space occupied by the given body below the plane with the given z coordinate (in world space).
+         */
+        float getVolumeBelowZ(int body, float z);
+
+        /**
+         * Returns the arrays with one element per body, in the order in which the bodies were added.
+         * The arrays are moved when bodies are added and must not be accessed while the store is empty.
+         */
+        float* getPositionsX();
+        float* getPositionsY();
+        float* getPositionsZ();
+        float* getVelocitiesX();
+        float* getVelocitiesY();
+        float* getVelocitiesZ();
+        const float* getMasses();
+        const float* getRadii();
+};
+
+#endif
@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2018 A.C. Kockx, All Rights Reserved.
+ */
+
+#include "model/GaussianKernels.h"
+
+#include <emmintrin.h>
+
+#include "util/CpuFeatures.h"
+
+void addGaussianRowScalar(const float* columnWeights, float rowWeight, float* values, float* previousValues, int count) {
+    for (int i = 0; i < count; i++) {
+        float value = rowWeight * columnWeights[i];
+        values[i] += value;
+        previousValues[i] += value;
+    }
+}
+
+void addGaussianRowSse(const float* columnWeights, float rowWeight, float* values, float* previousValues, int count) {
+    const __m128 rowWeightVector = _mm_set1_ps(rowWeight);
+
+    //4 vertices at a time.
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 value = _mm_mul_ps(rowWeightVector, _mm_loadu_ps(columnWeights + i));
+        _mm_storeu_ps(values + i, _mm_add_ps(_mm_loadu_ps(values + i), value));
+        _mm_storeu_ps(previousValues + i, _mm_add_ps(_mm_loadu_ps(previousValues + i), value));
+    }
+
+    //remaining vertices.
+    addGaussianRowScalar(columnWeights + i, rowWeight, values + i, previousValues + i, count - i);
+}
+
+GaussianRowKernel getGaussianRowKernel(int instructionSet) {
+    switch (instructionSet) {
+        case AVX512_INSTRUCTION_SET:
+            return addGaussianRowAvx512;
+        case AVX2_INSTRUCTION_SET:
+            return addGaussianRowAvx2;
+        case SSE_INSTRUCTION_SET:
+            return addGaussianRowSse;
+        default:
+            return addGaussianRowScalar;
+    }
+}
@@ -0,0 +1,38 @@
+/*
+ * Copyright (c) 2018 A.C. Kockx, All Rights Reserved.
+ */
+
+#ifndef INCLUDED_GAUSSIANKERNELS_H
+#define INCLUDED_GAUSSIANKERNELS_H
+
+/**
+ * Kernel that adds one row of a separable 2D gaussian function, i.e. the outer product of a row weight and count column weights,
+ * to count consecutive vertices of one grid row in both time steps:
+ *
+ * values[i] += rowWeight * columnWeights[i]
+ * previousValues[i] += rowWeight * columnWeights[i]
+ *
+ * The same values are added to both time steps, so that the temporal terms of the wave equation are not disturbed.
+ * values and previousValues must not overlap with each other or with columnWeights.
+ *
+ * All implementations perform exactly the same floating point operations in the same order without fused multiply-add,
+ * so all implementations produce bitwise identical results.
+ */
+typedef void (*GaussianRowKernel)(const float* columnWeights, float rowWeight, float* values, float* previousValues, int count);
+
+/**
+ * Implementations for the different instruction sets.
+ * The scalar implementation is the reference that the vectorized implementations can be compared to.
+ */
+void addGaussianRowScalar(const float* columnWeights, float rowWeight, float* values, float* previousValues, int count);
+void addGaussianRowSse(const float* columnWeights, float rowWeight, float* values, float* previousValues, int count);
+void addGaussianRowAvx2(const float* columnWeights, float rowWeight, float* values, float* previousValues, int count);
+void addGaussianRowAvx512(const float* columnWeights, float rowWeight, float* values, float* previousValues, int count);
+
+/**
+ * Returns the implementation for the given instruction set (see CpuFeatures.h).
+ * The caller is responsible for checking that the instruction set is supported.
+ */
+GaussianRowKernel getGaussianRowKernel(int instructionSet);
+
+#endif
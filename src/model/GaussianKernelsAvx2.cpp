@@ -0,0 +1,31 @@
+/*
+ * Copyright (c) 2018 A.C. Kockx, All Rights Reserved.
+ *
+ * AVX2 implementations of the kernels in GaussianKernels.h.
+ * The functions in this file must only be called if the processor supports AVX2 (see CpuFeatures.h).
+ */
+
+//GCC and Clang only allow AVX2 intrinsics in code that is compiled for AVX2. Do not enable FMA,
+//since fused multiply-add would change the rounding compared to the scalar reference implementation.
+#if defined(__GNUC__) && !defined(__AVX2__)
+#pragma GCC target("avx2")
+#endif
+
+#include "model/GaussianKernels.h"
+
+#include <immintrin.h>
+
+void addGaussianRowAvx2(const float* columnWeights, float rowWeight, float* values, float* previousValues, int count) {
+    const __m256 rowWeightVector = _mm256_set1_ps(rowWeight);
+
+    //8 vertices at a time.
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 value = _mm256_mul_ps(rowWeightVector, _mm256_loadu_ps(columnWeights + i));
+        _mm256_storeu_ps(values + i, _mm256_add_ps(_mm256_loadu_ps(values + i), value));
+        _mm256_storeu_ps(previousValues + i, _mm256_add_ps(_mm256_loadu_ps(previousValues + i), value));
+    }
+
+    //remaining vertices.
+    addGaussianRowSse(columnWeights + i, rowWeight, values + i, previousValues + i, count - i);
+}
@@ -0,0 +1,37 @@
+/*
+ * Copyright (c) 2018 A.C. Kockx, All Rights Reserved.
+ *
+ * AVX-512 implementations of the kernels in GaussianKernels.h.
+ * The functions in this file must only be called if the processor supports AVX-512F (see CpuFeatures.h).
+ */
+
+//GCC and Clang only allow AVX-512 intrinsics in code that is compiled for AVX-512. AVX-512F implies FMA,
+//so also disable floating point contraction, since fused multiply-add would change the rounding compared to the scalar reference implementation.
+#if defined(__GNUC__)
+#if !defined(__AVX512F__)
+#pragma GCC target("avx512f")
+#endif
+#if !defined(__clang__)
+#pragma GCC optimize("fp-contract=off")
+#else
+#pragma clang fp contract(off)
+#endif
+#endif
+
+#include "model/GaussianKernels.h"
+
+#include <immintrin.h>
+
+void addGaussianRowAvx512(const float* columnWeights, float rowWeight, float* values, float* previousValues, int count) {
+    const __m512 rowWeightVector = _mm512_set1_ps(rowWeight);
+
+    //16 vertices at a time, the remaining vertices are handled with a masked iteration.
+    for (int i = 0; i < count; i += 16) {
+        int remainingCount = count - i;
+        __mmask16 mask = remainingCount >= 16 ? (__mmask16) 0xFFFF : (__mmask16) ((1u << remainingCount) - 1);
+
+        __m512 value = _mm512_mul_ps(rowWeightVector, _mm512_maskz_loadu_ps(mask, columnWeights + i));
+        _mm512_mask_storeu_ps(values + i, mask, _mm512_add_ps(_mm512_maskz_loadu_ps(mask, values + i), value));
+        _mm512_mask_storeu_ps(previousValues + i, mask, _mm512_add_ps(_mm512_maskz_loadu_ps(mask, previousValues + i), value));
+    }
+}
@@ -8,15 +8,20 @@
 #ifndef INCLUDED_OBJECTINTERFACE_H
 #define INCLUDED_OBJECTINTERFACE_H
 
+enum {
+    BEACH_BALL_OBJECT_TYPE
+};
+
 /**
- * Interface for classes that contain a 3D model of an object that can be drawn.
+ * Interface for classes that contain a physical model of an object.
+ * Implementations do not depend on OpenGL, see ObjectViewInterface for drawing objects.
  */
 class ObjectInterface {
     public:
         /**
-         * Draws this object to the current OpenGL context.
+         * Returns the type of this object, used to select a matching view for drawing.
          */
-        virtual void draw(mat4 viewMatrix, mat4 projectionMatrix, float lightPositionInWorldSpace[], float lightIntensity[], float ambientLightIntensity[]) = 0;
+        virtual int getObjectType() = 0;
 
         /**
          * Getters and setters.
@@ -32,6 +37,8 @@ class ObjectInterface {
          * Returns the volume (in m3) of the space occupied by this object below the plane with the given z coordinate (in world space).
          */
         virtual float getVolumeBelowZ(float z) = 0;
+
+        virtual ~ObjectInterface() {}
 };
 
 #endif
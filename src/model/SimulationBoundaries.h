@@ -3,7 +3,6 @@
  */
 
 #include "util/BoundingBox.h"
-#include "shader/BasicShader.h"
 
 #ifndef INCLUDED__SIMULATIONBOUNDARIES_H
 #define INCLUDED__SIMULATIONBOUNDARIES_H
@@ -20,15 +19,6 @@ class SimulationBoundaries {
         float yMax;//in m.
         float zMin;//in m.
         float zMax;//in m.
-        mat4 modelMatrix;
-
-        //geometry.
-        GLuint vertexArrayObjectId;
-        GLuint indexBufferObjectId;
-        int indexCount;
-
-        //material.
-        BasicShader shader = BasicShader();
 
     public:
         /**
@@ -40,11 +30,6 @@ class SimulationBoundaries {
         * Returns a bounding box that represents the simulation boundaries.
         */
         BoundingBox getBoundingBox();
-
-        /**
-         * Draws the boundaries to the current OpenGL context.
-         */
-        void draw(mat4 viewMatrix, mat4 projectionMatrix);
 };
 
 #endif
@@ -0,0 +1,253 @@
+/*
+ * Copyright (c) 2018 A.C. Kockx, All Rights Reserved.
+ */
+
+#include "model/SphereCollisions.h"
+
+#include <math.h>
+#include <algorithm>
+
+//size of the cells relative to the average diameter of the bodies.
+static const float CELL_SIZE_FACTOR = 2;
+//the grid has at most this many cells per body (plus a few), so that clearing and scanning the cells stays linear in the number of bodies.
+static const int MAX_CELLS_PER_BODY = 8;
+//factor by which the cell size is increased until the grid is small enough.
+static const float CELL_SIZE_GROWTH_FACTOR = 1.25f;
+
+SphereCollisions::SphereCollisions(ThreadPool* threadPool) {
+    this->threadPool = threadPool;
+    cellSize = 0;
+    cellCountX = 0;
+    cellCountY = 0;
+    cellCountZ = 0;
+    threadPairs.resize(threadPool->getThreadCount());
+}
+
+void SphereCollisions::sortIntoCells(BodyStore* bodies, BoundingBox bounds) {
+    int bodyCount = bodies->getBodyCount();
+    const float* positionsX = bodies->getPositionsX();
+    const float* positionsY = bodies->getPositionsY();
+    const float* positionsZ = bodies->getPositionsZ();
+    const float* radii = bodies->getRadii();
+
+    //the cells are twice as large as the average body, so that most bodies overlap only a few cells (at most 2 x 2 x 2)
+    //and the larger bodies overlap more cells.
+    float xMin = bounds.getMinX();
+    float yMin = bounds.getMinY();
+    float zMin = bounds.getMinZ();
+    float xSize = bounds.getMaxX() - xMin;
+    float ySize = bounds.getMaxY() - yMin;
+    float zSize = bounds.getMaxZ() - zMin;
+    double diameterSum = 0;
+    for (int body = 0; body < bodyCount; body++) {
+        diameterSum += 2 * radii[body];
+    }
+    cellSize = (float) (CELL_SIZE_FACTOR * diameterSum / bodyCount);
+    if (cellSize <= 0) {
+        cellSize = std::max(xSize, std::max(ySize, zSize));
+    }
+    while (true) {
+        cellCountX = std::max(1, (int) ceil(xSize / cellSize));
+        cellCountY = std::max(1, (int) ceil(ySize / cellSize));
+        cellCountZ = std::max(1, (int) ceil(zSize / cellSize));
+        if ((long long) cellCountX * cellCountY * cellCountZ <= (long long) MAX_CELLS_PER_BODY * bodyCount + 64) {
+            break;
+        }
+        cellSize *= CELL_SIZE_GROWTH_FACTOR;
+    }
+    int cellCount = cellCountX * cellCountY * cellCountZ;
+
+    //cells that the bounding box of every body overlaps, in parallel for bands of bodies. Bodies outside of the boundaries are clamped to the outer cells.
+    bodyCellRanges.resize(6 * bodyCount);
+    float inverseCellSize = 1 / cellSize;
+    threadPool->parallelFor(0, bodyCount, [&](int beginBody, int endBody) {
+        for (int body = beginBody; body < endBody; body++) {
+            float radius = radii[body];
+            float minima[3] = {(positionsX[body] - radius - xMin) * inverseCellSize, (positionsY[body] - radius - yMin) * inverseCellSize, (positionsZ[body] - radius - zMin) * inverseCellSize};
+            float maxima[3] = {(positionsX[body] + radius - xMin) * inverseCellSize, (positionsY[body] + radius - yMin) * inverseCellSize, (positionsZ[body] + radius - zMin) * inverseCellSize};
+            int counts[3] = {cellCountX, cellCountY, cellCountZ};
+            int* range = &bodyCellRanges[6 * body];
+            for (int k = 0; k < 3; k++) {
+                range[2 * k] = (int) std::max(0.0f, std::min((float) (counts[k] - 1), floorf(minima[k])));
+                range[2 * k + 1] = (int) std::max(0.0f, std::min((float) (counts[k] - 1), floorf(maxima[k])));
+            }
+        }
+    });
+
+    //counting sort of the bodies into the cells that they overlap. The bodies are added in ascending order, so every cell lists its bodies in ascending order.
+    cellOffsets.assign(cellCount + 1, 0);
+    for (int body = 0; body < bodyCount; body++) {
+        const int* range = &bodyCellRanges[6 * body];
+        for (int z = range[4]; z <= range[5]; z++) {
+            for (int y = range[2]; y <= range[3]; y++) {
+                for (int x = range[0]; x <= range[1]; x++) {
+                    cellOffsets[(z * cellCountY + y) * cellCountX + x + 1]++;
+                }
+            }
+        }
+    }
+    for (int cell = 0; cell < cellCount; cell++) {
+        cellOffsets[cell + 1] += cellOffsets[cell];
+    }
+    //the spheres and first cells of the bodies are copied along, so that the bodies in a cell can be tested against each other with sequential memory accesses.
+    cellBodies.resize(cellOffsets[cellCount]);
+    cellBodySpheres.resize(4 * cellOffsets[cellCount]);
+    cellBodyFirstCells.resize(3 * cellOffsets[cellCount]);
+    cellCursors.assign(cellOffsets.begin(), cellOffsets.end() - 1);
+    for (int body = 0; body < bodyCount; body++) {
+        const int* range = &bodyCellRanges[6 * body];
+        for (int z = range[4]; z <= range[5]; z++) {
+            for (int y = range[2]; y <= range[3]; y++) {
+                for (int x = range[0]; x <= range[1]; x++) {
+                    int n = cellCursors[(z * cellCountY + y) * cellCountX + x]++;
+                    cellBodies[n] = body;
+                    cellBodySpheres[4 * n] = positionsX[body];
+                    cellBodySpheres[4 * n + 1] = positionsY[body];
+                    cellBodySpheres[4 * n + 2] = positionsZ[body];
+                    cellBodySpheres[4 * n + 3] = radii[body];
+                    cellBodyFirstCells[3 * n] = range[0];
+                    cellBodyFirstCells[3 * n + 1] = range[2];
+                    cellBodyFirstCells[3 * n + 2] = range[4];
+                }
+            }
+        }
+    }
+}
+
+void SphereCollisions::detectCollisions(BodyStore* bodies, BoundingBox bounds) {
+    pairs.clear();
+    int bodyCount = bodies->getBodyCount();
+    if (bodyCount < 2) {
+        return;
+    }
+
+    //broadphase.
+    sortIntoCells(bodies, bounds);
+
+    //test the bodies in every cell against each other, in parallel for one band of cells per thread.
+    int cellCount = cellCountX * cellCountY * cellCountZ;
+    int threadCount = threadPool->getThreadCount();
+    threadPool->parallelFor(0, threadCount, [&](int beginThread, int endThread) {
+        for (int thread = beginThread; thread < endThread; thread++) {
+            vector<int>& foundPairs = threadPairs[thread];
+            foundPairs.clear();
+            for (int cell = (int) ((long long) cellCount * thread / threadCount); cell < (int) ((long long) cellCount * (thread + 1) / threadCount); cell++) {
+                int x = cell % cellCountX;
+                int y = (cell / cellCountX) % cellCountY;
+                int z = cell / (cellCountX * cellCountY);
+                for (int n = cellOffsets[cell]; n < cellOffsets[cell + 1]; n++) {
+                    const float* sphere = &cellBodySpheres[4 * n];
+                    const int* firstCell = &cellBodyFirstCells[3 * n];
+                    for (int otherN = n + 1; otherN < cellOffsets[cell + 1]; otherN++) {
+                        //two bodies can share multiple cells, the pair is only tested in the first one, so that every pair is found once.
+                        const int* otherFirstCell = &cellBodyFirstCells[3 * otherN];
+                        if (std::max(firstCell[0], otherFirstCell[0]) != x || std::max(firstCell[1], otherFirstCell[1]) != y || std::max(firstCell[2], otherFirstCell[2]) != z) {
+                            continue;
+                        }
+
+                        //narrowphase.
+                        const float* otherSphere = &cellBodySpheres[4 * otherN];
+                        float dX = sphere[0] - otherSphere[0];
+                        float dY = sphere[1] - otherSphere[1];
+                        float dZ = sphere[2] - otherSphere[2];
+                        float radiusSum = sphere[3] + otherSphere[3];
+                        if (dX * dX + dY * dY + dZ * dZ < radiusSum * radiusSum) {
+                            foundPairs.push_back(cellBodies[n]);
+                            foundPairs.push_back(cellBodies[otherN]);
+                        }
+                    }
+                }
+            }
+        }
+    });
+
+    //the bands are in ascending order of cells, so the pairs are in the same order for any number of threads.
+    for (int thread = 0; thread < threadCount; thread++) {
+        pairs.insert(pairs.end(), threadPairs[thread].begin(), threadPairs[thread].end());
+    }
+}
+
+void SphereCollisions::resolveCollisions(BodyStore* bodies) {
+    if (pairs.empty()) {
+        return;
+    }
+
+    //the pairs are divided into levels in which every body occurs at most once, so that the pairs of a level can be resolved in parallel.
+    //Every pair gets the first level after the levels of the previous pairs of both its bodies. So the pairs of every body are resolved in their original order,
+    //and the result is the same as resolving all pairs one after another (Gauss-Seidel), for any number of threads.
+    int bodyCount = bodies->getBodyCount();
+    int pairCount = (int) pairs.size() / 2;
+    bodyLevels.assign(bodyCount, 0);
+    pairLevels.resize(pairCount);
+    int levelCount = 0;
+    for (int pair = 0; pair < pairCount; pair++) {
+        int body = pairs[2 * pair];
+        int otherBody = pairs[2 * pair + 1];
+        int level = std::max(bodyLevels[body], bodyLevels[otherBody]);
+        pairLevels[pair] = level;
+        bodyLevels[body] = level + 1;
+        bodyLevels[otherBody] = level + 1;
+        levelCount = std::max(levelCount, level + 1);
+    }
+    levelOffsets.assign(levelCount + 1, 0);
+    for (int pair = 0; pair < pairCount; pair++) {
+        levelOffsets[pairLevels[pair] + 1]++;
+    }
+    for (int level = 0; level < levelCount; level++) {
+        levelOffsets[level + 1] += levelOffsets[level];
+    }
+    levelPairs.resize(pairCount);
+    bodyLevels.assign(levelOffsets.begin(), levelOffsets.end() - 1);//reused as the next free index per level.
+    for (int pair = 0; pair < pairCount; pair++) {
+        levelPairs[bodyLevels[pairLevels[pair]]++] = pair;
+    }
+
+    const float* positionsX = bodies->getPositionsX();
+    const float* positionsY = bodies->getPositionsY();
+    const float* positionsZ = bodies->getPositionsZ();
+    float* velocitiesX = bodies->getVelocitiesX();
+    float* velocitiesY = bodies->getVelocitiesY();
+    float* velocitiesZ = bodies->getVelocitiesZ();
+    const float* masses = bodies->getMasses();
+    for (int level = 0; level < levelCount; level++) {
+        threadPool->parallelFor(levelOffsets[level], levelOffsets[level + 1], [&](int beginPair, int endPair) {
+            for (int n = beginPair; n < endPair; n++) {
+                int pair = levelPairs[n];
+                int body = pairs[2 * pair];
+                int otherBody = pairs[2 * pair + 1];
+
+                //unit vector from the center of the other body to the center of the body.
+                float nX = positionsX[body] - positionsX[otherBody];
+                float nY = positionsY[body] - positionsY[otherBody];
+                float nZ = positionsZ[body] - positionsZ[otherBody];
+                float distance = sqrtf(nX * nX + nY * nY + nZ * nZ);
+                if (distance == 0) {//if the direction is undefined.
+                    continue;
+                }
+                nX /= distance;
+                nY /= distance;
+                nZ /= distance;
+
+                //elastic collision if the bodies move towards each other.
+                float normalVelocity = (velocitiesX[body] - velocitiesX[otherBody]) * nX + (velocitiesY[body] - velocitiesY[otherBody]) * nY
+                        + (velocitiesZ[body] - velocitiesZ[otherBody]) * nZ;
+                if (normalVelocity >= 0) {
+                    continue;
+                }
+                float impulse = -2 * normalVelocity / (1 / masses[body] + 1 / masses[otherBody]);
+                float velocityChange = impulse / masses[body];
+                velocitiesX[body] += velocityChange * nX;
+                velocitiesY[body] += velocityChange * nY;
+                velocitiesZ[body] += velocityChange * nZ;
+                float otherVelocityChange = impulse / masses[otherBody];
+                velocitiesX[otherBody] -= otherVelocityChange * nX;
+                velocitiesY[otherBody] -= otherVelocityChange * nY;
+                velocitiesZ[otherBody] -= otherVelocityChange * nZ;
+            }
+        });
+    }
+}
+
+int SphereCollisions::getCollisionCount() {
+    return (int) pairs.size() / 2;
+}
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2018 A.C. Kockx, All Rights Reserved.
+ */
+
+#include <vector>
+
+#include "util/BoundingBox.h"
+#include "util/ThreadPool.h"
+#include "model/BodyStore.h"
+
+using namespace std;
+
+#ifndef INCLUDED_SPHERECOLLISIONS_H
+#define INCLUDED_SPHERECOLLISIONS_H
+
+/**
+ * Detects and resolves collisions between the spherical bodies in a BodyStore.
+ * The broadphase sorts the bounding boxes of the bodies into a uniform grid of cells that is rebuilt every time step
+ * with a counting sort, so that only bodies that share a cell are tested against each other. The narrowphase tests whether the spheres overlap.
+ * With cells of about twice the size of the bodies the cost is linear in the number of bodies, instead of quadratic for testing all pairs.
+ * All work is done in parallel, but the colliding pairs and the resulting velocities do not depend on the number of threads.
+ */
+class SphereCollisions {
+    private:
+        ThreadPool* threadPool;
+
+        //uniform grid over the simulation boundaries, the cells are stored in x, y, z order.
+        float cellSize;//in m.
+        int cellCountX;
+        int cellCountY;
+        int cellCountZ;
+        vector<int> bodyCellRanges;//per body: first and last cell in x, y and z direction that its bounding box overlaps.
+        vector<int> cellOffsets;//per cell: index of its first body in cellBodies, plus the total at the end.
+        vector<int> cellBodies;//the bodies that overlap each cell, in ascending order per cell.
+        vector<float> cellBodySpheres;//per element of cellBodies: position (x, y, z) and radius of the body.
+        vector<int> cellBodyFirstCells;//per element of cellBodies: first cell in x, y and z direction that the bounding box of the body overlaps.
+        vector<int> cellCursors;//per cell: next free index in cellBodies while sorting.
+
+        //colliding pairs.
+        vector<vector<int>> threadPairs;//per thread: pairs found in its band of bodies.
+        vector<int> pairs;//(body, otherBody) pairs with body < otherBody, in the order of the cells in which they were found.
+        vector<int> bodyLevels;//per body: first level in which it does not occur yet, see resolveCollisions.
+        vector<int> pairLevels;//per pair: level in which it is resolved.
+        vector<int> levelOffsets;//per level: index of its first pair in levelPairs, plus the total at the end.
+        vector<int> levelPairs;//the pairs of each level.
+
+        void sortIntoCells(BodyStore* bodies, BoundingBox bounds);
+
+    public:
+        /**
+         * Creates a collision handler that uses the given threadPool.
+         */
+        SphereCollisions(ThreadPool* threadPool);
+
+        /**
+         * Finds all pairs of bodies in the given store whose spheres overlap. bounds are the simulation boundaries,
+         * bodies outside of them are handled correctly, but are all in the outer cells of the grid.
+         */
+        void detectCollisions(BodyStore* bodies, BoundingBox bounds);
+
+        /**
+         * Changes the velocities of the bodies in all pairs found by detectCollisions that move towards each other with opposite impulses
+         * along the line between their centers, such that the collisions are elastic. The pairs are resolved one after another,
+         * so a body that collides with multiple bodies gets the impulses in turn and momentum and energy are conserved.
+         * Pairs that do not share a body are resolved in parallel, in a fixed order that does not depend on the number of threads.
+         */
+        void resolveCollisions(BodyStore* bodies);
+
+        /**
+         * Returns the number of colliding pairs found by the last call to detectCollisions.
+         */
+        int getCollisionCount();
+};
+
+#endif
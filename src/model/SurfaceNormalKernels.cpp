@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2018 A.C. Kockx, All Rights Reserved.
+ */
+
+#include "model/SurfaceNormalKernels.h"
+
+#include <math.h>
+#include <emmintrin.h>
+
+#include "util/CpuFeatures.h"
+
+void calculateSurfaceNormalRowScalar(const float* west, const float* east, const float* south, const float* north,
+        float* normals, float* gradientsX, float* gradientsY, int count, float xScale, float yScale) {
+    for (int i = 0; i < count; i++) {
+        float gradientX = (east[i] - west[i]) * xScale;
+        float gradientY = (north[i] - south[i]) * yScale;
+        float inverseLength = 1.0f / sqrtf(gradientX * gradientX + gradientY * gradientY + 1.0f);
+
+        gradientsX[i] = gradientX;
+        gradientsY[i] = gradientY;
+        normals[3 * i] = -gradientX * inverseLength;
+        normals[3 * i + 1] = -gradientY * inverseLength;
+        normals[3 * i + 2] = inverseLength;
+    }
+}
+
+void calculateSurfaceNormalRowSse(const float* west, const float* east, const float* south, const float* north,
+        float* normals, float* gradientsX, float* gradientsY, int count, float xScale, float yScale) {
+    const __m128 xScaleVector = _mm_set1_ps(xScale);
+    const __m128 yScaleVector = _mm_set1_ps(yScale);
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 threeHalves = _mm_set1_ps(1.5f);
+    const __m128 signBit = _mm_set1_ps(-0.0f);
+
+    //4 vertices at a time.
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 gradientX = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(east + i), _mm_loadu_ps(west + i)), xScaleVector);
+        __m128 gradientY = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(north + i), _mm_loadu_ps(south + i)), yScaleVector);
+        __m128 squaredLength = _mm_add_ps(_mm_add_ps(_mm_mul_ps(gradientX, gradientX), _mm_mul_ps(gradientY, gradientY)), one);
+        //approximate reciprocal square root (12 bits) refined with one Newton-Raphson iteration: r = r * (1.5 - 0.5 * s * r * r).
+        __m128 inverseLength = _mm_rsqrt_ps(squaredLength);
+        inverseLength = _mm_mul_ps(inverseLength, _mm_sub_ps(threeHalves, _mm_mul_ps(_mm_mul_ps(half, squaredLength), _mm_mul_ps(inverseLength, inverseLength))));
+        _mm_storeu_ps(gradientsX + i, gradientX);
+        _mm_storeu_ps(gradientsY + i, gradientY);
+
+        //interleave the normal components (x0 x1 x2 x3), (y0 y1 y2 y3), (z0 z1 z2 z3) to (x0 y0 z0 x1), (y1 z1 x2 y2), (z2 x3 y3 z3).
+        __m128 x = _mm_xor_ps(_mm_mul_ps(gradientX, inverseLength), signBit);
+        __m128 y = _mm_xor_ps(_mm_mul_ps(gradientY, inverseLength), signBit);
+        __m128 z = inverseLength;
+        __m128 x0y0x1y1 = _mm_unpacklo_ps(x, y);
+        __m128 x2y2x3y3 = _mm_unpackhi_ps(x, y);
+        __m128 z0z0x1x1 = _mm_shuffle_ps(z, x, _MM_SHUFFLE(1, 1, 0, 0));
+        __m128 y1y1z1z1 = _mm_shuffle_ps(y, z, _MM_SHUFFLE(1, 1, 1, 1));
+        __m128 z2z3x3y3 = _mm_shuffle_ps(z, x2y2x3y3, _MM_SHUFFLE(3, 2, 3, 2));
+        _mm_storeu_ps(normals + 3 * i, _mm_shuffle_ps(x0y0x1y1, z0z0x1x1, _MM_SHUFFLE(2, 0, 1, 0)));
+        _mm_storeu_ps(normals + 3 * i + 4, _mm_shuffle_ps(y1y1z1z1, x2y2x3y3, _MM_SHUFFLE(1, 0, 2, 0)));
+        _mm_storeu_ps(normals + 3 * i + 8, _mm_shuffle_ps(z2z3x3y3, z2z3x3y3, _MM_SHUFFLE(1, 3, 2, 0)));
+    }
+
+    //remaining vertices.
+    calculateSurfaceNormalRowScalar(west + i, east + i, south + i, north + i, normals + 3 * i, gradientsX + i, gradientsY + i, count - i, xScale, yScale);
+}
+
+SurfaceNormalRowKernel getSurfaceNormalRowKernel(int instructionSet) {
+    switch (instructionSet) {
+        case AVX512_INSTRUCTION_SET:
+            return calculateSurfaceNormalRowAvx512;
+        case AVX2_INSTRUCTION_SET:
+            return calculateSurfaceNormalRowAvx2;
+        case SSE_INSTRUCTION_SET:
+            return calculateSurfaceNormalRowSse;
+        default:
+            return calculateSurfaceNormalRowScalar;
+    }
+}
@@ -0,0 +1,47 @@
+/*
+ * Copyright (c) 2018 A.C. Kockx, All Rights Reserved.
+ */
+
+#ifndef INCLUDED_SURFACENORMALKERNELS_H
+#define INCLUDED_SURFACENORMALKERNELS_H
+
+/**
+ * Kernel that calculates the surface gradients and normal vectors (in model space) for count consecutive vertices of one grid row
+ * using finite-difference approximations of the first derivatives of the surface height:
+ *
+ * gradientX = (east - west) * xScale
+ * gradientY = (north - south) * yScale
+ * normal = normalize(cross((1, 0, gradientX), (0, 1, gradientY))) = (-gradientX, -gradientY, 1) / sqrt(gradientX^2 + gradientY^2 + 1)
+ *
+ * west, east, south and north point to the surface heights of the neighbours of the first vertex to calculate.
+ * For a central difference these are the adjacent vertices and the scale is 1 / (2 * dX) or 1 / (2 * dY),
+ * for a one-sided difference at an edge one of them is the vertex itself and the scale is 1 / dX or 1 / dY.
+ * normals receives 3 floats (x, y, z) per vertex, gradientsX and gradientsY receive 1 float per vertex.
+ *
+ * All implementations calculate bitwise identical gradients. The vectorized implementations normalize using
+ * an approximate reciprocal square root that is refined with one Newton-Raphson iteration, so their normals
+ * can differ from the scalar reference implementation in the last bits.
+ */
+typedef void (*SurfaceNormalRowKernel)(const float* west, const float* east, const float* south, const float* north,
+        float* normals, float* gradientsX, float* gradientsY, int count, float xScale, float yScale);
+
+/**
+ * Implementations for the different instruction sets.
+ * The scalar implementation is the reference that the vectorized implementations can be compared to.
+ */
+void calculateSurfaceNormalRowScalar(const float* west, const float* east, const float* south, const float* north,
+        float* normals, float* gradientsX, float* gradientsY, int count, float xScale, float yScale);
+void calculateSurfaceNormalRowSse(const float* west, const float* east, const float* south, const float* north,
+        float* normals, float* gradientsX, float* gradientsY, int count, float xScale, float yScale);
+void calculateSurfaceNormalRowAvx2(const float* west, const float* east, const float* south, const float* north,
+        float* normals, float* gradientsX, float* gradientsY, int count, float xScale, float yScale);
+void calculateSurfaceNormalRowAvx512(const float* west, const float* east, const float* south, const float* north,
+        float* normals, float* gradientsX, float* gradientsY, int count, float xScale, float yScale);
+
+/**
+ * Returns the implementation for the given instruction set (see CpuFeatures.h).
+ * The caller is responsible for checking that the instruction set is supported.
+ */
+SurfaceNormalRowKernel getSurfaceNormalRowKernel(int instructionSet);
+
+#endif
@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2018 A.C. Kockx, All Rights Reserved.
+ *
+ * AVX2 implementations of the kernels in SurfaceNormalKernels.h.
+ * The functions in this file must only be called if the processor supports AVX2 (see CpuFeatures.h).
+ */
+
+//GCC and Clang only allow AVX2 intrinsics in code that is compiled for AVX2. Do not enable FMA,
+//since fused multiply-add would change the rounding of the gradients compared to the scalar reference implementation.
+#if defined(__GNUC__) && !defined(__AVX2__)
+#pragma GCC target("avx2")
+#endif
+
+#include "model/SurfaceNormalKernels.h"
+
+#include <immintrin.h>
+
+void calculateSurfaceNormalRowAvx2(const float* west, const float* east, const float* south, const float* north,
+        float* normals, float* gradientsX, float* gradientsY, int count, float xScale, float yScale) {
+    const __m256 xScaleVector = _mm256_set1_ps(xScale);
+    const __m256 yScaleVector = _mm256_set1_ps(yScale);
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 half = _mm256_set1_ps(0.5f);
+    const __m256 threeHalves = _mm256_set1_ps(1.5f);
+    const __m256 signBit = _mm256_set1_ps(-0.0f);
+
+    //8 vertices at a time.
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 gradientX = _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(east + i), _mm256_loadu_ps(west + i)), xScaleVector);
+        __m256 gradientY = _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(north + i), _mm256_loadu_ps(south + i)), yScaleVector);
+        __m256 squaredLength = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(gradientX, gradientX), _mm256_mul_ps(gradientY, gradientY)), one);
+        //approximate reciprocal square root (12 bits) refined with one Newton-Raphson iteration: r = r * (1.5 - 0.5 * s * r * r).
+        __m256 inverseLength = _mm256_rsqrt_ps(squaredLength);
+        inverseLength = _mm256_mul_ps(inverseLength, _mm256_sub_ps(threeHalves, _mm256_mul_ps(_mm256_mul_ps(half, squaredLength), _mm256_mul_ps(inverseLength, inverseLength))));
+        _mm256_storeu_ps(gradientsX + i, gradientX);
+        _mm256_storeu_ps(gradientsY + i, gradientY);
+
+        //interleave the normal components within each 128-bit lane in the same way as calculateSurfaceNormalRowSse,
+        //then put the lanes in the right order: the low lanes contain floats 0-11 and the high lanes floats 12-23.
+        __m256 x = _mm256_xor_ps(_mm256_mul_ps(gradientX, inverseLength), signBit);
+        __m256 y = _mm256_xor_ps(_mm256_mul_ps(gradientY, inverseLength), signBit);
+        __m256 z = inverseLength;
+        __m256 x0y0x1y1 = _mm256_unpacklo_ps(x, y);
+        __m256 x2y2x3y3 = _mm256_unpackhi_ps(x, y);
+        __m256 z0z0x1x1 = _mm256_shuffle_ps(z, x, _MM_SHUFFLE(1, 1, 0, 0));
+        __m256 y1y1z1z1 = _mm256_shuffle_ps(y, z, _MM_SHUFFLE(1, 1, 1, 1));
+        __m256 z2z3x3y3 = _mm256_shuffle_ps(z, x2y2x3y3, _MM_SHUFFLE(3, 2, 3, 2));
+        __m256 first = _mm256_shuffle_ps(x0y0x1y1, z0z0x1x1, _MM_SHUFFLE(2, 0, 1, 0));
+        __m256 second = _mm256_shuffle_ps(y1y1z1z1, x2y2x3y3, _MM_SHUFFLE(1, 0, 2, 0));
+        __m256 third = _mm256_shuffle_ps(z2z3x3y3, z2z3x3y3, _MM_SHUFFLE(1, 3, 2, 0));
+        _mm256_storeu_ps(normals + 3 * i, _mm256_permute2f128_ps(first, second, 0x20));
+        _mm256_storeu_ps(normals + 3 * i + 8, _mm256_permute2f128_ps(third, first, 0x30));
+        _mm256_storeu_ps(normals + 3 * i + 16, _mm256_permute2f128_ps(second, third, 0x31));
+    }
+
+    //remaining vertices.
+    calculateSurfaceNormalRowSse(west + i, east + i, south + i, north + i, normals + 3 * i, gradientsX + i, gradientsY + i, count - i, xScale, yScale);
+}
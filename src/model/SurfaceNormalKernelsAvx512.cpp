@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2018 A.C. Kockx, All Rights Reserved.
+ *
+ * AVX-512 implementations of the kernels in SurfaceNormalKernels.h.
+ * The functions in this file must only be called if the processor supports AVX-512F (see CpuFeatures.h).
+ */
+
+//GCC and Clang only allow AVX-512 intrinsics in code that is compiled for AVX-512. AVX-512F implies FMA,
+//so also disable floating point contraction, since fused multiply-add would change the rounding of the gradients
+//compared to the scalar reference implementation.
+#if defined(__GNUC__)
+#if !defined(__AVX512F__)
+#pragma GCC target("avx512f")
+#endif
+#if !defined(__clang__)
+#pragma GCC optimize("fp-contract=off")
+#else
+#pragma clang fp contract(off)
+#endif
+#endif
+
+#include "model/SurfaceNormalKernels.h"
+
+#include <immintrin.h>
+
+void calculateSurfaceNormalRowAvx512(const float* west, const float* east, const float* south, const float* north,
+        float* normals, float* gradientsX, float* gradientsY, int count, float xScale, float yScale) {
+    const __m512 xScaleVector = _mm512_set1_ps(xScale);
+    const __m512 yScaleVector = _mm512_set1_ps(yScale);
+    const __m512 one = _mm512_set1_ps(1.0f);
+    const __m512 half = _mm512_set1_ps(0.5f);
+    const __m512 threeHalves = _mm512_set1_ps(1.5f);
+    const __m512 minusOne = _mm512_set1_ps(-1.0f);
+
+    //permutations that interleave the normal components of 16 vertices to 48 floats (x0 y0 z0 x1 y1 z1 ...).
+    //Float f of the output is component f % 3 of vertex f / 3. First the x and y components are combined (index 16 + n
+    //selects y[n]), then the z components are inserted with a mask.
+    __m512i xyIndices[3];
+    __m512i zIndices[3];
+    __mmask16 zMasks[3];
+    for (int part = 0; part < 3; part++) {
+        int xyIndexValues[16];
+        int zIndexValues[16];
+        zMasks[part] = 0;
+        for (int n = 0; n < 16; n++) {
+            int f = 16 * part + n;
+            int vertex = f / 3;
+            xyIndexValues[n] = f % 3 == 1 ? 16 + vertex : vertex;
+            zIndexValues[n] = vertex;
+            if (f % 3 == 2) {
+                zMasks[part] |= (__mmask16) (1u << n);
+            }
+        }
+        xyIndices[part] = _mm512_loadu_si512(xyIndexValues);
+        zIndices[part] = _mm512_loadu_si512(zIndexValues);
+    }
+
+    //16 vertices at a time, the remaining vertices are handled with a masked iteration.
+    for (int i = 0; i < count; i += 16) {
+        int remainingCount = count - i;
+        __mmask16 mask = remainingCount >= 16 ? (__mmask16) 0xFFFF : (__mmask16) ((1u << remainingCount) - 1);
+
+        __m512 gradientX = _mm512_mul_ps(_mm512_sub_ps(_mm512_maskz_loadu_ps(mask, east + i), _mm512_maskz_loadu_ps(mask, west + i)), xScaleVector);
+        __m512 gradientY = _mm512_mul_ps(_mm512_sub_ps(_mm512_maskz_loadu_ps(mask, north + i), _mm512_maskz_loadu_ps(mask, south + i)), yScaleVector);
+        __m512 squaredLength = _mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(gradientX, gradientX), _mm512_mul_ps(gradientY, gradientY)), one);
+        //approximate reciprocal square root (14 bits) refined with one Newton-Raphson iteration: r = r * (1.5 - 0.5 * s * r * r).
+        __m512 inverseLength = _mm512_maskz_rsqrt14_ps((__mmask16) 0xFFFF, squaredLength);
+        inverseLength = _mm512_mul_ps(inverseLength, _mm512_sub_ps(threeHalves, _mm512_mul_ps(_mm512_mul_ps(half, squaredLength), _mm512_mul_ps(inverseLength, inverseLength))));
+        _mm512_mask_storeu_ps(gradientsX + i, mask, gradientX);
+        _mm512_mask_storeu_ps(gradientsY + i, mask, gradientY);
+
+        //negating by multiplying with -1 is exact, so this gives the same normals as flipping the sign bit.
+        __m512 x = _mm512_mul_ps(_mm512_mul_ps(gradientX, inverseLength), minusOne);
+        __m512 y = _mm512_mul_ps(_mm512_mul_ps(gradientY, inverseLength), minusOne);
+        __m512 z = inverseLength;
+        for (int part = 0; part < 3; part++) {
+            int remainingFloatCount = 3 * remainingCount - 16 * part;
+            if (remainingFloatCount <= 0) {
+                break;
+            }
+            __mmask16 partMask = remainingFloatCount >= 16 ? (__mmask16) 0xFFFF : (__mmask16) ((1u << remainingFloatCount) - 1);
+            __m512 xy = _mm512_permutex2var_ps(x, xyIndices[part], y);
+            __m512 xyz = _mm512_mask_permutexvar_ps(xy, zMasks[part], zIndices[part], z);
+            _mm512_mask_storeu_ps(normals + 3 * i + 16 * part, partMask, xyz);
+        }
+    }
+}
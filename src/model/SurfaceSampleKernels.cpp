@@ -0,0 +1,177 @@
+/*
+ * Copyright (c) 2018 A.C. Kockx, All Rights Reserved.
+ */
+
+#include "model/SurfaceSampleKernels.h"
+
+#include <algorithm>
+#include <math.h>
+#include <emmintrin.h>
+
+#include "util/CpuFeatures.h"
+
+static inline float interpolate(float value00, float value01, float value10, float value11, float fractionX, float fractionY) {
+    //first along the rows, then between the rows.
+    float south = value00 + (value01 - value00) * fractionX;
+    float north = value10 + (value11 - value10) * fractionX;
+    return south + (north - south) * fractionY;
+}
+
+static inline __m128 interpolate(__m128 value00, __m128 value01, __m128 value10, __m128 value11, __m128 fractionX, __m128 fractionY) {
+    __m128 south = _mm_add_ps(value00, _mm_mul_ps(_mm_sub_ps(value01, value00), fractionX));
+    __m128 north = _mm_add_ps(value10, _mm_mul_ps(_mm_sub_ps(value11, value10), fractionX));
+    return _mm_add_ps(south, _mm_mul_ps(_mm_sub_ps(north, south), fractionY));
+}
+
+void sampleSurfaceScalar(const float* heightValues, int rowCount, int columnCount, int rowPitch, const float* geometry,
+        const float* xValues, const float* yValues, float* heights, float* gradientsX, float* gradientsY, int count) {
+    const float maxColumn = (float) (columnCount - 1);
+    const float maxRow = (float) (rowCount - 1);
+    const float lastCellColumn = (float) (columnCount - 2);
+    const float lastCellRow = (float) (rowCount - 2);
+    const float halfInverseDX = 0.5f * geometry[2];
+    const float halfInverseDY = 0.5f * geometry[3];
+    for (int i = 0; i < count; i++) {
+        //convert x,y to fractional column and row.
+        float u = (xValues[i] - geometry[0]) * geometry[2];
+        float v = (yValues[i] - geometry[1]) * geometry[3];
+        if (!(u >= 0 && u <= maxColumn && v >= 0 && v <= maxRow)) {//if outside of surface (or not a number).
+            heights[i] = -INFINITY;
+            gradientsX[i] = 0;
+            gradientsY[i] = 0;
+            continue;
+        }
+
+        //grid cell that contains the point, a point on the last row or column belongs to the cell before it.
+        int column = (int) std::min(u, lastCellColumn);
+        int row = (int) std::min(v, lastCellRow);
+        float fractionX = u - (float) column;
+        float fractionY = v - (float) row;
+
+        //offsets of the neighbours of the 4 vertices of the cell that are needed for their gradients, relative to the south-west vertex.
+        //At the edges of the grid the vertex itself is used instead, with twice the factor (one-sided difference).
+        const float* value = heightValues + row * rowPitch + column;
+        int west = column == 0 ? 0 : -1;
+        int east = column == columnCount - 2 ? 1 : 2;
+        int south = row == 0 ? 0 : -rowPitch;
+        int north = row == rowCount - 2 ? rowPitch : 2 * rowPitch;
+        float westFactor = column == 0 ? geometry[2] : halfInverseDX;
+        float eastFactor = column == columnCount - 2 ? geometry[2] : halfInverseDX;
+        float southFactor = row == 0 ? geometry[3] : halfInverseDY;
+        float northFactor = row == rowCount - 2 ? geometry[3] : halfInverseDY;
+
+        float value00 = value[0];
+        float value01 = value[1];
+        float value10 = value[rowPitch];
+        float value11 = value[rowPitch + 1];
+        heights[i] = geometry[4] + interpolate(value00, value01, value10, value11, fractionX, fractionY);
+        gradientsX[i] = interpolate((value01 - value[west]) * westFactor, (value[east] - value00) * eastFactor,
+                (value11 - value[rowPitch + west]) * westFactor, (value[rowPitch + east] - value10) * eastFactor, fractionX, fractionY);
+        gradientsY[i] = interpolate((value10 - value[south]) * southFactor, (value11 - value[south + 1]) * southFactor,
+                (value[north] - value00) * northFactor, (value[north + 1] - value01) * northFactor, fractionX, fractionY);
+    }
+}
+
+void sampleSurfaceSse(const float* heightValues, int rowCount, int columnCount, int rowPitch, const float* geometry,
+        const float* xValues, const float* yValues, float* heights, float* gradientsX, float* gradientsY, int count) {
+    const __m128 firstColumnX = _mm_set1_ps(geometry[0]);
+    const __m128 firstRowY = _mm_set1_ps(geometry[1]);
+    const __m128 inverseDX = _mm_set1_ps(geometry[2]);
+    const __m128 inverseDY = _mm_set1_ps(geometry[3]);
+    const __m128 halfInverseDX = _mm_set1_ps(0.5f * geometry[2]);
+    const __m128 halfInverseDY = _mm_set1_ps(0.5f * geometry[3]);
+    const __m128 z = _mm_set1_ps(geometry[4]);
+    const __m128 maxColumn = _mm_set1_ps((float) (columnCount - 1));
+    const __m128 maxRow = _mm_set1_ps((float) (rowCount - 1));
+    const __m128 lastCellColumn = _mm_set1_ps((float) (columnCount - 2));
+    const __m128 lastCellRow = _mm_set1_ps((float) (rowCount - 2));
+    const __m128 minusInfinity = _mm_set1_ps(-INFINITY);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128i zeroInteger = _mm_setzero_si128();
+    const __m128i lastCellColumnInteger = _mm_set1_epi32(columnCount - 2);
+    const __m128i lastCellRowInteger = _mm_set1_epi32(rowCount - 2);
+
+    //4 points at a time. Points outside of the surface are clamped to it, so that all loads are within the grid, and their results are replaced afterwards.
+    //SSE has no gather instruction, so the surface heights are loaded one at a time.
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 u = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(xValues + i), firstColumnX), inverseDX);
+        __m128 v = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(yValues + i), firstRowY), inverseDY);
+        __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(u, zero), _mm_cmple_ps(u, maxColumn)), _mm_and_ps(_mm_cmpge_ps(v, zero), _mm_cmple_ps(v, maxRow)));
+        u = _mm_min_ps(_mm_max_ps(u, zero), maxColumn);//max returns zero if u is not a number.
+        v = _mm_min_ps(_mm_max_ps(v, zero), maxRow);
+        __m128i column = _mm_cvttps_epi32(_mm_min_ps(u, lastCellColumn));
+        __m128i row = _mm_cvttps_epi32(_mm_min_ps(v, lastCellRow));
+        __m128 fractionX = _mm_sub_ps(u, _mm_cvtepi32_ps(column));
+        __m128 fractionY = _mm_sub_ps(v, _mm_cvtepi32_ps(row));
+
+        //factors of the differences, twice as large at the edges of the grid.
+        __m128 westEdge = _mm_castsi128_ps(_mm_cmpeq_epi32(column, zeroInteger));
+        __m128 eastEdge = _mm_castsi128_ps(_mm_cmpeq_epi32(column, lastCellColumnInteger));
+        __m128 southEdge = _mm_castsi128_ps(_mm_cmpeq_epi32(row, zeroInteger));
+        __m128 northEdge = _mm_castsi128_ps(_mm_cmpeq_epi32(row, lastCellRowInteger));
+        __m128 westFactor = _mm_or_ps(_mm_and_ps(westEdge, inverseDX), _mm_andnot_ps(westEdge, halfInverseDX));
+        __m128 eastFactor = _mm_or_ps(_mm_and_ps(eastEdge, inverseDX), _mm_andnot_ps(eastEdge, halfInverseDX));
+        __m128 southFactor = _mm_or_ps(_mm_and_ps(southEdge, inverseDY), _mm_andnot_ps(southEdge, halfInverseDY));
+        __m128 northFactor = _mm_or_ps(_mm_and_ps(northEdge, inverseDY), _mm_andnot_ps(northEdge, halfInverseDY));
+
+        //load the surface heights of the 4 vertices of every cell and of their neighbours, with the same offsets as the scalar implementation.
+        int columns[4];
+        int rows[4];
+        _mm_storeu_si128((__m128i*) columns, column);
+        _mm_storeu_si128((__m128i*) rows, row);
+        float values[12][4];
+        for (int k = 0; k < 4; k++) {
+            const float* value = heightValues + rows[k] * rowPitch + columns[k];
+            int west = columns[k] == 0 ? 0 : -1;
+            int east = columns[k] == columnCount - 2 ? 1 : 2;
+            int south = rows[k] == 0 ? 0 : -rowPitch;
+            int north = rows[k] == rowCount - 2 ? rowPitch : 2 * rowPitch;
+            values[0][k] = value[0];
+            values[1][k] = value[1];
+            values[2][k] = value[rowPitch];
+            values[3][k] = value[rowPitch + 1];
+            values[4][k] = value[west];
+            values[5][k] = value[east];
+            values[6][k] = value[rowPitch + west];
+            values[7][k] = value[rowPitch + east];
+            values[8][k] = value[south];
+            values[9][k] = value[south + 1];
+            values[10][k] = value[north];
+            values[11][k] = value[north + 1];
+        }
+        __m128 value00 = _mm_loadu_ps(values[0]);
+        __m128 value01 = _mm_loadu_ps(values[1]);
+        __m128 value10 = _mm_loadu_ps(values[2]);
+        __m128 value11 = _mm_loadu_ps(values[3]);
+
+        __m128 height = _mm_add_ps(z, interpolate(value00, value01, value10, value11, fractionX, fractionY));
+        __m128 gradientX = interpolate(_mm_mul_ps(_mm_sub_ps(value01, _mm_loadu_ps(values[4])), westFactor),
+                _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(values[5]), value00), eastFactor),
+                _mm_mul_ps(_mm_sub_ps(value11, _mm_loadu_ps(values[6])), westFactor),
+                _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(values[7]), value10), eastFactor), fractionX, fractionY);
+        __m128 gradientY = interpolate(_mm_mul_ps(_mm_sub_ps(value10, _mm_loadu_ps(values[8])), southFactor),
+                _mm_mul_ps(_mm_sub_ps(value11, _mm_loadu_ps(values[9])), southFactor),
+                _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(values[10]), value00), northFactor),
+                _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(values[11]), value01), northFactor), fractionX, fractionY);
+        _mm_storeu_ps(heights + i, _mm_or_ps(_mm_and_ps(inside, height), _mm_andnot_ps(inside, minusInfinity)));
+        _mm_storeu_ps(gradientsX + i, _mm_and_ps(inside, gradientX));
+        _mm_storeu_ps(gradientsY + i, _mm_and_ps(inside, gradientY));
+    }
+
+    //remaining points.
+    sampleSurfaceScalar(heightValues, rowCount, columnCount, rowPitch, geometry, xValues + i, yValues + i, heights + i, gradientsX + i, gradientsY + i, count - i);
+}
+
+SurfaceSampleKernel getSurfaceSampleKernel(int instructionSet) {
+    switch (instructionSet) {
+        case AVX512_INSTRUCTION_SET:
+            return sampleSurfaceAvx512;
+        case AVX2_INSTRUCTION_SET:
+            return sampleSurfaceAvx2;
+        case SSE_INSTRUCTION_SET:
+            return sampleSurfaceSse;
+        default:
+            return sampleSurfaceScalar;
+    }
+}
@@ -0,0 +1,47 @@
+/*
+ * Copyright (c) 2018 A.C. Kockx, All Rights Reserved.
+ */
+
+#ifndef INCLUDED_SURFACESAMPLEKERNELS_H
+#define INCLUDED_SURFACESAMPLEKERNELS_H
+
+/**
+ * Kernel that samples a grid of surface heights (with the given number of rows and columns and the given row pitch, see WaterSurface)
+ * at count points (xValues[i], yValues[i]) in world space. geometry contains the x coordinate of the first column and the y coordinate
+ * of the first row (in world space), 1 / dX, 1 / dY and the z coordinate of the surface (in world space). For every point within the grid
+ *
+ * heights[i] = z + bilinear interpolation of the 4 surface heights of the grid cell that contains the point
+ * gradientsX[i], gradientsY[i] = bilinear interpolation of the gradients at the same 4 vertices
+ *
+ * where the gradient at a vertex is the central difference of its neighbours (or the one-sided difference at the edges of the grid),
+ * like in WaterSurface::getSurfaceGradient. So the heights and gradients are continuous when a point moves from one grid cell to the next.
+ * Points outside of the grid get a height of -infinity and a gradient of zero. rowCount and columnCount must be at least 2.
+ *
+ * All implementations perform exactly the same floating point operations in the same order without fused multiply-add,
+ * so all implementations produce bitwise identical results.
+ */
+typedef void (*SurfaceSampleKernel)(const float* heightValues, int rowCount, int columnCount, int rowPitch, const float* geometry,
+        const float* xValues, const float* yValues, float* heights, float* gradientsX, float* gradientsY, int count);
+
+/**
+ * Implementations for the different instruction sets.
+ * The scalar implementation is the reference that the vectorized implementations can be compared to.
+ * The vectorized implementations load the surface heights of multiple points at once with gather instructions (AVX2 and AVX-512)
+ * or with scalar loads (SSE, which has no gather instruction).
+ */
+void sampleSurfaceScalar(const float* heightValues, int rowCount, int columnCount, int rowPitch, const float* geometry,
+        const float* xValues, const float* yValues, float* heights, float* gradientsX, float* gradientsY, int count);
+void sampleSurfaceSse(const float* heightValues, int rowCount, int columnCount, int rowPitch, const float* geometry,
+        const float* xValues, const float* yValues, float* heights, float* gradientsX, float* gradientsY, int count);
+void sampleSurfaceAvx2(const float* heightValues, int rowCount, int columnCount, int rowPitch, const float* geometry,
+        const float* xValues, const float* yValues, float* heights, float* gradientsX, float* gradientsY, int count);
+void sampleSurfaceAvx512(const float* heightValues, int rowCount, int columnCount, int rowPitch, const float* geometry,
+        const float* xValues, const float* yValues, float* heights, float* gradientsX, float* gradientsY, int count);
+
+/**
+ * Returns the implementation for the given instruction set (see CpuFeatures.h).
+ * The caller is responsible for checking that the instruction set is supported.
+ */
+SurfaceSampleKernel getSurfaceSampleKernel(int instructionSet);
+
+#endif
@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2018 A.C. Kockx, All Rights Reserved.
+ *
+ * AVX2 implementations of the kernels in SurfaceSampleKernels.h.
+ * The functions in this file must only be called if the processor supports AVX2 (see CpuFeatures.h).
+ */
+
+//GCC and Clang only allow AVX2 intrinsics in code that is compiled for AVX2. Do not enable FMA,
+//since fused multiply-add would change the rounding compared to the scalar reference implementation.
+#if defined(__GNUC__) && !defined(__AVX2__)
+#pragma GCC target("avx2")
+#endif
+
+#include "model/SurfaceSampleKernels.h"
+
+#include <math.h>
+#include <immintrin.h>
+
+static inline __m256 interpolate(__m256 value00, __m256 value01, __m256 value10, __m256 value11, __m256 fractionX, __m256 fractionY) {
+    __m256 south = _mm256_add_ps(value00, _mm256_mul_ps(_mm256_sub_ps(value01, value00), fractionX));
+    __m256 north = _mm256_add_ps(value10, _mm256_mul_ps(_mm256_sub_ps(value11, value10), fractionX));
+    return _mm256_add_ps(south, _mm256_mul_ps(_mm256_sub_ps(north, south), fractionY));
+}
+
+static inline __m256 gather(const float* heightValues, __m256i indices) {
+    return _mm256_i32gather_ps(heightValues, indices, 4);
+}
+
+void sampleSurfaceAvx2(const float* heightValues, int rowCount, int columnCount, int rowPitch, const float* geometry,
+        const float* xValues, const float* yValues, float* heights, float* gradientsX, float* gradientsY, int count) {
+    const __m256 firstColumnX = _mm256_set1_ps(geometry[0]);
+    const __m256 firstRowY = _mm256_set1_ps(geometry[1]);
+    const __m256 inverseDX = _mm256_set1_ps(geometry[2]);
+    const __m256 inverseDY = _mm256_set1_ps(geometry[3]);
+    const __m256 halfInverseDX = _mm256_set1_ps(0.5f * geometry[2]);
+    const __m256 halfInverseDY = _mm256_set1_ps(0.5f * geometry[3]);
+    const __m256 z = _mm256_set1_ps(geometry[4]);
+    const __m256 maxColumn = _mm256_set1_ps((float) (columnCount - 1));
+    const __m256 maxRow = _mm256_set1_ps((float) (rowCount - 1));
+    const __m256 lastCellColumn = _mm256_set1_ps((float) (columnCount - 2));
+    const __m256 lastCellRow = _mm256_set1_ps((float) (rowCount - 2));
+    const __m256 minusInfinity = _mm256_set1_ps(-INFINITY);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256i zeroInteger = _mm256_setzero_si256();
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256i lastCellColumnInteger = _mm256_set1_epi32(columnCount - 2);
+    const __m256i lastCellRowInteger = _mm256_set1_epi32(rowCount - 2);
+    const __m256i rowPitchVector = _mm256_set1_epi32(rowPitch);
+
+    //8 points at a time. Points outside of the surface are clamped to it, so that all gathers are within the grid, and their results are replaced afterwards.
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 u = _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(xValues + i), firstColumnX), inverseDX);
+        __m256 v = _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(yValues + i), firstRowY), inverseDY);
+        __m256 inside = _mm256_and_ps(_mm256_and_ps(_mm256_cmp_ps(u, zero, _CMP_GE_OQ), _mm256_cmp_ps(u, maxColumn, _CMP_LE_OQ)),
+                _mm256_and_ps(_mm256_cmp_ps(v, zero, _CMP_GE_OQ), _mm256_cmp_ps(v, maxRow, _CMP_LE_OQ)));
+        u = _mm256_min_ps(_mm256_max_ps(u, zero), maxColumn);//max returns zero if u is not a number.
+        v = _mm256_min_ps(_mm256_max_ps(v, zero), maxRow);
+        __m256i column = _mm256_cvttps_epi32(_mm256_min_ps(u, lastCellColumn));
+        __m256i row = _mm256_cvttps_epi32(_mm256_min_ps(v, lastCellRow));
+        __m256 fractionX = _mm256_sub_ps(u, _mm256_cvtepi32_ps(column));
+        __m256 fractionY = _mm256_sub_ps(v, _mm256_cvtepi32_ps(row));
+
+        //factors of the differences, twice as large at the edges of the grid.
+        __m256i westEdge = _mm256_cmpeq_epi32(column, zeroInteger);
+        __m256i eastEdge = _mm256_cmpeq_epi32(column, lastCellColumnInteger);
+        __m256i southEdge = _mm256_cmpeq_epi32(row, zeroInteger);
+        __m256i northEdge = _mm256_cmpeq_epi32(row, lastCellRowInteger);
+        __m256 westFactor = _mm256_blendv_ps(halfInverseDX, inverseDX, _mm256_castsi256_ps(westEdge));
+        __m256 eastFactor = _mm256_blendv_ps(halfInverseDX, inverseDX, _mm256_castsi256_ps(eastEdge));
+        __m256 southFactor = _mm256_blendv_ps(halfInverseDY, inverseDY, _mm256_castsi256_ps(southEdge));
+        __m256 northFactor = _mm256_blendv_ps(halfInverseDY, inverseDY, _mm256_castsi256_ps(northEdge));
+
+        //indices of the 4 vertices of every cell and offsets of their neighbours, with the same offsets as the scalar implementation.
+        //The edge masks are -1 where true, so adding them (or the negated row pitch where true) moves an offset back by one vertex.
+        __m256i index = _mm256_add_epi32(_mm256_mullo_epi32(row, rowPitchVector), column);
+        __m256i northIndex = _mm256_add_epi32(index, rowPitchVector);
+        __m256i west = _mm256_andnot_si256(westEdge, _mm256_set1_epi32(-1));
+        __m256i east = _mm256_add_epi32(_mm256_set1_epi32(2), eastEdge);
+        __m256i south = _mm256_andnot_si256(southEdge, _mm256_set1_epi32(-rowPitch));
+        __m256i north = _mm256_add_epi32(_mm256_set1_epi32(2 * rowPitch), _mm256_and_si256(northEdge, _mm256_set1_epi32(-rowPitch)));
+
+        __m256 value00 = gather(heightValues, index);
+        __m256 value01 = gather(heightValues, _mm256_add_epi32(index, one));
+        __m256 value10 = gather(heightValues, northIndex);
+        __m256 value11 = gather(heightValues, _mm256_add_epi32(northIndex, one));
+
+        __m256 height = _mm256_add_ps(z, interpolate(value00, value01, value10, value11, fractionX, fractionY));
+        __m256 gradientX = interpolate(_mm256_mul_ps(_mm256_sub_ps(value01, gather(heightValues, _mm256_add_epi32(index, west))), westFactor),
+                _mm256_mul_ps(_mm256_sub_ps(gather(heightValues, _mm256_add_epi32(index, east)), value00), eastFactor),
+                _mm256_mul_ps(_mm256_sub_ps(value11, gather(heightValues, _mm256_add_epi32(northIndex, west))), westFactor),
+                _mm256_mul_ps(_mm256_sub_ps(gather(heightValues, _mm256_add_epi32(northIndex, east)), value10), eastFactor), fractionX, fractionY);
+        __m256i southIndex = _mm256_add_epi32(index, south);
+        __m256i farNorthIndex = _mm256_add_epi32(index, north);
+        __m256 gradientY = interpolate(_mm256_mul_ps(_mm256_sub_ps(value10, gather(heightValues, southIndex)), southFactor),
+                _mm256_mul_ps(_mm256_sub_ps(value11, gather(heightValues, _mm256_add_epi32(southIndex, one))), southFactor),
+                _mm256_mul_ps(_mm256_sub_ps(gather(heightValues, farNorthIndex), value00), northFactor),
+                _mm256_mul_ps(_mm256_sub_ps(gather(heightValues, _mm256_add_epi32(farNorthIndex, one)), value01), northFactor), fractionX, fractionY);
+        _mm256_storeu_ps(heights + i, _mm256_blendv_ps(minusInfinity, height, inside));
+        _mm256_storeu_ps(gradientsX + i, _mm256_and_ps(inside, gradientX));
+        _mm256_storeu_ps(gradientsY + i, _mm256_and_ps(inside, gradientY));
+    }
+
+    //remaining points.
+    sampleSurfaceSse(heightValues, rowCount, columnCount, rowPitch, geometry, xValues + i, yValues + i, heights + i, gradientsX + i, gradientsY + i, count - i);
+}
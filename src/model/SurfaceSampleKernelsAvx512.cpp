@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2018 A.C. Kockx, All Rights Reserved.
+ *
+ * AVX-512 implementations of the kernels in SurfaceSampleKernels.h.
+ * The functions in this file must only be called if the processor supports AVX-512F (see CpuFeatures.h).
+ */
+
+//GCC and Clang only allow AVX-512 intrinsics in code that is compiled for AVX-512. AVX-512F implies FMA,
+//so also disable floating point contraction, since fused multiply-add would change the rounding compared to the scalar reference implementation.
+#if defined(__GNUC__)
+#if !defined(__AVX512F__)
+#pragma GCC target("avx512f")
+#endif
+#if !defined(__clang__)
+#pragma GCC optimize("fp-contract=off")
+#else
+#pragma clang fp contract(off)
+#endif
+#endif
+
+#include "model/SurfaceSampleKernels.h"
+
+#include <math.h>
+#include <immintrin.h>
+
+static inline __m512 interpolate(__m512 value00, __m512 value01, __m512 value10, __m512 value11, __m512 fractionX, __m512 fractionY) {
+    __m512 south = _mm512_add_ps(value00, _mm512_mul_ps(_mm512_sub_ps(value01, value00), fractionX));
+    __m512 north = _mm512_add_ps(value10, _mm512_mul_ps(_mm512_sub_ps(value11, value10), fractionX));
+    return _mm512_add_ps(south, _mm512_mul_ps(_mm512_sub_ps(north, south), fractionY));
+}
+
+static inline __m512 gather(__mmask16 mask, const float* heightValues, __m512i indices) {
+    return _mm512_mask_i32gather_ps(_mm512_setzero_ps(), mask, indices, heightValues, 4);
+}
+
+void sampleSurfaceAvx512(const float* heightValues, int rowCount, int columnCount, int rowPitch, const float* geometry,
+        const float* xValues, const float* yValues, float* heights, float* gradientsX, float* gradientsY, int count) {
+    const __m512 firstColumnX = _mm512_set1_ps(geometry[0]);
+    const __m512 firstRowY = _mm512_set1_ps(geometry[1]);
+    const __m512 inverseDX = _mm512_set1_ps(geometry[2]);
+    const __m512 inverseDY = _mm512_set1_ps(geometry[3]);
+    const __m512 halfInverseDX = _mm512_set1_ps(0.5f * geometry[2]);
+    const __m512 halfInverseDY = _mm512_set1_ps(0.5f * geometry[3]);
+    const __m512 z = _mm512_set1_ps(geometry[4]);
+    const __m512 maxColumn = _mm512_set1_ps((float) (columnCount - 1));
+    const __m512 maxRow = _mm512_set1_ps((float) (rowCount - 1));
+    const __m512 lastCellColumn = _mm512_set1_ps((float) (columnCount - 2));
+    const __m512 lastCellRow = _mm512_set1_ps((float) (rowCount - 2));
+    const __m512 minusInfinity = _mm512_set1_ps(-INFINITY);
+    const __m512 zero = _mm512_setzero_ps();
+    const __m512i zeroInteger = _mm512_setzero_si512();
+    const __m512i one = _mm512_set1_epi32(1);
+    const __m512i lastCellColumnInteger = _mm512_set1_epi32(columnCount - 2);
+    const __m512i lastCellRowInteger = _mm512_set1_epi32(rowCount - 2);
+    const __m512i rowPitchVector = _mm512_set1_epi32(rowPitch);
+
+    //16 points at a time, the remaining points are handled with a masked iteration. Points outside of the surface are clamped to it,
+    //so that all gathers are within the grid, and their results are replaced afterwards.
+    for (int i = 0; i < count; i += 16) {
+        int remainingCount = count - i;
+        __mmask16 mask = remainingCount >= 16 ? (__mmask16) 0xFFFF : (__mmask16) ((1u << remainingCount) - 1);
+
+        __m512 u = _mm512_mul_ps(_mm512_sub_ps(_mm512_maskz_loadu_ps(mask, xValues + i), firstColumnX), inverseDX);
+        __m512 v = _mm512_mul_ps(_mm512_sub_ps(_mm512_maskz_loadu_ps(mask, yValues + i), firstRowY), inverseDY);
+        __mmask16 inside = _mm512_cmp_ps_mask(u, zero, _CMP_GE_OQ) & _mm512_cmp_ps_mask(u, maxColumn, _CMP_LE_OQ)
+                & _mm512_cmp_ps_mask(v, zero, _CMP_GE_OQ) & _mm512_cmp_ps_mask(v, maxRow, _CMP_LE_OQ);
+        u = _mm512_min_ps(_mm512_max_ps(u, zero), maxColumn);//max returns zero if u is not a number.
+        v = _mm512_min_ps(_mm512_max_ps(v, zero), maxRow);
+        __m512i column = _mm512_cvttps_epi32(_mm512_min_ps(u, lastCellColumn));
+        __m512i row = _mm512_cvttps_epi32(_mm512_min_ps(v, lastCellRow));
+        __m512 fractionX = _mm512_sub_ps(u, _mm512_cvtepi32_ps(column));
+        __m512 fractionY = _mm512_sub_ps(v, _mm512_cvtepi32_ps(row));
+
+        //factors of the differences, twice as large at the edges of the grid.
+        __mmask16 westEdge = _mm512_cmpeq_epi32_mask(column, zeroInteger);
+        __mmask16 eastEdge = _mm512_cmpeq_epi32_mask(column, lastCellColumnInteger);
+        __mmask16 southEdge = _mm512_cmpeq_epi32_mask(row, zeroInteger);
+        __mmask16 northEdge = _mm512_cmpeq_epi32_mask(row, lastCellRowInteger);
+        __m512 westFactor = _mm512_mask_blend_ps(westEdge, halfInverseDX, inverseDX);
+        __m512 eastFactor = _mm512_mask_blend_ps(eastEdge, halfInverseDX, inverseDX);
+        __m512 southFactor = _mm512_mask_blend_ps(southEdge, halfInverseDY, inverseDY);
+        __m512 northFactor = _mm512_mask_blend_ps(northEdge, halfInverseDY, inverseDY);
+
+        //indices of the 4 vertices of every cell and offsets of their neighbours, with the same offsets as the scalar implementation.
+        __m512i index = _mm512_add_epi32(_mm512_mullo_epi32(row, rowPitchVector), column);
+        __m512i northIndex = _mm512_add_epi32(index, rowPitchVector);
+        __m512i west = _mm512_mask_blend_epi32(westEdge, _mm512_set1_epi32(-1), zeroInteger);
+        __m512i east = _mm512_mask_blend_epi32(eastEdge, _mm512_set1_epi32(2), one);
+        __m512i south = _mm512_mask_blend_epi32(southEdge, _mm512_set1_epi32(-rowPitch), zeroInteger);
+        __m512i north = _mm512_mask_blend_epi32(northEdge, _mm512_set1_epi32(2 * rowPitch), rowPitchVector);
+
+        __m512 value00 = gather(mask, heightValues, index);
+        __m512 value01 = gather(mask, heightValues, _mm512_add_epi32(index, one));
+        __m512 value10 = gather(mask, heightValues, northIndex);
+        __m512 value11 = gather(mask, heightValues, _mm512_add_epi32(northIndex, one));
+
+        __m512 height = _mm512_add_ps(z, interpolate(value00, value01, value10, value11, fractionX, fractionY));
+        __m512 gradientX = interpolate(_mm512_mul_ps(_mm512_sub_ps(value01, gather(mask, heightValues, _mm512_add_epi32(index, west))), westFactor),
+                _mm512_mul_ps(_mm512_sub_ps(gather(mask, heightValues, _mm512_add_epi32(index, east)), value00), eastFactor),
+                _mm512_mul_ps(_mm512_sub_ps(value11, gather(mask, heightValues, _mm512_add_epi32(northIndex, west))), westFactor),
+                _mm512_mul_ps(_mm512_sub_ps(gather(mask, heightValues, _mm512_add_epi32(northIndex, east)), value10), eastFactor), fractionX, fractionY);
+        __m512i southIndex = _mm512_add_epi32(index, south);
+        __m512i farNorthIndex = _mm512_add_epi32(index, north);
+        __m512 gradientY = interpolate(_mm512_mul_ps(_mm512_sub_ps(value10, gather(mask, heightValues, southIndex)), southFactor),
+                _mm512_mul_ps(_mm512_sub_ps(value11, gather(mask, heightValues, _mm512_add_epi32(southIndex, one))), southFactor),
+                _mm512_mul_ps(_mm512_sub_ps(gather(mask, heightValues, farNorthIndex), value00), northFactor),
+                _mm512_mul_ps(_mm512_sub_ps(gather(mask, heightValues, _mm512_add_epi32(farNorthIndex, one)), value01), northFactor), fractionX, fractionY);
+        _mm512_mask_storeu_ps(heights + i, mask, _mm512_mask_blend_ps(inside, minusInfinity, height));
+        _mm512_mask_storeu_ps(gradientsX + i, mask, _mm512_maskz_mov_ps(inside, gradientX));
+        _mm512_mask_storeu_ps(gradientsY + i, mask, _mm512_maskz_mov_ps(inside, gradientY));
+    }
+}
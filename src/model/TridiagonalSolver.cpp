@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2018 A.C. Kockx, All Rights Reserved.
+ */
+
+#include "model/TridiagonalSolver.h"
+
+void factorTridiagonalMatrix(float a, int length, float* inverseDiagonals, float* upperFactors) {
+    //the off-diagonal elements are all -a. The diagonal elements are 1 + 2 * a, except at the ends, where the reflected neighbour
+    //cancels one of the -a terms. Forward elimination subtracts -a / diagonal[j - 1] times row j - 1 from row j,
+    //which changes diagonal[j] to diagonal[j] - a * a / diagonal[j - 1].
+    for (int j = 0; j < length; j++) {
+        float diagonal = 1 + a * ((j > 0 ? 1 : 0) + (j < length - 1 ? 1 : 0));
+        if (j > 0) {
+            diagonal -= a * upperFactors[j - 1];
+        }
+        inverseDiagonals[j] = 1 / diagonal;
+        //factor for the back substitution, i.e. minus the upper off-diagonal element divided by the diagonal element.
+        upperFactors[j] = a * inverseDiagonals[j];
+    }
+}
+
+void solveTridiagonalLines(float a, const float* inverseDiagonals, const float* upperFactors, float* values, int length, int lineCount, int stride) {
+    //forward elimination.
+    for (int group = 0; group < lineCount; group += TRIDIAGONAL_LINE_GROUP_SIZE) {
+        float* current = values + group;
+        for (int k = 0; k < TRIDIAGONAL_LINE_GROUP_SIZE; k++) {
+            current[k] *= inverseDiagonals[0];
+        }
+    }
+    for (int j = 1; j < length; j++) {
+        float inverseDiagonal = inverseDiagonals[j];
+        for (int group = 0; group < lineCount; group += TRIDIAGONAL_LINE_GROUP_SIZE) {
+            float* current = values + j * stride + group;
+            const float* previous = current - stride;
+            for (int k = 0; k < TRIDIAGONAL_LINE_GROUP_SIZE; k++) {
+                current[k] = (current[k] + a * previous[k]) * inverseDiagonal;
+            }
+        }
+    }
+
+    //back substitution.
+    for (int j = length - 2; j >= 0; j--) {
+        float upperFactor = upperFactors[j];
+        for (int group = 0; group < lineCount; group += TRIDIAGONAL_LINE_GROUP_SIZE) {
+            float* current = values + j * stride + group;
+            const float* next = current + stride;
+            for (int k = 0; k < TRIDIAGONAL_LINE_GROUP_SIZE; k++) {
+                current[k] += upperFactor * next[k];
+            }
+        }
+    }
+}
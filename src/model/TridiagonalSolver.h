@@ -0,0 +1,35 @@
+/*
+ * Copyright (c) 2018 A.C. Kockx, All Rights Reserved.
+ */
+
+#ifndef INCLUDED_TRIDIAGONALSOLVER_H
+#define INCLUDED_TRIDIAGONALSOLVER_H
+
+//number of lines that are solved together by the innermost loops, one cache line of floats.
+static const int TRIDIAGONAL_LINE_GROUP_SIZE = 16;
+
+/**
+ * Functions for solving many independent tridiagonal linear systems (lines) with the same matrix I - a * D at once,
+ * where D is the 1D second-order finite-difference approximation of the second derivative with zero-gradient (reflecting) ends:
+ *
+ * D * v[j] = v[j - 1] + v[j + 1] - 2 * v[j], with v[-1] = v[0] and v[length] = v[length - 1].
+ *
+ * This matrix is symmetric and diagonally dominant for a >= 0, so the Thomas algorithm (Gaussian elimination without pivoting) is stable.
+ * Since all lines have the same matrix, it is factored only once with factorTridiagonalMatrix and then used for all lines.
+ */
+
+/**
+ * Factors the matrix I - a * D for lines with the given length (number of unknowns).
+ * Writes length values to both inverseDiagonals and upperFactors.
+ */
+void factorTridiagonalMatrix(float a, int length, float* inverseDiagonals, float* upperFactors);
+
+/**
+ * Solves (I - a * D) * x = values in place for lineCount lines that are interleaved in memory:
+ * element j of line k is stored at values[j * stride + k]. inverseDiagonals and upperFactors must have been calculated
+ * by factorTridiagonalMatrix with the same a and length. lineCount must be a multiple of TRIDIAGONAL_LINE_GROUP_SIZE.
+ * The innermost loops run over a fixed number of lines, which are contiguous in memory, so that the compiler can vectorize them.
+ */
+void solveTridiagonalLines(float a, const float* inverseDiagonals, const float* upperFactors, float* values, int length, int lineCount, int stride);
+
+#endif
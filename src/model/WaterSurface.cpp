@@ -4,14 +4,54 @@
 
 #include "model/WaterSurface.h"
 
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <thread>
+
 #include "util/ModelUtils.h"
-#include "util/OpenGLUtils.h"
+#include "util/CpuFeatures.h"
+#include "model/TridiagonalSolver.h"
 
 static const float C = 0.5f;//wave speed in m/s.
-static const float D = 0.005f;//diffusion constant in m2/s.
-static const float K = 10.0f;//artificial dissipation constant in s-1.
 
-WaterSurface::WaterSurface(float xSize, float ySize, float x, float y, float z) {
+static const int DEFAULT_TEMPORAL_BLOCK_SIZE = 8;
+//number of bytes that the rows of a tile that are in use during a temporal block should fit in,
+//this is about the size of the per-core level 2 cache of current processors.
+static const int TEMPORAL_BLOCK_CACHE_SIZE = 256 * 1024;
+
+//weight of the next and previous time steps in the spatial terms of the ADI scheme, 1/4 is the smallest weight for which
+//the scheme is stable for any time step. The current time step has weight 1 - 2 * ADI_THETA.
+static const float ADI_THETA = 0.25f;
+//number of columns that are solved together in the sweep along columns, a multiple of TRIDIAGONAL_LINE_GROUP_SIZE.
+static const int ADI_COLUMN_BLOCK_SIZE = 4 * TRIDIAGONAL_LINE_GROUP_SIZE;
+
+//number of columns that are gathered into contiguous lines together for the spectral transforms along columns, one cache line of floats.
+static const int SPECTRAL_COLUMN_GROUP_SIZE = CACHE_LINE_SIZE / sizeof(float);
+
+//number of interior rows and columns per tile for tracking active tiles.
+static const int ACTIVE_TILE_SIZE = 32;
+//number of time steps between updates of the active tiles. Waves travel at most one vertex per time step,
+//so between two updates they cannot travel further than half a tile.
+static const int ACTIVE_TILE_UPDATE_INTERVAL = ACTIVE_TILE_SIZE / 2;
+
+//number of points per chunk of sampleSurface, a multiple of the vector width of all kernels.
+static const int SAMPLE_CHUNK_SIZE = 256;
+
+const float WaterSurface::ACTIVE_TILE_EPSILON = 1e-6f;
+
+WaterSurface::WaterSurface(int rowCount, int columnCount, float xSize, float ySize, float x, float y, float z, ThreadPool* threadPool) {
+    this->rowCount = rowCount;
+    this->columnCount = columnCount;
+    //round row length up to a whole number of cache lines.
+    const int floatsPerCacheLine = CACHE_LINE_SIZE / sizeof(float);
+    rowPitch = (columnCount + floatsPerCacheLine - 1) / floatsPerCacheLine * floatsPerCacheLine;
+    //avoid row lengths that are a multiple of 4 kB, otherwise the rows that are used together in the finite-difference
+    //approximations map to the same cache sets and evict each other (4k aliasing).
+    if ((rowPitch * sizeof(float)) % 4096 == 0) {
+        rowPitch += floatsPerCacheLine;
+    }
     this->xSize = xSize;
     this->ySize = ySize;
     dX = xSize / (columnCount - 1);
@@ -20,294 +60,1189 @@ WaterSurface::WaterSurface(float xSize, float ySize, float x, float y, float z)
     this->y = y;
     this->z = z;
 
-    //create geometry.
-    vector<float> vertices = vector<float>(vertexCount * dimensionCount);//vertex coordinates (x, y, z) in model space.
-    vector<float> normals = vector<float>(vertexCount * dimensionCount);//vertex normal vectors (x, y, z) in model space.
-    vector<float> colors(vertexCount * dimensionCount);//vertex colors (r, g, b).
-    createHorizontal2DGrid(rowCount, columnCount, xSize, ySize, waterColor, vertices, normals, colors);
-    surfaceHeightValues = vector<float>(vertexCount);//vertex z displacements relative to the vertex coordinates in model space.
-    previousSurfaceHeightValues = vector<float>(vertexCount);//vertex z displacements for previous time step.
-    //initialize surface heights with zero values.
-    for (int vertexIndex = 0; vertexIndex < vertexCount; vertexIndex++) {
-        surfaceHeightValues[vertexIndex] = 0;
-        previousSurfaceHeightValues[vertexIndex] = 0;
-    }
-
-    //create vertex array object.
-    glGenVertexArrays(1, &vertexArrayObjectId);
-    glBindVertexArray(vertexArrayObjectId);
-    createVertexBufferObject(0, vertexCount, dimensionCount, &vertices[0], GL_STATIC_DRAW);
-    normalsVertexBufferObjectId = createVertexBufferObject(1, vertexCount, dimensionCount, &normals[0], GL_STREAM_DRAW);
-    createVertexBufferObject(2, vertexCount, dimensionCount, &colors[0], GL_STATIC_DRAW);
-    zDisplacementVertexBufferObjectId = createVertexBufferObject(3, vertexCount, 1, &surfaceHeightValues[0], GL_STREAM_DRAW);
-
-    //create index buffer object.
-    indexCount = (rowCount - 1) * (columnCount - 1) * 2 * 3;
-    int index = 0;
-    vector<unsigned int> indices(indexCount);
-    for (int row = 0; row < rowCount - 1; row++) {
-        for (int column = 0; column < columnCount - 1; column++) {
-            int lowerLeftIndex = row * columnCount + column;
-            int lowerRightIndex = lowerLeftIndex + 1;
-            int upperLeftIndex = lowerLeftIndex + columnCount;
-            int upperRightIndex = upperLeftIndex + 1;
-
-            //triangle one.
-            indices[index++] = lowerLeftIndex;
-            indices[index++] = lowerRightIndex;
-            indices[index++] = upperLeftIndex;
-
-            //triangle two.
-            indices[index++] = upperLeftIndex;
-            indices[index++] = lowerRightIndex;
-            indices[index++] = upperRightIndex;
+    //initialize surface heights (including padding) with zero values.
+    surfaceHeightValues.assign(rowCount * rowPitch, 0.0f);
+    previousSurfaceHeightValues.assign(rowCount * rowPitch, 0.0f);
+    normalVectors.assign(3 * rowCount * rowPitch, 0.0f);
+    surfaceGradientXValues.assign(rowCount * rowPitch, 0.0f);
+    surfaceGradientYValues.assign(rowCount * rowPitch, 0.0f);
+
+    //use the fastest solver kernels that this processor supports.
+    this->threadPool = threadPool;
+    solverType = EXPLICIT_SOLVER_TYPE;
+    adiDeltaT = 0;
+    rowCosineTransform = NULL;
+    columnCosineTransform = NULL;
+    spectralDeltaT = 0;
+    spectralModesUpToDate = false;
+    instructionSet = getBestSupportedInstructionSet();
+    waveEquationRowKernel = getWaveEquationRowKernel(instructionSet);
+    surfaceNormalRowKernel = getSurfaceNormalRowKernel(instructionSet);
+    gaussianRowKernel = getGaussianRowKernel(instructionSet);
+    surfaceSampleKernel = getSurfaceSampleKernel(instructionSet);
+    temporalBlockSize = DEFAULT_TEMPORAL_BLOCK_SIZE;
+
+    //all tiles start as active and changed, so that the first time step flattens the ones that are not disturbed
+    //and all normal vectors are calculated once.
+    tileRowCount = (rowCount - 2 + ACTIVE_TILE_SIZE - 1) / ACTIVE_TILE_SIZE;
+    tileColumnCount = (columnCount - 2 + ACTIVE_TILE_SIZE - 1) / ACTIVE_TILE_SIZE;
+    activeTiles.assign(tileRowCount * tileColumnCount, 0);
+    tileQuadrantMaxima.assign(4 * tileRowCount * tileColumnCount, 0.0f);
+    normalTiles.assign(tileRowCount * tileColumnCount, 0);
+    surfaceVersion = 0;
+    tileVersions.assign(tileRowCount * tileColumnCount, 0);
+    normalVectorsVersion = 0;
+    surfaceGradientsVersion = 0;
+    activeTilesEnabled = true;
+    activeTileUpdateCount = 0;
+    markAllTilesActive();
+
+    normalVectorsEnabled = true;
+    updateNormalVectors();
+}
+
+WaterSurface::~WaterSurface() {
+    delete rowCosineTransform;
+    delete columnCosineTransform;
+}
+
+void WaterSurface::calculateNormalVectors(const float* heightValues, float* normals, int row, int beginColumn, int endColumn) {
+    //calculate gradients and normals for the given columns of the given row using the given surface heights. This uses central difference approximations
+    //(second-order accurate) for the interior vertices and forward or backward difference approximations (first-order accurate) at the edges.
+    int i = row * rowPitch;
+    const float* values = &heightValues[i];
+    const float* south = row == 0 ? values : values - rowPitch;
+    const float* north = row == rowCount - 1 ? values : values + rowPitch;
+    float yScale = (row == 0 || row == rowCount - 1) ? 1 / dY : 1 / (2 * dY);
+    normals += 3 * i;
+    float* gradientsX = &surfaceGradientXValues[i];
+    float* gradientsY = &surfaceGradientYValues[i];
+
+    //interior vertices.
+    int beginInteriorColumn = std::max(1, beginColumn);
+    int endInteriorColumn = std::min(columnCount - 1, endColumn);
+    if (endInteriorColumn > beginInteriorColumn) {
+        int column = beginInteriorColumn;
+        surfaceNormalRowKernel(values + column - 1, values + column + 1, south + column, north + column, normals + 3 * column,
+                gradientsX + column, gradientsY + column, endInteriorColumn - beginInteriorColumn, 1 / (2 * dX), yScale);
+    }
+    //western edge.
+    if (beginColumn == 0) {
+        surfaceNormalRowKernel(values, values + 1, south, north, normals, gradientsX, gradientsY, 1, 1 / dX, yScale);
+    }
+    //eastern edge.
+    if (endColumn == columnCount) {
+        int column = columnCount - 1;
+        surfaceNormalRowKernel(values + column - 1, values + column, south + column, north + column,
+                normals + 3 * column, gradientsX + column, gradientsY + column, 1, 1 / dX, yScale);
+    }
+}
+
+void WaterSurface::calculateChangedNormalVectors(const float* heightValues, int row) {
+    //calculate the normal vectors of the given row for the runs of adjacent tiles that are marked by markNormalTiles.
+    const unsigned char* tiles = &normalTiles[getTileRow(row) * tileColumnCount];
+    for (int tileColumn = 0; tileColumn < tileColumnCount;) {
+        if (!tiles[tileColumn]) {
+            tileColumn++;
+            continue;
+        }
+        int endTileColumn = tileColumn + 1;
+        while (endTileColumn < tileColumnCount && tiles[endTileColumn]) {
+            endTileColumn++;
         }
+        calculateNormalVectors(heightValues, &normalVectors[0], row, getTileBeginColumn(tileColumn), getTileBeginColumn(endTileColumn));
+        tileColumn = endTileColumn;
     }
-    indexBufferObjectId = createIndexBufferObject(indexCount, &indices[0]);
+}
 
-    //init model matrix.
-    modelMatrix = createModelMatrix(x, y, z, 0, 0, 0, 1, 1, 1);
+void WaterSurface::markNormalTiles() {
+    //the normal vectors of a vertex depend on the surface heights of its four neighbours, which are in the same tile or in one of the four adjacent tiles.
+    //So the normal vectors of a tile only need to be recalculated if the surface heights of the tile or an adjacent tile changed since the last calculation.
+    for (int tileRow = 0; tileRow < tileRowCount; tileRow++) {
+        for (int tileColumn = 0; tileColumn < tileColumnCount; tileColumn++) {
+            int tile = tileRow * tileColumnCount + tileColumn;
+            bool changed = tileVersions[tile] > normalVectorsVersion;
+            changed |= tileColumn > 0 && tileVersions[tile - 1] > normalVectorsVersion;
+            changed |= tileColumn < tileColumnCount - 1 && tileVersions[tile + 1] > normalVectorsVersion;
+            changed |= tileRow > 0 && tileVersions[tile - tileColumnCount] > normalVectorsVersion;
+            changed |= tileRow < tileRowCount - 1 && tileVersions[tile + tileColumnCount] > normalVectorsVersion;
+            normalTiles[tile] = changed ? 1 : 0;
+        }
+    }
 }
 
-void WaterSurface::updateZDisplacements() {
-    //update z displacements in graphics card memory.
-    glBindVertexArray(vertexArrayObjectId);
-    glBindBuffer(GL_ARRAY_BUFFER, zDisplacementVertexBufferObjectId);
-    int floatCount = vertexCount;
-    glBufferSubData(GL_ARRAY_BUFFER, 0, floatCount * sizeof(float), &surfaceHeightValues[0]);
+void WaterSurface::calculateNormalVectors(float* normals) {
+    applyQueuedGaussians();
+    //calculate normals using current surfaceHeightValues, in parallel for bands of rows.
+    const float* heightValues = &surfaceHeightValues[0];
+    threadPool->parallelFor(0, rowCount, [&](int beginRow, int endRow) {
+        for (int row = beginRow; row < endRow; row++) {
+            calculateNormalVectors(heightValues, normals, row, 0, columnCount);
+        }
+    });
+    surfaceGradientsVersion = surfaceVersion;
 }
 
 void WaterSurface::updateNormalVectors() {
-    vector<float> normals = vector<float>(vertexCount * dimensionCount);//vertex normal vectors (x, y, z) in model space.
+    //only recalculate the normal vectors of the tiles whose surface heights (or those of an adjacent tile) changed.
+    markNormalTiles();
+    const float* heightValues = &surfaceHeightValues[0];
+    threadPool->parallelFor(0, rowCount, [&](int beginRow, int endRow) {
+        for (int row = beginRow; row < endRow; row++) {
+            calculateChangedNormalVectors(heightValues, row);
+        }
+    });
+    normalVectorsVersion = surfaceVersion;
+    surfaceGradientsVersion = surfaceVersion;
+}
+
+const float* WaterSurface::getNormalVectors() {
+    applyQueuedGaussians();
+    if (normalVectorsVersion != surfaceVersion) {
+        updateNormalVectors();
+    }
+    return &normalVectors[0];
+}
+
+vec2 WaterSurface::getSurfaceGradient(int vertexIndex) {
+    applyQueuedGaussians();
+    //this code assumes that this surface's model space axes have the same orientation as the corresponding world space axes.
+    if (surfaceGradientsVersion == surfaceVersion) {
+        return vec2(surfaceGradientXValues[vertexIndex], surfaceGradientYValues[vertexIndex]);
+    }
+
+    //calculate the gradient at the given vertex only, in the same way as calculateNormalVectors.
+    int row = vertexIndex / rowPitch;
+    int column = vertexIndex % rowPitch;
+    const float* value = &surfaceHeightValues[vertexIndex];
+    bool isColumnEdge = column == 0 || column == columnCount - 1;
+    bool isRowEdge = row == 0 || row == rowCount - 1;
+    const float* west = column == 0 ? value : value - 1;
+    const float* east = column == columnCount - 1 ? value : value + 1;
+    const float* south = row == 0 ? value : value - rowPitch;
+    const float* north = row == rowCount - 1 ? value : value + rowPitch;
+    float normal[3];
+    vec2 gradient;
+    calculateSurfaceNormalRowScalar(west, east, south, north, normal, &gradient[0], &gradient[1], 1,
+            isColumnEdge ? 1 / dX : 1 / (2 * dX), isRowEdge ? 1 / dY : 1 / (2 * dY));
+    return gradient;
+}
+
+void WaterSurface::sampleSurface(const float* xValues, const float* yValues, int count, float* heights, float* gradientsX, float* gradientsY) {
+    applyQueuedGaussians();
+    //this code assumes that this surface's model space axes have the same orientation as the corresponding world space axes.
+    const float geometry[5] = {x - 0.5f * xSize, y - 0.5f * ySize, 1 / dX, 1 / dY, z};
+    const float* heightValues = &surfaceHeightValues[0];
 
-    //calculate normals using current surfaceHeightValues.
-    int normalIndex = 0;
-    for (int row = 0; row < rowCount; row++) {
-        for (int column = 0; column < columnCount; column++) {
-            //determine tangent vector to the surface in x direction.
-            vec3 tangentInXDirection = vec3(1, 0, firstDerivativeX(row, column));
+    //in parallel for chunks of points, so that a few points are sampled on the calling thread only.
+    int chunkCount = (count + SAMPLE_CHUNK_SIZE - 1) / SAMPLE_CHUNK_SIZE;
+    threadPool->parallelFor(0, chunkCount, [&](int beginChunk, int endChunk) {
+        int begin = beginChunk * SAMPLE_CHUNK_SIZE;
+        int end = std::min(count, endChunk * SAMPLE_CHUNK_SIZE);
+        surfaceSampleKernel(heightValues, rowCount, columnCount, rowPitch, geometry, xValues + begin, yValues + begin,
+                heights + begin, gradientsX + begin, gradientsY + begin, end - begin);
+    });
+}
 
-            //determine tangent vector to the surface in y direction.
-            vec3 tangentInYDirection = vec3(0, 1, firstDerivativeY(row, column));
+float WaterSurface::getXSize() {
+    return xSize;
+}
 
-            //surface normal vector = cross product of two tangent vectors.
-            vec3 normal = normalize(cross(tangentInXDirection, tangentInYDirection));
+float WaterSurface::getYSize() {
+    return ySize;
+}
+
+float WaterSurface::getX() {
+    return x;
+}
+
+float WaterSurface::getY() {
+    return y;
+}
+
+float WaterSurface::getZ() {
+    return z;
+}
 
-            normals[normalIndex++] = normal[0];
-            normals[normalIndex++] = normal[1];
-            normals[normalIndex++] = normal[2];
+int WaterSurface::getRowCount() {
+    return rowCount;
+}
+
+int WaterSurface::getColumnCount() {
+    return columnCount;
+}
+
+int WaterSurface::getRowPitch() {
+    return rowPitch;
+}
+
+int WaterSurface::getSolverType() {
+    return solverType;
+}
+
+int WaterSurface::getInstructionSet() {
+    return instructionSet;
+}
+
+int WaterSurface::getTemporalBlockSize() {
+    return temporalBlockSize;
+}
+
+bool WaterSurface::isNormalVectorsEnabled() {
+    return normalVectorsEnabled;
+}
+
+bool WaterSurface::isActiveTilesEnabled() {
+    return activeTilesEnabled;
+}
+
+int WaterSurface::getActiveTileCount() {
+    int activeTileCount = 0;
+    for (int tile = 0; tile < activeTiles.size(); tile++) {
+        activeTileCount += activeTiles[tile];
+    }
+    return activeTileCount;
+}
+
+int WaterSurface::getActiveTileUpdateCount() {
+    return activeTileUpdateCount;
+}
+
+int WaterSurface::getTileRowCount() {
+    return tileRowCount;
+}
+
+int WaterSurface::getTileColumnCount() {
+    return tileColumnCount;
+}
+
+int WaterSurface::getTileBeginRow(int tileRow) {
+    //the southern edge belongs to the first tile row and the northern edge to the last tile row.
+    if (tileRow <= 0) {
+        return 0;
+    }
+    if (tileRow >= tileRowCount) {
+        return rowCount;
+    }
+    return 1 + tileRow * ACTIVE_TILE_SIZE;
+}
+
+int WaterSurface::getTileBeginColumn(int tileColumn) {
+    //the western edge belongs to the first tile column and the eastern edge to the last tile column.
+    if (tileColumn <= 0) {
+        return 0;
+    }
+    if (tileColumn >= tileColumnCount) {
+        return columnCount;
+    }
+    return 1 + tileColumn * ACTIVE_TILE_SIZE;
+}
+
+unsigned int WaterSurface::getSurfaceVersion() {
+    applyQueuedGaussians();
+    return surfaceVersion;
+}
+
+const unsigned int* WaterSurface::getTileVersions() {
+    applyQueuedGaussians();
+    return &tileVersions[0];
+}
+
+void WaterSurface::getChangedColumnRange(const unsigned int* tileVersions, unsigned int sinceVersion, int tileRow, bool normalVectors, int& beginColumn, int& endColumn) {
+    int beginTileColumn = tileColumnCount;
+    int endTileColumn = 0;
+    for (int tileColumn = 0; tileColumn < tileColumnCount; tileColumn++) {
+        int tile = tileRow * tileColumnCount + tileColumn;
+        bool changed = tileVersions[tile] > sinceVersion;
+        if (normalVectors) {
+            //the normal vectors also change if the surface heights of an adjacent tile change, see markNormalTiles.
+            changed |= tileColumn > 0 && tileVersions[tile - 1] > sinceVersion;
+            changed |= tileColumn < tileColumnCount - 1 && tileVersions[tile + 1] > sinceVersion;
+            changed |= tileRow > 0 && tileVersions[tile - tileColumnCount] > sinceVersion;
+            changed |= tileRow < tileRowCount - 1 && tileVersions[tile + tileColumnCount] > sinceVersion;
+        }
+        if (changed) {
+            beginTileColumn = std::min(beginTileColumn, tileColumn);
+            endTileColumn = tileColumn + 1;
+        }
+    }
+    if (endTileColumn <= beginTileColumn) {
+        beginColumn = 0;
+        endColumn = 0;
+        return;
+    }
+    beginColumn = getTileBeginColumn(beginTileColumn);
+    endColumn = getTileBeginColumn(endTileColumn);
+}
+
+void WaterSurface::copyChangedVertices(const unsigned int* tileVersions, unsigned int sinceVersion, bool normalVectors, const float* source, float* destination) {
+    int valuesPerVertex = normalVectors ? 3 : 1;
+    for (int tileRow = 0; tileRow < tileRowCount; tileRow++) {
+        int beginColumn, endColumn;
+        getChangedColumnRange(tileVersions, sinceVersion, tileRow, normalVectors, beginColumn, endColumn);
+        for (int row = getTileBeginRow(tileRow); row < getTileBeginRow(tileRow + 1) && endColumn > beginColumn; row++) {
+            int i = valuesPerVertex * (row * rowPitch + beginColumn);
+            memcpy(&destination[i], &source[i], valuesPerVertex * (endColumn - beginColumn) * sizeof(float));
         }
     }
+}
 
-    //update normals in graphics card memory.
-    glBindVertexArray(vertexArrayObjectId);
-    glBindBuffer(GL_ARRAY_BUFFER, normalsVertexBufferObjectId);
-    int floatCount = vertexCount * dimensionCount;
-    glBufferSubData(GL_ARRAY_BUFFER, 0, floatCount * sizeof(float), &normals[0]);
+float WaterSurface::getMaxStableDeltaT() {
+    if (solverType != EXPLICIT_SOLVER_TYPE) {
+        return INFINITY;
+    }
+    return 1 / (C * sqrt(1 / (dX * dX) + 1 / (dY * dY)));
 }
 
-void WaterSurface::draw(mat4 viewMatrix, mat4 projectionMatrix, float lightPositionInWorldSpace[], float lightIntensity[], float ambientLightIntensity[]) {
-    updateZDisplacements();
-    updateNormalVectors();
+float WaterSurface::getCourantNumber(float deltaT) {
+    return C * deltaT * sqrt(1 / (dX * dX) + 1 / (dY * dY));
+}
 
-    //prepare shader.
-    shader.setLight(lightPositionInWorldSpace, lightIntensity, ambientLightIntensity, viewMatrix);
-    mat4 modelViewMatrix = viewMatrix * modelMatrix;
-    mat4 modelViewProjectionMatrix = projectionMatrix * modelViewMatrix;
-    shader.use(modelViewMatrix, modelViewProjectionMatrix);
+void WaterSurface::setSolverType(int solverType) {
+    if (solverType != EXPLICIT_SOLVER_TYPE && solverType != ADI_SOLVER_TYPE && solverType != SPECTRAL_SOLVER_TYPE) {
+        fprintf(stderr, "Unknown solver type: %i\n", solverType);
+        exit(-1);
+    }
 
-    //draw triangles.
-    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-    glDisable(GL_CULL_FACE);
-    glBindVertexArray(vertexArrayObjectId);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBufferObjectId);
-    //note that this uses indexCount, not triangleCount.
-    glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0);
+    this->solverType = solverType;
+    if (solverType == ADI_SOLVER_TYPE && adiIntermediateValues.empty()) {
+        //the buffers for the implicit solver are only allocated when it is used.
+        adiInverseDiagonalsX.resize(columnCount - 2);
+        adiUpperFactorsX.resize(columnCount - 2);
+        adiInverseDiagonalsY.resize(rowCount - 2);
+        adiUpperFactorsY.resize(rowCount - 2);
+        adiIntermediateValues.assign(rowCount * rowPitch, 0.0f);
+        adiLineValues.assign(threadPool->getThreadCount() * TRIDIAGONAL_LINE_GROUP_SIZE * (columnCount - 2), 0.0f);
+        adiDeltaT = 0;
+    }
+    if (solverType == SPECTRAL_SOLVER_TYPE && rowCosineTransform == NULL) {
+        //the transforms and buffers for the spectral solver are only created when it is used.
+        rowCosineTransform = new CosineTransform(columnCount - 2);
+        columnCosineTransform = new CosineTransform(rowCount - 2);
+        spectralPropagationFactors.assign((rowCount - 2) * rowPitch, 0.0f);
+        spectralModeValues.assign((rowCount - 2) * rowPitch, 0.0f);
+        spectralModeDifferences.assign((rowCount - 2) * rowPitch, 0.0f);
+        int scratchSize = SPECTRAL_COLUMN_GROUP_SIZE * (rowCount - 2) + std::max(rowCosineTransform->getScratchSize(), columnCosineTransform->getScratchSize());
+        //round up to a whole number of cache lines, so that the threads do not write to the same cache lines.
+        const int floatsPerCacheLine = CACHE_LINE_SIZE / sizeof(float);
+        scratchSize = (scratchSize + floatsPerCacheLine - 1) / floatsPerCacheLine * floatsPerCacheLine;
+        spectralScratchValues.assign(threadPool->getThreadCount() * scratchSize, 0.0f);
+        spectralDeltaT = 0;
+    }
+    //the mode amplitudes are not updated by the other solvers.
+    spectralModesUpToDate = false;
+    //only the explicit solver skips inactive tiles, the other solvers change the surface heights everywhere.
+    markAllTilesActive();
 }
 
-int WaterSurface::getIndexOfClosestVertex(float x, float y) {
-    //convert x,y to model space.
-    //this code assumes that this surface's model space axes have the same orientation as the corresponding world space axes.
-    x -= this->x;
-    y -= this->y;
-    if (x < -0.5f * xSize || x > 0.5f * xSize || y < -0.5f * ySize || y > 0.5f * ySize) {//if outside of surface.
-        return -1;
+bool WaterSurface::setInstructionSet(int instructionSet) {
+    if (!isInstructionSetSupported(instructionSet)) {
+        return false;
+    }
+
+    this->instructionSet = instructionSet;
+    waveEquationRowKernel = getWaveEquationRowKernel(instructionSet);
+    surfaceNormalRowKernel = getSurfaceNormalRowKernel(instructionSet);
+    gaussianRowKernel = getGaussianRowKernel(instructionSet);
+    surfaceSampleKernel = getSurfaceSampleKernel(instructionSet);
+    return true;
+}
+
+void WaterSurface::setTemporalBlockSize(int temporalBlockSize) {
+    this->temporalBlockSize = std::max(1, temporalBlockSize);
+}
+
+void WaterSurface::setNormalVectorsEnabled(bool normalVectorsEnabled) {
+    this->normalVectorsEnabled = normalVectorsEnabled;
+}
+
+void WaterSurface::setActiveTilesEnabled(bool activeTilesEnabled) {
+    this->activeTilesEnabled = activeTilesEnabled;
+    markAllTilesActive();
+}
+
+void WaterSurface::markActiveTilesChanged() {
+    surfaceVersion++;
+    for (int tile = 0; tile < activeTiles.size(); tile++) {
+        if (activeTiles[tile]) {
+            tileVersions[tile] = surfaceVersion;
+        }
     }
+}
+
+void WaterSurface::markAllTilesActive() {
+    //all tiles may have changed, so make them all active and changed until the next update of the active tiles, which happens before the next time step.
+    activeTiles.assign(activeTiles.size(), 1);
+    markActiveTilesChanged();
+    updateActiveColumnRanges();
+    stepsSinceActiveTileUpdate = ACTIVE_TILE_UPDATE_INTERVAL;
+}
+
+void WaterSurface::updateActiveTiles() {
+    //find the largest absolute surface height (in both time steps) in every quadrant of every active tile, in parallel for bands of tile rows.
+    //Active tiles in which all surface heights are at most ACTIVE_TILE_EPSILON are flattened.
+    unsigned int flattenedVersion = surfaceVersion + 1;
+    threadPool->parallelFor(0, tileRowCount, [&](int beginTileRow, int endTileRow) {
+        for (int tileRow = beginTileRow; tileRow < endTileRow; tileRow++) {
+            int beginRow = getTileBeginRow(tileRow);
+            int endRow = getTileBeginRow(tileRow + 1);
+            int middleRow = std::min(endRow, 1 + tileRow * ACTIVE_TILE_SIZE + ACTIVE_TILE_SIZE / 2);
+            for (int tileColumn = 0; tileColumn < tileColumnCount; tileColumn++) {
+                int tile = tileRow * tileColumnCount + tileColumn;
+                float* maxima = &tileQuadrantMaxima[4 * tile];
+                maxima[0] = maxima[1] = maxima[2] = maxima[3] = 0;
+                if (!activeTiles[tile]) {
+                    continue;
+                }
 
-    //find nearest row and column.
-    int row = (int) round((y / ySize + 0.5f) * (rowCount - 1));
-    int column = (int) round((x / xSize + 0.5f) * (columnCount - 1));
+                int beginColumn = getTileBeginColumn(tileColumn);
+                int endColumn = getTileBeginColumn(tileColumn + 1);
+                int middleColumn = std::min(endColumn, 1 + tileColumn * ACTIVE_TILE_SIZE + ACTIVE_TILE_SIZE / 2);
+                for (int row = beginRow; row < endRow; row++) {
+                    const float* values = &surfaceHeightValues[row * rowPitch];
+                    const float* previousValues = &previousSurfaceHeightValues[row * rowPitch];
+                    float* rowMaxima = row < middleRow ? &maxima[0] : &maxima[2];
+                    //it only matters whether a quadrant has a surface height larger than ACTIVE_TILE_EPSILON, so the rest of a quadrant
+                    //is skipped as soon as one is found. Then only quiet tiles are read completely.
+                    if (rowMaxima[0] <= ACTIVE_TILE_EPSILON) {
+                        float maximum = rowMaxima[0];
+                        for (int column = beginColumn; column < middleColumn; column++) {
+                            maximum = std::max(maximum, std::max(fabsf(values[column]), fabsf(previousValues[column])));
+                        }
+                        rowMaxima[0] = maximum;
+                    }
+                    if (rowMaxima[1] <= ACTIVE_TILE_EPSILON) {
+                        float maximum = rowMaxima[1];
+                        for (int column = middleColumn; column < endColumn; column++) {
+                            maximum = std::max(maximum, std::max(fabsf(values[column]), fabsf(previousValues[column])));
+                        }
+                        rowMaxima[1] = maximum;
+                    }
+                }
 
-    //determine corresponding vertexIndex.
-    return row * columnCount + column;
+                float tileMaximum = std::max(std::max(maxima[0], maxima[1]), std::max(maxima[2], maxima[3]));
+                if (tileMaximum <= ACTIVE_TILE_EPSILON && tileMaximum > 0) {
+                    for (int row = beginRow; row < endRow; row++) {
+                        memset(&surfaceHeightValues[row * rowPitch + beginColumn], 0, (endColumn - beginColumn) * sizeof(float));
+                        memset(&previousSurfaceHeightValues[row * rowPitch + beginColumn], 0, (endColumn - beginColumn) * sizeof(float));
+                    }
+                    tileVersions[tile] = flattenedVersion;
+                }
+            }
+        }
+    });
+    surfaceVersion = flattenedVersion;
+
+    //a tile stays active if it has a quadrant with surface heights larger than ACTIVE_TILE_EPSILON. Such a quadrant also activates the three
+    //neighbouring tiles that it faces, since the waves in it can reach those tiles before the next update, but not the tiles on the other side.
+    activeTiles.assign(activeTiles.size(), 0);
+    for (int tileRow = 0; tileRow < tileRowCount; tileRow++) {
+        for (int tileColumn = 0; tileColumn < tileColumnCount; tileColumn++) {
+            const float* maxima = &tileQuadrantMaxima[4 * (tileRow * tileColumnCount + tileColumn)];
+            for (int quadrant = 0; quadrant < 4; quadrant++) {
+                if (maxima[quadrant] <= ACTIVE_TILE_EPSILON) {
+                    continue;
+                }
+                //quadrants 0 and 1 face south, quadrants 0 and 2 face west.
+                int neighbourTileRow = quadrant < 2 ? tileRow - 1 : tileRow + 1;
+                int neighbourTileColumn = quadrant % 2 == 0 ? tileColumn - 1 : tileColumn + 1;
+                int rows[2] = {tileRow, neighbourTileRow};
+                int columns[2] = {tileColumn, neighbourTileColumn};
+                for (int r = 0; r < 2; r++) {
+                    for (int c = 0; c < 2; c++) {
+                        if (rows[r] >= 0 && rows[r] < tileRowCount && columns[c] >= 0 && columns[c] < tileColumnCount) {
+                            activeTiles[rows[r] * tileColumnCount + columns[c]] = 1;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    updateActiveColumnRanges();
+    stepsSinceActiveTileUpdate = 0;
+    activeTileUpdateCount++;
 }
 
-float WaterSurface::getSurfaceHeight(int vertexIndex) {
-    //convert surface height to world space.
-    //this code assumes that this surface's model space axes have the same orientation as the corresponding world space axes.
-    return z + surfaceHeightValues[vertexIndex];
+void WaterSurface::updateActiveColumnRanges() {
+    activeColumnRanges.clear();
+    activeColumnRangeOffsets.resize(tileRowCount + 1);
+    for (int tileRow = 0; tileRow < tileRowCount; tileRow++) {
+        activeColumnRangeOffsets[tileRow] = (int) activeColumnRanges.size();
+        const unsigned char* tiles = &activeTiles[tileRow * tileColumnCount];
+        for (int tileColumn = 0; tileColumn < tileColumnCount;) {
+            if (!tiles[tileColumn]) {
+                tileColumn++;
+                continue;
+            }
+            int endTileColumn = tileColumn + 1;
+            while (endTileColumn < tileColumnCount && tiles[endTileColumn]) {
+                endTileColumn++;
+            }
+            //interior columns only, the solver sets the edges separately.
+            activeColumnRanges.push_back(1 + tileColumn * ACTIVE_TILE_SIZE);
+            activeColumnRanges.push_back(std::min(columnCount - 1, 1 + endTileColumn * ACTIVE_TILE_SIZE));
+            tileColumn = endTileColumn;
+        }
+    }
+    activeColumnRangeOffsets[tileRowCount] = (int) activeColumnRanges.size();
 }
 
-vec2 WaterSurface::getSurfaceGradient(int vertexIndex) {
-    int row = vertexIndex / columnCount;
-    int column = vertexIndex % columnCount;
-    //this code assumes that this surface's model space axes have the same orientation as the corresponding world space axes.
-    return vec2(firstDerivativeX(row, column), firstDerivativeY(row, column));
+int WaterSurface::getTileRow(int row) {
+    //the edge rows belong to the adjacent tiles.
+    return row == 0 ? 0 : std::min(tileRowCount - 1, (row - 1) / ACTIVE_TILE_SIZE);
 }
 
-float WaterSurface::getXSize() {
-    return xSize;
+int WaterSurface::getTileColumn(int column) {
+    return column == 0 ? 0 : std::min(tileColumnCount - 1, (column - 1) / ACTIVE_TILE_SIZE);
 }
 
-float WaterSurface::getYSize() {
-    return ySize;
+const float* WaterSurface::getSurfaceHeightValues() {
+    applyQueuedGaussians();
+    return &surfaceHeightValues[0];
 }
 
 void WaterSurface::addGaussian(float alpha, float xCenter, float yCenter, float sigmaX, float sigmaY) {
-    //add a gaussian function with the given parameters to surfaceHeightValues.
-    float y = -0.5f * ySize;
-    int vertexIndex = 0;
-    for (int row = 0; row < rowCount; row++) {
-        float x = -0.5f * xSize;
-
-        for (int column = 0; column < columnCount; column++) {
-            float value = gaussian(x, y, alpha, xCenter, yCenter, sigmaX, sigmaY);
-            surfaceHeightValues[vertexIndex] += value;
-            //add the same values to previousSurfaceHeightValues for numerical consistency in the simulation.
-            //Otherwise the temporal terms in the finite-difference approximation will be messed up.
-            previousSurfaceHeightValues[vertexIndex] += value;
-            vertexIndex++;
-
-            x += dX;
-        }
+    //the gaussian function is at most ACTIVE_TILE_EPSILON beyond sqrt(2 * ln(|alpha| / ACTIVE_TILE_EPSILON)) sigma from its center in x or y direction,
+    //so it is truncated there, which leaves the surface heights of the inactive tiles zero.
+    if (fabsf(alpha) <= ACTIVE_TILE_EPSILON) {
+        return;
+    }
+    float radius = sqrtf(2 * logf(fabsf(alpha) / ACTIVE_TILE_EPSILON));
+    int beginRow = (int) std::max(0.0f, std::min((float) rowCount, ceilf((yCenter - radius * sigmaY + 0.5f * ySize) / dY)));
+    int endRow = (int) std::max(0.0f, std::min((float) rowCount, floorf((yCenter + radius * sigmaY + 0.5f * ySize) / dY) + 1));
+    int beginColumn = (int) std::max(0.0f, std::min((float) columnCount, ceilf((xCenter - radius * sigmaX + 0.5f * xSize) / dX)));
+    int endColumn = (int) std::max(0.0f, std::min((float) columnCount, floorf((xCenter + radius * sigmaX + 0.5f * xSize) / dX) + 1));
+    if (beginRow >= endRow || beginColumn >= endColumn) {//if outside of surface.
+        return;
+    }
 
-        y += dY;
+    //the gaussian function is separable, i.e. the product of a 1D gaussian function of y (the row weights, which include alpha)
+    //and one of x (the column weights), so the exponential functions are only calculated once per row and once per column.
+    queuedGaussianRanges.push_back(beginRow);
+    queuedGaussianRanges.push_back(endRow);
+    queuedGaussianRanges.push_back(beginColumn);
+    queuedGaussianRanges.push_back(endColumn);
+    queuedGaussianWeightOffsets.push_back((int) queuedGaussianWeights.size());
+    for (int row = beginRow; row < endRow; row++) {
+        float distance = (-0.5f * ySize + row * dY - yCenter) / sigmaY;
+        queuedGaussianWeights.push_back(alpha * expf(-0.5f * distance * distance));
+    }
+    for (int column = beginColumn; column < endColumn; column++) {
+        float distance = (-0.5f * xSize + column * dX - xCenter) / sigmaX;
+        queuedGaussianWeights.push_back(expf(-0.5f * distance * distance));
     }
 }
 
-float WaterSurface::firstDerivativeX(int row, int column) {
-    int i = row * columnCount + column;
+void WaterSurface::applyQueuedGaussians() {
+    if (queuedGaussianRanges.empty()) {
+        return;
+    }
+
+    //the tiles within the support of a gaussian function change. Waves travel at most half a tile before the next update of the active tiles,
+    //so the tiles around them are activated as well.
+    int gaussianCount = (int) queuedGaussianRanges.size() / 4;
+    surfaceVersion++;
+    queuedGaussianTileRowOffsets.assign(tileRowCount + 1, 0);
+    for (int n = 0; n < gaussianCount; n++) {
+        const int* range = &queuedGaussianRanges[4 * n];
+        int beginTileRow = getTileRow(range[0]);
+        int endTileRow = getTileRow(range[1] - 1) + 1;
+        int beginTileColumn = getTileColumn(range[2]);
+        int endTileColumn = getTileColumn(range[3] - 1) + 1;
+        for (int tileRow = beginTileRow; tileRow < endTileRow; tileRow++) {
+            queuedGaussianTileRowOffsets[tileRow + 1]++;
+        }
+        for (int tileRow = std::max(0, beginTileRow - 1); tileRow < std::min(tileRowCount, endTileRow + 1); tileRow++) {
+            for (int tileColumn = std::max(0, beginTileColumn - 1); tileColumn < std::min(tileColumnCount, endTileColumn + 1); tileColumn++) {
+                int tile = tileRow * tileColumnCount + tileColumn;
+                activeTiles[tile] = 1;
+                if (tileRow >= beginTileRow && tileRow < endTileRow && tileColumn >= beginTileColumn && tileColumn < endTileColumn) {
+                    tileVersions[tile] = surfaceVersion;
+                }
+            }
+        }
+    }
+    updateActiveColumnRanges();
+    spectralModesUpToDate = false;
+
+    //bin the gaussian functions by the tile rows that they overlap (counting sort), in the order in which they were queued.
+    for (int tileRow = 0; tileRow < tileRowCount; tileRow++) {
+        queuedGaussianTileRowOffsets[tileRow + 1] += queuedGaussianTileRowOffsets[tileRow];
+    }
+    queuedGaussianTileRowBins.resize(queuedGaussianTileRowOffsets[tileRowCount]);
+    for (int n = 0; n < gaussianCount; n++) {
+        const int* range = &queuedGaussianRanges[4 * n];
+        for (int tileRow = getTileRow(range[0]); tileRow <= getTileRow(range[1] - 1); tileRow++) {
+            queuedGaussianTileRowBins[queuedGaussianTileRowOffsets[tileRow]++] = n;
+        }
+    }
+    for (int tileRow = tileRowCount; tileRow > 0; tileRow--) {//restore the offsets that were advanced by the loop above.
+        queuedGaussianTileRowOffsets[tileRow] = queuedGaussianTileRowOffsets[tileRow - 1];
+    }
+    queuedGaussianTileRowOffsets[0] = 0;
 
-    //calculate first derivative of surface height in x direction at the given row and column.
-    if (column == 0) {//if western edge.
-        //forward difference approximation (first-order accurate).
-        return (surfaceHeightValues[i + 1] - surfaceHeightValues[i]) / dX;
+    //add the gaussian functions to the vertices within their supports, in parallel for bands of tile rows. Every thread only writes to the rows
+    //of its own tile rows and only visits the gaussian functions that overlap them, so the cost is proportional to the total area of the supports.
+    //Every vertex gets the gaussian functions added in the order in which they were queued, so the results do not depend on the number of threads.
+    threadPool->parallelFor(0, tileRowCount, [&](int beginTileRow, int endTileRow) {
+        for (int tileRow = beginTileRow; tileRow < endTileRow; tileRow++) {
+            int beginRow = getTileBeginRow(tileRow);
+            int endRow = getTileBeginRow(tileRow + 1);
+            for (int bin = queuedGaussianTileRowOffsets[tileRow]; bin < queuedGaussianTileRowOffsets[tileRow + 1]; bin++) {
+                int n = queuedGaussianTileRowBins[bin];
+                const int* range = &queuedGaussianRanges[4 * n];
+                const float* rowWeights = &queuedGaussianWeights[queuedGaussianWeightOffsets[n]];
+                const float* columnWeights = rowWeights + (range[1] - range[0]);
+                for (int row = std::max(beginRow, range[0]); row < std::min(endRow, range[1]); row++) {
+                    //add the same values to previousSurfaceHeightValues for numerical consistency in the simulation.
+                    //Otherwise the temporal terms in the finite-difference approximation will be messed up.
+                    int vertexIndex = row * rowPitch + range[2];
+                    gaussianRowKernel(columnWeights, rowWeights[row - range[0]], &surfaceHeightValues[vertexIndex], &previousSurfaceHeightValues[vertexIndex], range[3] - range[2]);
+                }
+            }
+        }
+    });
 
-    } else if (column == columnCount - 1) {//if eastern edge.
-        //backward difference approximation (first-order accurate).
-        return (surfaceHeightValues[i] - surfaceHeightValues[i - 1]) / dX;
+    queuedGaussianRanges.clear();
+    queuedGaussianWeightOffsets.clear();
+    queuedGaussianWeights.clear();
+}
 
+void WaterSurface::advanceSimulation(float deltaT) {
+    applyQueuedGaussians();
+    if (solverType == SPECTRAL_SOLVER_TYPE) {
+        advanceSpectralSteps(deltaT, 1, normalVectorsEnabled);
+    } else if (solverType == ADI_SOLVER_TYPE) {
+        advanceImplicitStep(deltaT, normalVectorsEnabled);
     } else {
-        //central difference approximation (second-order accurate).
-        return (surfaceHeightValues[i + 1] - surfaceHeightValues[i - 1]) / (2 * dX);
+        if (activeTilesEnabled && stepsSinceActiveTileUpdate >= ACTIVE_TILE_UPDATE_INTERVAL) {
+            updateActiveTiles();
+        }
+        advanceSingleStep(deltaT, normalVectorsEnabled);
+        stepsSinceActiveTileUpdate++;
     }
 }
 
-float WaterSurface::firstDerivativeY(int row, int column) {
-    int i = row * columnCount + column;
+void WaterSurface::advanceSimulation(float deltaT, int stepCount) {
+    applyQueuedGaussians();
+    if (solverType == SPECTRAL_SOLVER_TYPE) {
+        advanceSpectralSteps(deltaT, stepCount, normalVectorsEnabled);
+        return;
+    }
+    if (solverType == ADI_SOLVER_TYPE) {
+        for (int step = 0; step < stepCount; step++) {
+            advanceImplicitStep(deltaT, normalVectorsEnabled && step + 1 == stepCount);
+        }
+        return;
+    }
 
-    //calculate first derivative of surface height in y direction at the given row and column.
-    if (row == 0) {//if southern edge.
-        //forward difference approximation (first-order accurate).
-        return (surfaceHeightValues[i + columnCount] - surfaceHeightValues[i]) / dY;
+    for (int step = 0; step < stepCount;) {
+        int blockStepCount = std::min(temporalBlockSize, stepCount - step);
+        if (activeTilesEnabled) {
+            //the active tiles are updated between temporal blocks, at the same time steps as for single time steps.
+            if (stepsSinceActiveTileUpdate >= ACTIVE_TILE_UPDATE_INTERVAL) {
+                updateActiveTiles();
+            }
+            blockStepCount = std::min(blockStepCount, ACTIVE_TILE_UPDATE_INTERVAL - stepsSinceActiveTileUpdate);
+        }
+        if (blockStepCount == 1) {
+            //only the normal vectors of the last time step are needed.
+            advanceSingleStep(deltaT, normalVectorsEnabled && step + 1 == stepCount);
+        } else {
+            advanceTemporalBlock(deltaT, blockStepCount);
+        }
+        stepsSinceActiveTileUpdate += blockStepCount;
+        step += blockStepCount;
+    }
+}
 
-    } else if (row == rowCount - 1) {//if northern edge.
-        //backward difference approximation (first-order accurate).
-        return (surfaceHeightValues[i] - surfaceHeightValues[i - columnCount]) / dY;
+void WaterSurface::advanceSingleStep(float deltaT, bool calculateNormals) {
+    //this code solves the 2D second-order wave equation numerically using an explicit (leapfrog) method
+    //with second-order finite-difference approximations for both the spatial and the temporal derivatives.
+    //Only the interior vertices are calculated, since the boundary values are set equal to the adjacent values afterwards anyway.
+    //The new values are written over the values of the previous time step, which are only needed for the same vertex,
+    //after which the two buffers are swapped. This way no temporary buffer and no copying is needed.
+    //Only the active tiles are calculated, the inactive tiles are zero in both buffers, so they stay zero.
+    markActiveTilesChanged();
+    if (calculateNormals) {
+        markNormalTiles();
+    }
+    float cX = (C * deltaT / dX) * (C * deltaT / dX);
+    float cY = (C * deltaT / dY) * (C * deltaT / dY);
+    const float* currentValues = &surfaceHeightValues[0];
+    float* newValues = &previousSurfaceHeightValues[0];
 
-    } else {
-        //central difference approximation (second-order accurate).
-        return (surfaceHeightValues[i + columnCount] - surfaceHeightValues[i - columnCount]) / (2 * dY);
+    //the interior rows are calculated in parallel for bands of rows. Each band reads the rows just outside of it
+    //from the shared buffer with the current values, which is not written to during this step.
+    threadPool->parallelFor(1, rowCount - 1, [&](int beginRow, int endRow) {
+        for (int row = beginRow; row < endRow; row++) {
+            int i = row * rowPitch;
+            int tileRow = (row - 1) / ACTIVE_TILE_SIZE;
+            for (int range = activeColumnRangeOffsets[tileRow]; range < activeColumnRangeOffsets[tileRow + 1]; range += 2) {
+                int beginColumn = activeColumnRanges[range];
+                int endColumn = activeColumnRanges[range + 1];
+                waveEquationRowKernel(&currentValues[i + beginColumn], &currentValues[i - rowPitch + beginColumn], &currentValues[i + rowPitch + beginColumn],
+                        &newValues[i + beginColumn], &newValues[i + beginColumn], endColumn - beginColumn, cX, cY);
+            }
+
+            //set boundary values equal to adjacent values to avoid phase jump for waves reflecting at the boundaries.
+            //western edge.
+            newValues[i] = newValues[i + 1];
+            //eastern edge.
+            i += columnCount - 1;
+            newValues[i] = newValues[i - 1];
+
+            //the normals of the previous row only depend on rows of this band that are finished now, calculate them while they are in the cache.
+            if (calculateNormals && row - 1 > beginRow) {
+                calculateChangedNormalVectors(newValues, row - 1);
+            }
+        }
+    });
+
+    //the southern and northern edges depend on rows from the first and last band, so copy them after all bands are finished.
+    //southern edge (including corners).
+    memcpy(&newValues[0], &newValues[rowPitch], columnCount * sizeof(float));
+    //northern edge (including corners).
+    memcpy(&newValues[(rowCount - 1) * rowPitch], &newValues[(rowCount - 2) * rowPitch], columnCount * sizeof(float));
+
+    //calculate the remaining normals, i.e. for the first and last row of each band, which depend on rows of the adjacent bands,
+    //and for the southern and northern edges. This splits the same range over the same threads, so the bands are the same as above.
+    if (calculateNormals) {
+        threadPool->parallelFor(1, rowCount - 1, [&](int beginRow, int endRow) {
+            calculateChangedNormalVectors(newValues, beginRow);
+            if (endRow - 1 > beginRow) {
+                calculateChangedNormalVectors(newValues, endRow - 1);
+            }
+            if (beginRow == 1) {
+                calculateChangedNormalVectors(newValues, 0);
+            }
+            if (endRow == rowCount - 1) {
+                calculateChangedNormalVectors(newValues, rowCount - 1);
+            }
+        });
+        normalVectorsVersion = surfaceVersion;
+        surfaceGradientsVersion = surfaceVersion;
     }
+
+    //the current time step becomes the previous time step.
+    surfaceHeightValues.swap(previousSurfaceHeightValues);
 }
 
-float WaterSurface::secondDerivativeX(int row, int column) {
-    int i = row * columnCount + column;
+void WaterSurface::advanceTemporalBlock(float deltaT, int stepCount) {
+    //this calculates stepCount time steps with exactly the same arithmetic as advanceSingleStep, but in a different order.
+    //The interior columns are divided into tiles, which are processed one after another from west to east.
+    //Within a tile the rows are processed as a wavefront: in every iteration each time step advances by one row and
+    //time step s lags one row behind time step s - 1, so that only about stepCount + 2 rows of the tile are in use at any time.
+    //The tile's column range at time step s is shifted to the west by s - 1 columns (a parallelogram in space-time).
+    //Together this guarantees that, just as in advanceSingleStep, every value of time step s - 2 that is overwritten
+    //by time step s has already been read by all calculations of time step s - 1 that need it.
+    //Only the active tiles are calculated, the same as in advanceSingleStep.
+    markActiveTilesChanged();
+    float cX = (C * deltaT / dX) * (C * deltaT / dX);
+    float cY = (C * deltaT / dY) * (C * deltaT / dY);
+    //values of even time steps are stored in surfaceHeightValues and values of odd time steps in previousSurfaceHeightValues.
+    float* values[2] = {&surfaceHeightValues[0], &previousSurfaceHeightValues[0]};
 
-    //calculate second derivative of surface height in x direction at the given row and column.
-    if (column == 0) {//if western edge.
-        //finite-difference approximation (first-order accurate).
-        return (- 2 * surfaceHeightValues[i] + 4 * surfaceHeightValues[i + 1] - 2 * surfaceHeightValues[i + 2]) / (dX * dX);
+    //choose the tile width such that the rows in use fit in the cache (for both buffers),
+    //but use at least two tiles per thread so that all threads have work to do.
+    int threadCount = threadPool->getThreadCount();
+    //time step s covers interior columns up to s - 1 columns beyond the eastern end of the tiles at time step 1.
+    int tiledColumnCount = (columnCount - 2) + (stepCount - 1);
+    int tileWidth = TEMPORAL_BLOCK_CACHE_SIZE / (2 * (stepCount + 2) * (int) sizeof(float));
+    tileWidth = std::min(tileWidth, (tiledColumnCount + 2 * threadCount - 1) / (2 * threadCount));
+    //round up to a whole number of cache lines.
+    const int floatsPerCacheLine = CACHE_LINE_SIZE / sizeof(float);
+    tileWidth = (tileWidth + floatsPerCacheLine - 1) / floatsPerCacheLine * floatsPerCacheLine;
+    int tileCount = (tiledColumnCount + tileWidth - 1) / tileWidth;
+    int iterationCount = (rowCount - 2) + (stepCount - 1);
 
-    } else if (column == columnCount - 1) {//if eastern edge.
-        //finite-difference approximation (first-order accurate).
-        return (- 2 * surfaceHeightValues[i - 2] + 4 * surfaceHeightValues[i - 1] - 2 * surfaceHeightValues[i]) / (dX * dX);
+    if (tileProgress.size() < tileCount) {
+        tileProgress = vector<atomic<int>>(tileCount);
+    }
+    for (int tile = 0; tile < tileCount; tile++) {
+        tileProgress[tile].store(0, memory_order_relaxed);
+    }
 
-    } else {
-        //finite-difference approximation (second-order accurate).
-        return (surfaceHeightValues[i + 1] - 2 * surfaceHeightValues[i] + surfaceHeightValues[i - 1]) / (dX * dX);
+    //the tiles are processed as a pipeline: thread t processes tiles t, t + threadCount, t + 2 * threadCount, etc.
+    //Every iteration of a tile only depends on the same and earlier iterations of the previous tile (to the west),
+    //so a tile can start an iteration as soon as the previous tile has finished that iteration.
+    threadPool->parallelFor(0, threadCount, [&](int beginThread, int endThread) {
+        for (int thread = beginThread; thread < endThread; thread++) {
+            for (int tile = thread; tile < tileCount; tile += threadCount) {
+                for (int iteration = 1; iteration <= iterationCount; iteration++) {
+                    if (tile > 0) {
+                        while (tileProgress[tile - 1].load(memory_order_acquire) < iteration) {
+                            this_thread::yield();
+                        }
+                    }
+
+                    for (int step = 1; step <= stepCount; step++) {
+                        int row = iteration - (step - 1);
+                        if (row < 1 || row > rowCount - 2) {
+                            continue;
+                        }
+                        int beginColumn = std::max(1, 1 + tile * tileWidth - (step - 1));
+                        int endColumn = std::min(columnCount - 1, 1 + (tile + 1) * tileWidth - (step - 1));
+                        if (beginColumn >= endColumn) {
+                            continue;
+                        }
+
+                        const float* currentValues = values[(step - 1) % 2];
+                        float* newValues = values[step % 2];
+                        int i = row * rowPitch;
+                        int tileRow = (row - 1) / ACTIVE_TILE_SIZE;
+                        for (int range = activeColumnRangeOffsets[tileRow]; range < activeColumnRangeOffsets[tileRow + 1]; range += 2) {
+                            int beginActiveColumn = std::max(beginColumn, activeColumnRanges[range]);
+                            int endActiveColumn = std::min(endColumn, activeColumnRanges[range + 1]);
+                            if (beginActiveColumn < endActiveColumn) {
+                                waveEquationRowKernel(&currentValues[i + beginActiveColumn], &currentValues[i - rowPitch + beginActiveColumn], &currentValues[i + rowPitch + beginActiveColumn],
+                                        &newValues[i + beginActiveColumn], &newValues[i + beginActiveColumn], endActiveColumn - beginActiveColumn, cX, cY);
+                            }
+                        }
+
+                        //set boundary values equal to adjacent values, the same as in advanceSingleStep.
+                        //western edge.
+                        if (beginColumn == 1) {
+                            beginColumn = 0;
+                            newValues[i] = newValues[i + 1];
+                        }
+                        //eastern edge.
+                        if (endColumn == columnCount - 1) {
+                            endColumn = columnCount;
+                            newValues[i + columnCount - 1] = newValues[i + columnCount - 2];
+                        }
+                        //southern edge (including corners).
+                        if (row == 1) {
+                            memcpy(&newValues[beginColumn], &newValues[rowPitch + beginColumn], (endColumn - beginColumn) * sizeof(float));
+                        }
+                        //northern edge (including corners).
+                        if (row == rowCount - 2) {
+                            memcpy(&newValues[(rowCount - 1) * rowPitch + beginColumn], &newValues[(rowCount - 2) * rowPitch + beginColumn], (endColumn - beginColumn) * sizeof(float));
+                        }
+                    }
+
+                    tileProgress[tile].store(iteration, memory_order_release);
+                }
+            }
+        }
+    });
+
+    //the normal vectors are calculated separately when they are needed (see getNormalVectors).
+    //After an odd number of time steps the last time step is stored in previousSurfaceHeightValues.
+    if (stepCount % 2 == 1) {
+        surfaceHeightValues.swap(previousSurfaceHeightValues);
     }
 }
 
-float WaterSurface::secondDerivativeY(int row, int column) {
-    int i = row * columnCount + column;
+void WaterSurface::advanceImplicitStep(float deltaT, bool calculateNormals) {
+    //this code solves the 2D second-order wave equation numerically using an implicit alternating-direction (ADI) method
+    //with the same finite-difference approximations as advanceSingleStep. The spatial terms are a weighted average
+    //over the next, current and previous time steps with weights theta, 1 - 2 * theta and theta:
+    //
+    //(I - theta * cX * Dx) * (I - theta * cY * Dy) * r = (cX * Dx + cY * Dy) * current, with next = (2 * current - previous) + r
+    //
+    //where Dx and Dy are the second differences in x and y direction. The factorization of the left-hand side into a part for
+    //each direction only adds an error of order deltaT^4, but it means that only tridiagonal systems have to be solved:
+    //first one for every row (sweep along rows), then one for every column (sweep along columns).
+    //The boundary values are equal to the adjacent values, so the second differences at the ends of the lines use the same reflection.
+    //The solution of a tridiagonal system spreads every value over the whole line with exponentially decreasing magnitude,
+    //so most of the surface would soon consist of denormal numbers, which are flushed to zero to keep the arithmetic fast.
+    float cX = (C * deltaT / dX) * (C * deltaT / dX);
+    float cY = (C * deltaT / dY) * (C * deltaT / dY);
+    float aX = ADI_THETA * cX;
+    float aY = ADI_THETA * cY;
+    //all tiles are active for this solver.
+    markActiveTilesChanged();
+    int interiorRowCount = rowCount - 2;
+    int interiorColumnCount = columnCount - 2;
+    if (deltaT != adiDeltaT) {
+        factorTridiagonalMatrix(aX, interiorColumnCount, &adiInverseDiagonalsX[0], &adiUpperFactorsX[0]);
+        factorTridiagonalMatrix(aY, interiorRowCount, &adiInverseDiagonalsY[0], &adiUpperFactorsY[0]);
+        adiDeltaT = deltaT;
+    }
+    const float* currentValues = &surfaceHeightValues[0];
+    float* intermediateValues = &adiIntermediateValues[0];
+    float* newValues = &previousSurfaceHeightValues[0];
 
-    //calculate second derivative of surface height in y direction at the given row and column.
-    if (row == 0) {//if southern edge.
-        //finite-difference approximation (first-order accurate).
-        return (- 2 * surfaceHeightValues[i] + 4 * surfaceHeightValues[i + columnCount] - 2 * surfaceHeightValues[i + 2 * columnCount]) / (dY * dY);
+    //sweep along rows. A row is solved from west to east, which is a chain of dependent operations, so groups of rows are solved together
+    //by interleaving their values in a per-thread buffer. Then the innermost loops run over the rows of the group and can be vectorized.
+    //The groups are distributed over the threads in the same way for any number of threads, so the results do not depend on it.
+    int threadCount = threadPool->getThreadCount();
+    int groupCount = (interiorRowCount + TRIDIAGONAL_LINE_GROUP_SIZE - 1) / TRIDIAGONAL_LINE_GROUP_SIZE;
+    threadPool->parallelFor(0, threadCount, [&](int beginThread, int endThread) {
+        unsigned int floatingPointControlState = enableFlushDenormalsToZero();
+        for (int thread = beginThread; thread < endThread; thread++) {
+            float* lineValues = &adiLineValues[thread * TRIDIAGONAL_LINE_GROUP_SIZE * interiorColumnCount];
+            for (int group = groupCount * thread / threadCount; group < groupCount * (thread + 1) / threadCount; group++) {
+                int beginRow = 1 + group * TRIDIAGONAL_LINE_GROUP_SIZE;
+                int lineCount = std::min(TRIDIAGONAL_LINE_GROUP_SIZE, rowCount - 1 - beginRow);
 
-    } else if (row == rowCount - 1) {//if northern edge.
-        //finite-difference approximation (first-order accurate).
-        return (- 2 * surfaceHeightValues[i - 2 * columnCount] + 4 * surfaceHeightValues[i - columnCount] - 2 * surfaceHeightValues[i]) / (dY * dY);
+                //right-hand side, the same spatial terms as in the explicit scheme. The lines of the last group that are beyond the last row are zero.
+                for (int line = 0; line < TRIDIAGONAL_LINE_GROUP_SIZE; line++) {
+                    if (line >= lineCount) {
+                        for (int column = 0; column < interiorColumnCount; column++) {
+                            lineValues[column * TRIDIAGONAL_LINE_GROUP_SIZE + line] = 0;
+                        }
+                        continue;
+                    }
 
-    } else {
-        //finite-difference approximation (second-order accurate).
-        return (surfaceHeightValues[i + columnCount] - 2 * surfaceHeightValues[i] + surfaceHeightValues[i - columnCount]) / (dY * dY);
+                    const float* values = &currentValues[(beginRow + line) * rowPitch + 1];
+                    for (int column = 0; column < interiorColumnCount; column++) {
+                        float c = values[column];
+                        float twoC = c + c;
+                        float laplacianX = (values[column - 1] + values[column + 1]) - twoC;
+                        float laplacianY = (values[column - rowPitch] + values[column + rowPitch]) - twoC;
+                        lineValues[column * TRIDIAGONAL_LINE_GROUP_SIZE + line] = cX * laplacianX + cY * laplacianY;
+                    }
+                }
+
+                solveTridiagonalLines(aX, &adiInverseDiagonalsX[0], &adiUpperFactorsX[0], lineValues, interiorColumnCount, TRIDIAGONAL_LINE_GROUP_SIZE, TRIDIAGONAL_LINE_GROUP_SIZE);
+
+                for (int line = 0; line < lineCount; line++) {
+                    float* values = &intermediateValues[(beginRow + line) * rowPitch + 1];
+                    for (int column = 0; column < interiorColumnCount; column++) {
+                        values[column] = lineValues[column * TRIDIAGONAL_LINE_GROUP_SIZE + line];
+                    }
+                }
+            }
+        }
+        restoreFloatingPointControlState(floatingPointControlState);
+    });
+
+    //sweep along columns. Here the columns are already interleaved in the rows, so blocks of columns are solved in place.
+    //The blocks start at whole cache lines, so that no two threads write to the same cache line. A block is solved for whole groups
+    //of columns, which can include the edge columns and the padding at the end of the rows. Those are zero in intermediateValues
+    //(the sweep along rows only writes interior vertices), so they stay zero and do not affect the interior columns.
+    int solvedColumnCount = (columnCount - 1 + TRIDIAGONAL_LINE_GROUP_SIZE - 1) / TRIDIAGONAL_LINE_GROUP_SIZE * TRIDIAGONAL_LINE_GROUP_SIZE;
+    int columnBlockCount = (solvedColumnCount + ADI_COLUMN_BLOCK_SIZE - 1) / ADI_COLUMN_BLOCK_SIZE;
+    threadPool->parallelFor(0, columnBlockCount, [&](int beginBlock, int endBlock) {
+        unsigned int floatingPointControlState = enableFlushDenormalsToZero();
+        for (int block = beginBlock; block < endBlock; block++) {
+            int beginSolvedColumn = block * ADI_COLUMN_BLOCK_SIZE;
+            int endSolvedColumn = std::min(solvedColumnCount, (block + 1) * ADI_COLUMN_BLOCK_SIZE);
+            solveTridiagonalLines(aY, &adiInverseDiagonalsY[0], &adiUpperFactorsY[0], &intermediateValues[rowPitch + beginSolvedColumn],
+                    interiorRowCount, endSolvedColumn - beginSolvedColumn, rowPitch);
+
+            //the back substitution ended in the southern rows, so combine the time steps from south to north while those are still in the cache.
+            //The new values are written over the values of the previous time step, the same as in advanceSingleStep.
+            int beginColumn = std::max(1, beginSolvedColumn);
+            int endColumn = std::min(columnCount - 1, endSolvedColumn);
+            for (int row = 1; row < rowCount - 1; row++) {
+                int i = row * rowPitch;
+                for (int column = beginColumn; column < endColumn; column++) {
+                    float c = currentValues[i + column];
+                    float twoC = c + c;
+                    newValues[i + column] = (twoC - newValues[i + column]) + intermediateValues[i + column];
+                }
+
+                //set boundary values equal to adjacent values, the same as in advanceSingleStep.
+                //western edge.
+                if (beginColumn == 1) {
+                    newValues[i] = newValues[i + 1];
+                }
+                //eastern edge.
+                if (endColumn == columnCount - 1) {
+                    newValues[i + columnCount - 1] = newValues[i + columnCount - 2];
+                }
+            }
+        }
+        restoreFloatingPointControlState(floatingPointControlState);
+    });
+
+    //southern edge (including corners).
+    memcpy(&newValues[0], &newValues[rowPitch], columnCount * sizeof(float));
+    //northern edge (including corners).
+    memcpy(&newValues[(rowCount - 1) * rowPitch], &newValues[(rowCount - 2) * rowPitch], columnCount * sizeof(float));
+
+    //the current time step becomes the previous time step.
+    surfaceHeightValues.swap(previousSurfaceHeightValues);
+
+    //the normal vectors are calculated in a separate pass.
+    if (calculateNormals) {
+        updateNormalVectors();
     }
 }
 
-void WaterSurface::advanceSimulation(float deltaT) {
-    vector<float> newSurfaceHeightValues = vector<float>(vertexCount);//temporary vector to store calculated values.
-
-    //this code solves the 2D second-order wave equation numerically using an explicit euler method
-    //with finite-difference approximations for both the spatial and the temporal derivatives.
-    for (int vertexIndex = 0; vertexIndex < vertexCount; vertexIndex++) {
-        int row = vertexIndex / columnCount;
-        int column = vertexIndex % columnCount;
-        float previousZ = previousSurfaceHeightValues[vertexIndex];
-        float currentZ = surfaceHeightValues[vertexIndex];
-
-        //linear advection equation.
-        //float artificialDissipationTerm = K * (deltaX * deltaX * secondDerivativeX(row, column) + deltaY * deltaY * secondDerivativeY(row, column));
-        //float spatialTerms = C * (firstDerivativeX(row, column) + firstDerivativeY(row, column)) - artificialDissipationTerm;
-        //float nextZ = currentZ - deltaT * spatialTerms;
-
-        //linear diffusion equation.
-        //float spatialTerms = - D * (secondDerivativeX(row, column) + secondDerivativeY(row, column));
-        //float nextZ = currentZ - deltaT * spatialTerms;
-
-        //linear advection-diffusion equation.
-        //float spatialTerms = C * (firstDerivativeX(row, column) + firstDerivativeY(row, column)) - D * (secondDerivativeX(row, column) + secondDerivativeY(row, column));
-        //float nextZ = currentZ - deltaT * spatialTerms;
-
-        //second-order wave equation.
-        float spatialTerms = - C * C * (secondDerivativeX(row, column) + secondDerivativeY(row, column));
-        float nextZ = 2 * currentZ - previousZ - deltaT * deltaT * spatialTerms;
-
-        newSurfaceHeightValues[vertexIndex] = nextZ;
-    }
-
-    //set boundary values equal to adjacent values to avoid phase jump for waves reflecting at the boundaries.
-    for (int row = 0; row < rowCount; row++) {
-        //western edge.
-        int i = row * columnCount;
-        newSurfaceHeightValues[i] = newSurfaceHeightValues[i + 1];
-        //eastern edge.
-        i = row * columnCount + columnCount - 1;
-        newSurfaceHeightValues[i] = newSurfaceHeightValues[i - 1];
-    }
-    for (int column = 0; column < columnCount; column++) {
-        //southern edge.
-        int i = column;
-        newSurfaceHeightValues[i] = newSurfaceHeightValues[i + columnCount];
-        //northern edge.
-        i = (rowCount - 1) * columnCount + column;
-        newSurfaceHeightValues[i] = newSurfaceHeightValues[i - columnCount];
-    }
-
-    for (int vertexIndex = 0; vertexIndex < vertexCount; vertexIndex++) {
-        previousSurfaceHeightValues[vertexIndex] = surfaceHeightValues[vertexIndex];
-        surfaceHeightValues[vertexIndex] = newSurfaceHeightValues[vertexIndex];
+void WaterSurface::transformToSpectralModes(const float* heightValues, float* modeValues) {
+    //2D cosine transform of the interior vertices: first along all rows, then along all columns.
+    //The rows and groups of columns are distributed over the threads in the same way for any number of threads,
+    //so the results do not depend on it.
+    int interiorRowCount = rowCount - 2;
+    int interiorColumnCount = columnCount - 2;
+    int threadCount = threadPool->getThreadCount();
+    int scratchSize = (int) spectralScratchValues.size() / threadCount;
+
+    //transform along rows.
+    threadPool->parallelFor(0, threadCount, [&](int beginThread, int endThread) {
+        unsigned int floatingPointControlState = enableFlushDenormalsToZero();
+        for (int thread = beginThread; thread < endThread; thread++) {
+            float* scratch = &spectralScratchValues[thread * scratchSize];
+            for (int row = interiorRowCount * thread / threadCount; row < interiorRowCount * (thread + 1) / threadCount; row++) {
+                float* modes = &modeValues[row * rowPitch];
+                memcpy(modes, &heightValues[(row + 1) * rowPitch + 1], interiorColumnCount * sizeof(float));
+                rowCosineTransform->transform(modes, scratch);
+            }
+        }
+        restoreFloatingPointControlState(floatingPointControlState);
+    });
+
+    //transform along columns. A column is not contiguous in memory, so groups of columns are copied into contiguous lines,
+    //which reads whole cache lines from every row.
+    int groupCount = (interiorColumnCount + SPECTRAL_COLUMN_GROUP_SIZE - 1) / SPECTRAL_COLUMN_GROUP_SIZE;
+    threadPool->parallelFor(0, threadCount, [&](int beginThread, int endThread) {
+        unsigned int floatingPointControlState = enableFlushDenormalsToZero();
+        for (int thread = beginThread; thread < endThread; thread++) {
+            float* lines = &spectralScratchValues[thread * scratchSize];
+            float* scratch = lines + SPECTRAL_COLUMN_GROUP_SIZE * interiorRowCount;
+            for (int group = groupCount * thread / threadCount; group < groupCount * (thread + 1) / threadCount; group++) {
+                int beginColumn = group * SPECTRAL_COLUMN_GROUP_SIZE;
+                int lineCount = std::min(SPECTRAL_COLUMN_GROUP_SIZE, interiorColumnCount - beginColumn);
+                for (int row = 0; row < interiorRowCount; row++) {
+                    const float* modes = &modeValues[row * rowPitch + beginColumn];
+                    for (int line = 0; line < lineCount; line++) {
+                        lines[line * interiorRowCount + row] = modes[line];
+                    }
+                }
+                for (int line = 0; line < lineCount; line++) {
+                    columnCosineTransform->transform(&lines[line * interiorRowCount], scratch);
+                }
+                for (int row = 0; row < interiorRowCount; row++) {
+                    float* modes = &modeValues[row * rowPitch + beginColumn];
+                    for (int line = 0; line < lineCount; line++) {
+                        modes[line] = lines[line * interiorRowCount + row];
+                    }
+                }
+            }
+        }
+        restoreFloatingPointControlState(floatingPointControlState);
+    });
+}
+
+void WaterSurface::transformFromSpectralModes(const float* modeValues, float* heightValues) {
+    //inverse of transformToSpectralModes: first along all columns, then along all rows.
+    int interiorRowCount = rowCount - 2;
+    int interiorColumnCount = columnCount - 2;
+    int threadCount = threadPool->getThreadCount();
+    int scratchSize = (int) spectralScratchValues.size() / threadCount;
+
+    //inverse transform along columns, from the modes into the interior vertices.
+    int groupCount = (interiorColumnCount + SPECTRAL_COLUMN_GROUP_SIZE - 1) / SPECTRAL_COLUMN_GROUP_SIZE;
+    threadPool->parallelFor(0, threadCount, [&](int beginThread, int endThread) {
+        unsigned int floatingPointControlState = enableFlushDenormalsToZero();
+        for (int thread = beginThread; thread < endThread; thread++) {
+            float* lines = &spectralScratchValues[thread * scratchSize];
+            float* scratch = lines + SPECTRAL_COLUMN_GROUP_SIZE * interiorRowCount;
+            for (int group = groupCount * thread / threadCount; group < groupCount * (thread + 1) / threadCount; group++) {
+                int beginColumn = group * SPECTRAL_COLUMN_GROUP_SIZE;
+                int lineCount = std::min(SPECTRAL_COLUMN_GROUP_SIZE, interiorColumnCount - beginColumn);
+                for (int row = 0; row < interiorRowCount; row++) {
+                    const float* modes = &modeValues[row * rowPitch + beginColumn];
+                    for (int line = 0; line < lineCount; line++) {
+                        lines[line * interiorRowCount + row] = modes[line];
+                    }
+                }
+                for (int line = 0; line < lineCount; line++) {
+                    columnCosineTransform->inverseTransform(&lines[line * interiorRowCount], scratch);
+                }
+                for (int row = 0; row < interiorRowCount; row++) {
+                    float* values = &heightValues[(row + 1) * rowPitch + 1 + beginColumn];
+                    for (int line = 0; line < lineCount; line++) {
+                        values[line] = lines[line * interiorRowCount + row];
+                    }
+                }
+            }
+        }
+        restoreFloatingPointControlState(floatingPointControlState);
+    });
+
+    //inverse transform along rows, in place.
+    threadPool->parallelFor(0, threadCount, [&](int beginThread, int endThread) {
+        unsigned int floatingPointControlState = enableFlushDenormalsToZero();
+        for (int thread = beginThread; thread < endThread; thread++) {
+            float* scratch = &spectralScratchValues[thread * scratchSize];
+            for (int row = 1 + interiorRowCount * thread / threadCount; row < 1 + interiorRowCount * (thread + 1) / threadCount; row++) {
+                int i = row * rowPitch;
+                rowCosineTransform->inverseTransform(&heightValues[i + 1], scratch);
+
+                //set boundary values equal to adjacent values, the same as in advanceSingleStep.
+                //western edge.
+                heightValues[i] = heightValues[i + 1];
+                //eastern edge.
+                heightValues[i + columnCount - 1] = heightValues[i + columnCount - 2];
+            }
+        }
+        restoreFloatingPointControlState(floatingPointControlState);
+    });
+
+    //southern edge (including corners).
+    memcpy(&heightValues[0], &heightValues[rowPitch], columnCount * sizeof(float));
+    //northern edge (including corners).
+    memcpy(&heightValues[(rowCount - 1) * rowPitch], &heightValues[(rowCount - 2) * rowPitch], columnCount * sizeof(float));
+}
+
+void WaterSurface::advanceSpectralSteps(float deltaT, int stepCount, bool calculateNormals) {
+    //the cosine modes are the eigenvectors of the same finite-difference approximation of the spatial derivatives
+    //with reflecting edges that the other solvers use. The mode with wave numbers k and l has the eigenvalue -omega^2 with
+    //omega^2 = C^2 * ((2 * sin(pi * k / (2 * interiorColumnCount)) / dX)^2 + (2 * sin(pi * l / (2 * interiorRowCount)) / dY)^2),
+    //so its amplitude a is a harmonic oscillator. For any oscillation a(t + deltaT) + a(t - deltaT) = 2 * cos(omega * deltaT) * a(t),
+    //so every time step is exact. This is calculated as a difference d(t) = a(t) - a(t - deltaT) plus the change of that difference,
+    //(2 * cos(omega * deltaT) - 2) * a(t), which is small for long waves, so that rounding errors do not accumulate over many time steps.
+    //The mode amplitudes are kept between calls, so that only the results need to be transformed back.
+    int interiorRowCount = rowCount - 2;
+    int interiorColumnCount = columnCount - 2;
+    //all tiles are active for this solver.
+    markActiveTilesChanged();
+    if (deltaT != spectralDeltaT) {
+        threadPool->parallelFor(0, interiorRowCount, [&](int beginRow, int endRow) {
+            for (int row = beginRow; row < endRow; row++) {
+                double omegaY = 2 * sin(M_PI * row / (2.0 * interiorRowCount)) / dY;
+                for (int column = 0; column < interiorColumnCount; column++) {
+                    double omegaX = 2 * sin(M_PI * column / (2.0 * interiorColumnCount)) / dX;
+                    double omega = C * sqrt(omegaX * omegaX + omegaY * omegaY);
+                    //2 * cos(x) - 2 = -4 * sin(x / 2)^2, which does not lose precision for small x.
+                    double halfSine = sin(omega * deltaT / 2);
+                    spectralPropagationFactors[row * rowPitch + column] = (float) (-4 * halfSine * halfSine);
+                }
+            }
+        });
+        spectralDeltaT = deltaT;
+    }
+    if (!spectralModesUpToDate) {
+        transformToSpectralModes(&surfaceHeightValues[0], &spectralModeValues[0]);
+        transformToSpectralModes(&previousSurfaceHeightValues[0], &spectralModeDifferences[0]);
+        for (int i = 0; i < interiorRowCount * rowPitch; i++) {
+            spectralModeDifferences[i] = spectralModeValues[i] - spectralModeDifferences[i];
+        }
+    }
+
+    const float* factors = &spectralPropagationFactors[0];
+    float* modes = &spectralModeValues[0];
+    float* differences = &spectralModeDifferences[0];
+    threadPool->parallelFor(0, interiorRowCount, [&](int beginRow, int endRow) {
+        unsigned int floatingPointControlState = enableFlushDenormalsToZero();
+        for (int step = 0; step < stepCount; step++) {
+            for (int i = beginRow * rowPitch; i < endRow * rowPitch; i++) {
+                differences[i] += factors[i] * modes[i];
+                modes[i] += differences[i];
+            }
+        }
+        restoreFloatingPointControlState(floatingPointControlState);
+    });
+
+    //transform back. After a single time step the previous time step is the current time step before this call,
+    //otherwise the differences are also transformed back and subtracted, since the transform is linear.
+    transformFromSpectralModes(modes, &previousSurfaceHeightValues[0]);
+    if (stepCount > 1) {
+        transformFromSpectralModes(differences, &surfaceHeightValues[0]);
+        for (int i = 0; i < rowCount * rowPitch; i++) {
+            surfaceHeightValues[i] = previousSurfaceHeightValues[i] - surfaceHeightValues[i];
+        }
+    }
+    surfaceHeightValues.swap(previousSurfaceHeightValues);
+    spectralModesUpToDate = true;
+
+    //the normal vectors are calculated in a separate pass.
+    if (calculateNormals) {
+        updateNormalVectors();
     }
 }
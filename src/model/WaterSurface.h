@@ -2,14 +2,29 @@
  * Copyright (c) 2018 A.C. Kockx, All Rights Reserved.
  */
 
-#include "shader/DisplacedZPhongShader.h"
-#include "util/BoundingBox.h"
+#include <atomic>
+
+#include "util/ModelUtils.h"
+#include "util/AlignedAllocator.h"
+#include "util/ThreadPool.h"
+#include "util/CosineTransform.h"
+#include "model/WaveEquationKernels.h"
+#include "model/SurfaceNormalKernels.h"
+#include "model/GaussianKernels.h"
+#include "model/SurfaceSampleKernels.h"
 
 #ifndef INCLUDED_WATERSURFACE_H
 #define INCLUDED_WATERSURFACE_H
 
+enum {
+    EXPLICIT_SOLVER_TYPE,
+    ADI_SOLVER_TYPE,
+    SPECTRAL_SOLVER_TYPE
+};
+
 /**
- * 3D model of a horizontal water surface.
+ * Physical model of a horizontal water surface.
+ * This class does not depend on OpenGL, see WaterSurfaceView for drawing a water surface.
  */
 class WaterSurface {
     private:
@@ -21,65 +36,279 @@ class WaterSurface {
         float x;//in m.
         float y;//in m.
         float z;//in m.
-        mat4 modelMatrix;
 
         //geometry.
-        const int rowCount = 100;
-        const int columnCount = 100;
-        //vertices are in 3D, i.e. 3 coordinates together form 1 vertex.
-        const GLint dimensionCount = 3;
-        const int vertexCount = rowCount * columnCount;
-        vector<float> surfaceHeightValues;//vertex z displacements relative to the vertex coordinates in model space.
-        vector<float> previousSurfaceHeightValues;//vertex z displacements for previous time step.
-        GLuint vertexArrayObjectId;
-        GLuint normalsVertexBufferObjectId;
-        GLuint zDisplacementVertexBufferObjectId;
-        GLuint indexBufferObjectId;
-        int indexCount;
-
-        //material.
-        DisplacedZPhongShader shader = DisplacedZPhongShader(0.9f, 15);
-        float waterColor[3] = {0, 0, 1};//blue.
-
-        void updateZDisplacements();//update z displacements in graphics card memory.
-        void updateNormalVectors();//update normals in graphics card memory.
-        float firstDerivativeX(int row, int column);//in model space.
-        float firstDerivativeY(int row, int column);//in model space.
-        float secondDerivativeX(int row, int column);//in model space.
-        float secondDerivativeY(int row, int column);//in model space.
+        int rowCount;
+        int columnCount;
+        //number of floats between the starts of two consecutive rows, i.e. columnCount plus padding.
+        //Every row starts on a cache line, so that vector loads within a row never straddle two rows.
+        int rowPitch;
+        vector<float, AlignedAllocator<float, CACHE_LINE_SIZE>> surfaceHeightValues;//vertex z displacements relative to the vertex coordinates in model space.
+        vector<float, AlignedAllocator<float, CACHE_LINE_SIZE>> previousSurfaceHeightValues;//vertex z displacements for previous time step.
+        vector<float, AlignedAllocator<float, CACHE_LINE_SIZE>> normalVectors;//vertex normal vectors (x, y, z) in model space for the current time step.
+        vector<float, AlignedAllocator<float, CACHE_LINE_SIZE>> surfaceGradientXValues;//first derivatives of the surface heights in x direction.
+        vector<float, AlignedAllocator<float, CACHE_LINE_SIZE>> surfaceGradientYValues;//first derivatives of the surface heights in y direction.
+        bool normalVectorsEnabled;//true if advanceSimulation calculates normalVectors and surface gradients.
 
-    public:
-        /**
-         * Creates a rectangular horizontal surface with the given size centered on the given position (in world space).
-         */
-        WaterSurface(float xSize, float ySize, float x, float y, float z);
+        //versions, used to recalculate and copy only the parts of the surface that changed.
+        unsigned int surfaceVersion;//incremented whenever surfaceHeightValues change.
+        vector<unsigned int> tileVersions;//per tile: surfaceVersion of the last change of its surface heights.
+        unsigned int normalVectorsVersion;//surfaceVersion that normalVectors correspond to.
+        unsigned int surfaceGradientsVersion;//surfaceVersion that the surface gradients correspond to.
+        vector<unsigned char> normalTiles;//per tile: 1 if its normal vectors must be recalculated, see markNormalTiles.
 
-        /**
-         * Returns the index of the vertex closest to the given x and y (in world space).
-         * Returns -1 if the given coordinates are outside of this surface.
-         */
-        int getIndexOfClosestVertex(float x, float y);
+        //active tiles. The interior vertices are divided into tiles of ACTIVE_TILE_SIZE x ACTIVE_TILE_SIZE vertices in row-major order,
+        //the edge vertices belong to the adjacent tiles. The explicit solver only advances the active tiles. All surface heights of
+        //inactive tiles are zero in both time steps, so they would not change if they were advanced.
+        bool activeTilesEnabled;
+        int tileRowCount;
+        int tileColumnCount;
+        vector<unsigned char> activeTiles;//per tile: 1 if active.
+        vector<float> tileQuadrantMaxima;//per tile: largest absolute surface height in its south-west, south-east, north-west and north-east quadrant (at least up to ACTIVE_TILE_EPSILON).
+        vector<int> activeColumnRanges;//runs of adjacent active tiles as (beginColumn, endColumn) pairs of interior columns, ordered by tile row.
+        vector<int> activeColumnRangeOffsets;//per tile row: index of its first run in activeColumnRanges, plus the total at the end.
+        int stepsSinceActiveTileUpdate;
+        int activeTileUpdateCount;
+
+        //gaussian functions that were added with addGaussian but not yet applied to the surface heights, see applyQueuedGaussians.
+        vector<int> queuedGaussianRanges;//per gaussian: beginRow, endRow, beginColumn and endColumn of the vertices within its truncated support.
+        vector<int> queuedGaussianWeightOffsets;//per gaussian: index of its row weights in queuedGaussianWeights.
+        vector<float> queuedGaussianWeights;//per gaussian: the row weights (including alpha) followed by the column weights.
+        vector<int> queuedGaussianTileRowOffsets;//per tile row: index of its first gaussian in queuedGaussianTileRowBins, plus the total at the end.
+        vector<int> queuedGaussianTileRowBins;//per tile row: the gaussians whose supports overlap it, in the order in which they were queued.
+
+        //solver.
+        ThreadPool* threadPool;//used to process bands of rows in parallel.
+        int solverType;
+        int instructionSet;//see CpuFeatures.h.
+        WaveEquationRowKernel waveEquationRowKernel;
+        SurfaceNormalRowKernel surfaceNormalRowKernel;
+        GaussianRowKernel gaussianRowKernel;
+        SurfaceSampleKernel surfaceSampleKernel;
+        int temporalBlockSize;//maximum number of time steps that are advanced per tile before moving on to the next tile.
+        vector<atomic<int>> tileProgress;//number of finished wavefront iterations per tile in the current temporal block.
+
+        //implicit (ADI) solver.
+        float adiDeltaT;//time step that the factored tridiagonal matrices below correspond to.
+        vector<float> adiInverseDiagonalsX;//factored tridiagonal matrix for the lines along rows.
+        vector<float> adiUpperFactorsX;
+        vector<float> adiInverseDiagonalsY;//factored tridiagonal matrix for the lines along columns.
+        vector<float> adiUpperFactorsY;
+        vector<float, AlignedAllocator<float, CACHE_LINE_SIZE>> adiIntermediateValues;//solution of the sweep along rows.
+        vector<float, AlignedAllocator<float, CACHE_LINE_SIZE>> adiLineValues;//per thread: a block of rows stored with the rows interleaved.
+
+        //spectral solver. The amplitudes of the cosine modes of the interior vertices are stored in row-major order with the same row pitch
+        //as the surface heights, where the mode with wave number k in x direction and l in y direction is stored at l * rowPitch + k.
+        CosineTransform* rowCosineTransform;//transform along the interior columns of a row.
+        CosineTransform* columnCosineTransform;//transform along the interior rows of a column.
+        float spectralDeltaT;//time step that spectralPropagationFactors correspond to.
+        vector<float, AlignedAllocator<float, CACHE_LINE_SIZE>> spectralPropagationFactors;//2 * cos(omega * deltaT) - 2 for every mode.
+        vector<float, AlignedAllocator<float, CACHE_LINE_SIZE>> spectralModeValues;//mode amplitudes for the current time step.
+        vector<float, AlignedAllocator<float, CACHE_LINE_SIZE>> spectralModeDifferences;//mode amplitudes for the current minus the previous time step.
+        bool spectralModesUpToDate;//true if the mode amplitudes correspond to the surface heights of both time steps.
+        vector<float, AlignedAllocator<float, CACHE_LINE_SIZE>> spectralScratchValues;//per thread: a group of columns and scratch memory for the transforms.
+
+        void advanceSingleStep(float deltaT, bool calculateNormals);
+        void advanceTemporalBlock(float deltaT, int stepCount);
+        void advanceImplicitStep(float deltaT, bool calculateNormals);
+        void advanceSpectralSteps(float deltaT, int stepCount, bool calculateNormals);
+        void transformToSpectralModes(const float* heightValues, float* modeValues);
+        void transformFromSpectralModes(const float* modeValues, float* heightValues);
+        void calculateNormalVectors(const float* heightValues, float* normals, int row, int beginColumn, int endColumn);
+        void calculateChangedNormalVectors(const float* heightValues, int row);
+        void markNormalTiles();
+        void updateNormalVectors();
+        void markActiveTilesChanged();
+        void markAllTilesActive();
+        void updateActiveTiles();
+        void updateActiveColumnRanges();
+        int getTileRow(int row);
+        int getTileColumn(int column);
+        void applyQueuedGaussians();
+
+    public:
+        static const float ACTIVE_TILE_EPSILON;//largest surface height (in m) that is considered flat, see setActiveTilesEnabled.
 
         /**
-         * Returns the height of the surface (in world space) at the given vertexIndex.
+         * Creates a rectangular horizontal surface with the given size centered on the given position (in world space).
+         * The surface is discretized as a grid with the given number of rows (in y direction) and columns (in x direction).
+         * The given threadPool is used to run the calculations in parallel, the results do not depend on its number of threads.
          */
-        float getSurfaceHeight(int vertexIndex);
+        WaterSurface(int rowCount, int columnCount, float xSize, float ySize, float x, float y, float z, ThreadPool* threadPool);
 
         /**
          * Returns the gradient of the surface (in world space) at the given vertexIndex.
+         * The vertex with a given row and column has index row * rowPitch + column.
          * The surface gradient is a 2D vector in the xy-plane in world space.
+         * The gradient is taken from the same pass that calculates the normal vectors, see getNormalVectors.
+         * If that pass is disabled, then only the gradient at the given vertex is calculated (with bitwise identical results).
          */
         vec2 getSurfaceGradient(int vertexIndex);
 
+        /**
+         * Samples this surface at count points (xValues[i], yValues[i]) in world space and stores the height of the surface (in world space)
+         * and its gradient (a 2D vector in the xy-plane in world space) at every point in heights, gradientsX and gradientsY.
+         * The heights and the gradients at the vertices (see getSurfaceGradient) are bilinearly interpolated between the 4 vertices around each point,
+         * so they change smoothly when a point moves across the grid. Points outside of this surface get a height of -infinity and a zero gradient.
+         * The points are processed with vectorized kernels, in parallel for chunks of points. The results do not depend on the number of threads.
+         * This must not be called from within a loop of the thread pool of this surface.
+         */
+        void sampleSurface(const float* xValues, const float* yValues, int count, float* heights, float* gradientsX, float* gradientsY);
+
         /**
          * Getters.
          */
         float getXSize();//in model space.
         float getYSize();//in model space.
+        float getX();//in world space.
+        float getY();//in world space.
+        float getZ();//in world space.
+        int getRowCount();
+        int getColumnCount();
+        int getRowPitch();
+        int getSolverType();
+        int getInstructionSet();
+        int getTemporalBlockSize();
+        bool isNormalVectorsEnabled();
+        bool isActiveTilesEnabled();
+        int getActiveTileCount();
+
+        /**
+         * Returns the number of updates of the active tiles since this surface was created, see setActiveTilesEnabled.
+         * Every update changes the surface heights by at most ACTIVE_TILE_EPSILON, because it only flattens tiles
+         * in which all surface heights are at most ACTIVE_TILE_EPSILON.
+         */
+        int getActiveTileUpdateCount();
+
+        /**
+         * The vertices are divided into tiles for tracking which parts of the surface are active and which parts changed, see setActiveTilesEnabled.
+         * Tile (tileRow, tileColumn) contains the vertices with getTileBeginRow(tileRow) <= row < getTileBeginRow(tileRow + 1)
+         * and getTileBeginColumn(tileColumn) <= column < getTileBeginColumn(tileColumn + 1). The tiles are numbered in row-major order.
+         * These only depend on the size of the grid, so they can be called from any thread.
+         */
+        int getTileRowCount();
+        int getTileColumnCount();
+        int getTileBeginRow(int tileRow);
+        int getTileBeginColumn(int tileColumn);
+
+        /**
+         * Returns a number that is incremented whenever the surface heights change.
+         */
+        unsigned int getSurfaceVersion();
+
+        /**
+         * Returns for every tile the surface version (see getSurfaceVersion) of the last change of its surface heights.
+         * A copy of the surface heights or normal vectors that was made at a given surface version only needs to be updated
+         * for the vertices in getChangedColumnRange.
+         */
+        const unsigned int* getTileVersions();
+
+        /**
+         * Sets beginColumn and endColumn to the smallest range of columns that contains all vertices in the given tile row whose surface heights
+         * changed after the given surface version according to the given tile versions (e.g. a copy of getTileVersions).
+         * If normalVectors is true, then the range also contains all vertices whose normal vectors changed after the given surface version.
+         * endColumn is beginColumn if nothing changed. This only depends on the size of the grid, so it can be called from any thread.
+         */
+        void getChangedColumnRange(const unsigned int* tileVersions, unsigned int sinceVersion, int tileRow, bool normalVectors, int& beginColumn, int& endColumn);
+
+        /**
+         * Copies the surface heights (or normal vectors if normalVectors is true) of the vertices in getChangedColumnRange of every tile row from source
+         * to destination, which both have the layout of getSurfaceHeightValues (or getNormalVectors). This updates a copy that was made at the given
+         * surface version to the version of the given tile versions. This only depends on the size of the grid, so it can be called from any thread.
+         */
+        void copyChangedVertices(const unsigned int* tileVersions, unsigned int sinceVersion, bool normalVectors, const float* source, float* destination);
+
+        /**
+         * Returns the largest time step (in seconds) for which the current solver is stable. For the explicit solver this is the time step
+         * for which the Courant number C * deltaT * sqrt(1 / dX^2 + 1 / dY^2) is 1 (the CFL condition), larger time steps make the solution blow up.
+         * The ADI and spectral solvers are stable for any time step, so then this returns infinity.
+         */
+        float getMaxStableDeltaT();
+
+        /**
+         * Returns the Courant number C * deltaT * sqrt(1 / dX^2 + 1 / dY^2) for the given deltaT (in seconds).
+         */
+        float getCourantNumber(float deltaT);
+
+        /**
+         * Selects the numerical scheme that advanceSimulation uses (default EXPLICIT_SOLVER_TYPE):
+         *
+         * EXPLICIT_SOLVER_TYPE: explicit (leapfrog) scheme. Cheap per time step, but only stable for time steps up to getMaxStableDeltaT,
+         * which is proportional to the grid spacing, so the number of time steps per second of simulated time grows with the resolution.
+         *
+         * ADI_SOLVER_TYPE: implicit alternating-direction scheme, which solves tridiagonal systems along all rows and then along all columns.
+         * Several times as expensive per time step as the explicit scheme, but stable for any time step, so a single time step
+         * per frame is enough for any resolution. Large time steps slow down the short waves (numerical dispersion).
+         *
+         * SPECTRAL_SOLVER_TYPE: transforms the surface heights into cosine modes (which are independent for the reflecting edges of this surface),
+         * advances every mode exactly for any deltaT and transforms the modes back. This solves the same spatial discretization as the other
+         * solvers without any error in time, for O(n log n) operations per call to advanceSimulation for n vertices,
+         * also when advancing multiple time steps at once, so this is the fastest solver for large time steps and long runs.
+         * Like the other solvers this assumes that the previous time step had the same deltaT.
+         */
+        void setSolverType(int solverType);
+
+        /**
+         * Selects the implementation of the solver kernels for the given instruction set (see CpuFeatures.h).
+         * By default the widest instruction set that is supported by the processor is used.
+         * All implementations produce bitwise identical results, so this is only useful for testing and benchmarking.
+         * Returns false (and keeps the current implementation) if the given instruction set is not supported.
+         */
+        bool setInstructionSet(int instructionSet);
+
+        /**
+         * Sets the maximum number of time steps that advanceSimulation advances per cache-resident tile, see advanceSimulation.
+         * A temporalBlockSize of 1 disables temporal blocking. The results do not depend on the temporal block size.
+         */
+        void setTemporalBlockSize(int temporalBlockSize);
+
+        /**
+         * Sets whether advanceSimulation calculates the normal vectors and the surface gradients for all vertices (enabled by default).
+         * This can be disabled if the normal vectors are calculated elsewhere, e.g. on the graphics card, see getNormalVectors.
+         */
+        void setNormalVectorsEnabled(bool normalVectorsEnabled);
+
+        /**
+         * Sets whether the explicit solver only advances the tiles of the surface that are active (enabled by default), so that the cost
+         * of a time step is proportional to the disturbed area instead of the whole surface. The tiles are 32 x 32 vertices. Every 16 time steps
+         * the tiles in which all surface heights are smaller than 1 micrometer are flattened and become inactive, and inactive tiles
+         * become active if a neighbouring tile has larger surface heights in its half that faces them (waves travel at most one vertex per time step).
+         * Changing the surface heights otherwise, e.g. by changing the solver, makes all tiles active until the next time step.
+         * addGaussian only activates the tiles within the support of the gaussian function and their neighbours.
+         * The tiles are updated at the same time steps for any temporal block size and any grouping of the time steps into calls.
+         * The other solvers always advance the whole surface.
+         */
+        void setActiveTilesEnabled(bool activeTilesEnabled);
+
+        /**
+         * Returns the vertex z displacements relative to the vertex coordinates in model space, in row-major order.
+         * The array contains rowCount * rowPitch floats, the padding at the end of each row is always zero.
+         */
+        const float* getSurfaceHeightValues();
+
+        /**
+         * Returns the surface normal vectors (x, y, z) in model space for all vertices, in row-major order with the same row pitch as the surface heights,
+         * i.e. the array contains 3 * rowCount * rowPitch floats. The padding at the end of each row is always zero.
+         * The normal vectors (and surface gradients) are calculated in the same pass as the last time step of advanceSimulation,
+         * while the surface heights are still in the cache. They are only recalculated here if the surface heights were changed otherwise,
+         * or if this is disabled with setNormalVectorsEnabled.
+         */
+        const float* getNormalVectors();
+
+        /**
+         * Calculates the surface normal vectors for the current time step in the same layout as getNormalVectors, but writes them
+         * to the given memory, e.g. mapped graphics card memory. The padding values in the given memory are not changed.
+         * This also updates the surface gradients.
+         */
+        void calculateNormalVectors(float* normals);
 
         /**
          * Adds a 2D gaussian function with the given parameters to the surface height.
          * xCenter and yCenter are in model space.
+         * The gaussian function is truncated where it is smaller than 1 micrometer, so only the vertices within a few sigma of the center are changed.
+         * The gaussian functions are queued and applied together in one pass before the surface heights are used next, in parallel
+         * for bands of tile rows that only visit the gaussian functions overlapping them, so adding many gaussian functions per frame
+         * (e.g. one per floating object) costs time proportional to the number of vertices they change.
          */
         void addGaussian(float alpha, float xCenter, float yCenter, float sigmaX, float sigmaY);
 
@@ -89,9 +318,15 @@ class WaterSurface {
         void advanceSimulation(float deltaT);
 
         /**
-         * Draws this object to the current OpenGL context.
+         * Advances physics simulation of this surface by the given number of time steps of the given deltaT (in seconds) each.
+         * The results are bitwise identical to calling advanceSimulation(deltaT) stepCount times.
+         * For the explicit solver up to temporalBlockSize time steps are advanced per tile of the surface that fits in the processor cache
+         * before moving on to the next tile, so that the surface heights are streamed from and to main memory only once per temporal block
+         * instead of once per time step.
          */
-        void draw(mat4 viewMatrix, mat4 projectionMatrix, float lightPositionInWorldSpace[], float lightIntensity[], float ambientLightIntensity[]);
+        void advanceSimulation(float deltaT, int stepCount);
+
+        ~WaterSurface();
 };
 
 #endif
@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2018 A.C. Kockx, All Rights Reserved.
+ */
+
+#include "model/WaveEquationKernels.h"
+
+#include <emmintrin.h>
+
+#include "util/CpuFeatures.h"
+
+void advanceWaveEquationRowScalar(const float* current, const float* south, const float* north, const float* previous, float* next, int count, float cX, float cY) {
+    for (int i = 0; i < count; i++) {
+        float c = current[i];
+        float twoC = c + c;
+        float laplacianX = (current[i - 1] + current[i + 1]) - twoC;
+        float laplacianY = (south[i] + north[i]) - twoC;
+        next[i] = (twoC - previous[i]) + (cX * laplacianX + cY * laplacianY);
+    }
+}
+
+void advanceWaveEquationRowSse(const float* current, const float* south, const float* north, const float* previous, float* next, int count, float cX, float cY) {
+    const __m128 cXVector = _mm_set1_ps(cX);
+    const __m128 cYVector = _mm_set1_ps(cY);
+
+    //4 vertices at a time.
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 c = _mm_loadu_ps(current + i);
+        __m128 twoC = _mm_add_ps(c, c);
+        __m128 laplacianX = _mm_sub_ps(_mm_add_ps(_mm_loadu_ps(current + i - 1), _mm_loadu_ps(current + i + 1)), twoC);
+        __m128 laplacianY = _mm_sub_ps(_mm_add_ps(_mm_loadu_ps(south + i), _mm_loadu_ps(north + i)), twoC);
+        __m128 spatialTerms = _mm_add_ps(_mm_mul_ps(cXVector, laplacianX), _mm_mul_ps(cYVector, laplacianY));
+        _mm_storeu_ps(next + i, _mm_add_ps(_mm_sub_ps(twoC, _mm_loadu_ps(previous + i)), spatialTerms));
+    }
+
+    //remaining vertices.
+    advanceWaveEquationRowScalar(current + i, south + i, north + i, previous + i, next + i, count - i, cX, cY);
+}
+
+WaveEquationRowKernel getWaveEquationRowKernel(int instructionSet) {
+    switch (instructionSet) {
+        case AVX512_INSTRUCTION_SET:
+            return advanceWaveEquationRowAvx512;
+        case AVX2_INSTRUCTION_SET:
+            return advanceWaveEquationRowAvx2;
+        case SSE_INSTRUCTION_SET:
+            return advanceWaveEquationRowSse;
+        default:
+            return advanceWaveEquationRowScalar;
+    }
+}
@@ -0,0 +1,42 @@
+/*
+ * Copyright (c) 2018 A.C. Kockx, All Rights Reserved.
+ */
+
+#ifndef INCLUDED_WAVEEQUATIONKERNELS_H
+#define INCLUDED_WAVEEQUATIONKERNELS_H
+
+/**
+ * Kernel that advances count consecutive interior vertices of one grid row by one time step of the 2D second-order wave equation,
+ * using the explicit (leapfrog) finite-difference scheme with a 5-point stencil:
+ *
+ * next = (2 * current - previous) + (cX * (west + east - 2 * current) + cY * (south + north - 2 * current))
+ *
+ * with cX = (C * deltaT / dX)^2 and cY = (C * deltaT / dY)^2.
+ *
+ * current, south, north, previous and next point to the first vertex to calculate in the current row,
+ * the row below and above it (current time step), the same row at the previous time step and the same row at the next time step.
+ * current[-1] and current[count] are read as the western and eastern neighbours.
+ * next may point to the same memory as previous (the previous value of a vertex is only read before its next value is written),
+ * but must not overlap with current, south or north.
+ *
+ * All implementations perform exactly the same floating point operations in the same order without fused multiply-add,
+ * so all implementations produce bitwise identical results.
+ */
+typedef void (*WaveEquationRowKernel)(const float* current, const float* south, const float* north, const float* previous, float* next, int count, float cX, float cY);
+
+/**
+ * Implementations for the different instruction sets.
+ * The scalar implementation is the reference that the vectorized implementations can be compared to.
+ */
+void advanceWaveEquationRowScalar(const float* current, const float* south, const float* north, const float* previous, float* next, int count, float cX, float cY);
+void advanceWaveEquationRowSse(const float* current, const float* south, const float* north, const float* previous, float* next, int count, float cX, float cY);
+void advanceWaveEquationRowAvx2(const float* current, const float* south, const float* north, const float* previous, float* next, int count, float cX, float cY);
+void advanceWaveEquationRowAvx512(const float* current, const float* south, const float* north, const float* previous, float* next, int count, float cX, float cY);
+
+/**
+ * Returns the implementation for the given instruction set (see CpuFeatures.h).
+ * The caller is responsible for checking that the instruction set is supported.
+ */
+WaveEquationRowKernel getWaveEquationRowKernel(int instructionSet);
+
+#endif
@@ -0,0 +1,35 @@
+/*
+ * Copyright (c) 2018 A.C. Kockx, All Rights Reserved.
+ *
+ * AVX2 implementations of the kernels in WaveEquationKernels.h.
+ * The functions in this file must only be called if the processor supports AVX2 (see CpuFeatures.h).
+ */
+
+//GCC and Clang only allow AVX2 intrinsics in code that is compiled for AVX2. Do not enable FMA,
+//since fused multiply-add would change the rounding compared to the scalar reference implementation.
+#if defined(__GNUC__) && !defined(__AVX2__)
+#pragma GCC target("avx2")
+#endif
+
+#include "model/WaveEquationKernels.h"
+
+#include <immintrin.h>
+
+void advanceWaveEquationRowAvx2(const float* current, const float* south, const float* north, const float* previous, float* next, int count, float cX, float cY) {
+    const __m256 cXVector = _mm256_set1_ps(cX);
+    const __m256 cYVector = _mm256_set1_ps(cY);
+
+    //8 vertices at a time.
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 c = _mm256_loadu_ps(current + i);
+        __m256 twoC = _mm256_add_ps(c, c);
+        __m256 laplacianX = _mm256_sub_ps(_mm256_add_ps(_mm256_loadu_ps(current + i - 1), _mm256_loadu_ps(current + i + 1)), twoC);
+        __m256 laplacianY = _mm256_sub_ps(_mm256_add_ps(_mm256_loadu_ps(south + i), _mm256_loadu_ps(north + i)), twoC);
+        __m256 spatialTerms = _mm256_add_ps(_mm256_mul_ps(cXVector, laplacianX), _mm256_mul_ps(cYVector, laplacianY));
+        _mm256_storeu_ps(next + i, _mm256_add_ps(_mm256_sub_ps(twoC, _mm256_loadu_ps(previous + i)), spatialTerms));
+    }
+
+    //remaining vertices.
+    advanceWaveEquationRowSse(current + i, south + i, north + i, previous + i, next + i, count - i, cX, cY);
+}
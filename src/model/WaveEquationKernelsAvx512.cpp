@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2018 A.C. Kockx, All Rights Reserved.
+ *
+ * AVX-512 implementations of the kernels in WaveEquationKernels.h.
+ * The functions in this file must only be called if the processor supports AVX-512F (see CpuFeatures.h).
+ */
+
+//GCC and Clang only allow AVX-512 intrinsics in code that is compiled for AVX-512. AVX-512F implies FMA,
+//so also disable floating point contraction, since fused multiply-add would change the rounding compared to the scalar reference implementation.
+#if defined(__GNUC__)
+#if !defined(__AVX512F__)
+#pragma GCC target("avx512f")
+#endif
+#if !defined(__clang__)
+#pragma GCC optimize("fp-contract=off")
+#else
+#pragma clang fp contract(off)
+#endif
+#endif
+
+#include "model/WaveEquationKernels.h"
+
+#include <immintrin.h>
+
+void advanceWaveEquationRowAvx512(const float* current, const float* south, const float* north, const float* previous, float* next, int count, float cX, float cY) {
+    const __m512 cXVector = _mm512_set1_ps(cX);
+    const __m512 cYVector = _mm512_set1_ps(cY);
+
+    //16 vertices at a time, the remaining vertices are handled with a masked iteration.
+    for (int i = 0; i < count; i += 16) {
+        int remainingCount = count - i;
+        __mmask16 mask = remainingCount >= 16 ? (__mmask16) 0xFFFF : (__mmask16) ((1u << remainingCount) - 1);
+
+        __m512 c = _mm512_maskz_loadu_ps(mask, current + i);
+        __m512 twoC = _mm512_add_ps(c, c);
+        __m512 laplacianX = _mm512_sub_ps(_mm512_add_ps(_mm512_maskz_loadu_ps(mask, current + i - 1), _mm512_maskz_loadu_ps(mask, current + i + 1)), twoC);
+        __m512 laplacianY = _mm512_sub_ps(_mm512_add_ps(_mm512_maskz_loadu_ps(mask, south + i), _mm512_maskz_loadu_ps(mask, north + i)), twoC);
+        __m512 spatialTerms = _mm512_add_ps(_mm512_mul_ps(cXVector, laplacianX), _mm512_mul_ps(cYVector, laplacianY));
+        _mm512_mask_storeu_ps(next + i, mask, _mm512_add_ps(_mm512_sub_ps(twoC, _mm512_maskz_loadu_ps(mask, previous + i)), spatialTerms));
+    }
+}
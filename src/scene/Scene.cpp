@@ -8,23 +8,53 @@
 
 #include "util/OpenGLUtils.h"
 #include "model/BeachBall.h"
+#include "view/BeachBallView.h"
 
-static const float ALPHA = 0.02f;//wave height in m.
-static const float SIGMA_X = 0.1f;//wave spread in x direction.
-static const float SIGMA_Y = 0.1f;//wave spread in y direction.
+//if true, then the water surface is drawn with a continuous level of detail, see LevelOfDetailWaterSurfaceView.
+static const bool WATER_LEVEL_OF_DETAIL_ENABLED = true;
 
-static const float G = 9.80665f;//gravitational acceleration in m/s2.
-static const float DENSITY_OF_WATER = 997.0f;//density of water at 25 degrees Celsius in kg/m3.
-
-Scene::Scene() {
+Scene::Scene(Simulation* simulation) {
     //set clear color to black.
     glClearColor(0, 0, 0, 1);
     glEnable(GL_DEPTH_TEST);
+    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+    renderQueue = new RenderQueue();
+    uploadTimer = new GpuTimer("gpuUpload");
+    drawTimer = new GpuTimer("gpuDraw");
 
     //create geometry.
-    bounds = new SimulationBoundaries(-1, 1, -1, 1, 0, 1.5f);
-    waterSurface = new WaterSurface(2, 2, 0, 0, 0.5f);
-    objects.push_back(new BeachBall(0.1f, 0.25f, 0, 0, 1));
+    bounds = simulation->getBounds();
+    boundsView = new SimulationBoundariesView(bounds);
+    if (WATER_LEVEL_OF_DETAIL_ENABLED) {
+        waterSurfaceView = NULL;
+        levelOfDetailWaterSurfaceView = new LevelOfDetailWaterSurfaceView(simulation->getWaterSurface(), bounds);
+    } else {
+        waterSurfaceView = new WaterSurfaceView(simulation->getWaterSurface(), bounds, HEIGHT_TEXTURE_DISPLACEMENT_TYPE);
+        levelOfDetailWaterSurfaceView = NULL;
+    }
+    instancedShader = new InstancedPhongShader(0.9f, 15);
+    BeachBallView* beachBallView = NULL;
+    vector<ObjectInterface*>& objects = simulation->getObjects();
+    for (int n = 0; n < objects.size(); n++) {
+        ObjectInterface* object = objects[n];
+        BoundingBox box = object->getBoundingBox();
+        vec3 position = object->getPosition();
+        vec3 extent = max(abs(vec3(box.getMinX(), box.getMinY(), box.getMinZ()) - position), abs(vec3(box.getMaxX(), box.getMaxY(), box.getMaxZ()) - position));
+        objectBoundingRadii.push_back(length(extent));
+        switch (object->getObjectType()) {
+            case BEACH_BALL_OBJECT_TYPE:
+                if (beachBallView == NULL) {
+                    beachBallView = new BeachBallView(instancedShader);
+                    objectViews.push_back(beachBallView);
+                }
+                beachBallView->addObject(object, n);
+                break;
+            default:
+                fprintf(stderr, "Unknown object type: %i\n", object->getObjectType());
+                glfwTerminate();
+                exit(-1);
+        }
+    }
 
     //create camera.
     vec3 cameraPosition = vec3(0, -3, 1.5f);
@@ -41,27 +71,70 @@ Scene::Scene() {
 }
 
 Scene::~Scene() {
-    for (int n = 0; n < objects.size(); n++) {
-        delete objects[n];
+    for (int n = 0; n < objectViews.size(); n++) {
+        delete objectViews[n];
     }
-    delete waterSurface;
-    delete bounds;
+    delete instancedShader;
+    delete waterSurfaceView;
+    delete levelOfDetailWaterSurfaceView;
+    delete boundsView;
+    delete renderQueue;
+    delete uploadTimer;
+    delete drawTimer;
 }
 
-void Scene::render(int width, int height) {
+void Scene::render(const SimulationSnapshot* snapshot, int width, int height) {
+    ProfilerScope scope("render");
+
     //(re)initialize projection matrix.
     if (width <= 0) width = 1;//to avoid aspectRatio of zero.
     if (height <= 0) height = 1;//to avoid divide by zero.
     float aspectRatio = width / (float) height;
     mat4 projectionMatrix = perspective(radians(45.0f), aspectRatio, 0.1f, 100.0f);
 
+    uploadTimer->begin();
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
+    //camera and light are written once per frame and are shared by all shaders.
+    renderQueue->setSceneParameters(viewMatrix, projectionMatrix, lightPositionInWorldSpace, lightIntensity, ambientLightIntensity);
+
+    //find the objects in the view frustum. The bounding volume hierarchy is refit to the object positions of every snapshot.
+    ViewFrustum frustum(projectionMatrix * viewMatrix);
+    {
+        ProfilerScope cullScope("cullObjects");
+        objectBoxes.clear();
+        for (int n = 0; n < objectBoundingRadii.size(); n++) {
+            vec3 position = snapshot->getObjectPosition(n);
+            float radius = objectBoundingRadii[n];
+            objectBoxes.push_back(BoundingBox(position.x - radius, position.x + radius, position.y - radius, position.y + radius, position.z - radius, position.z + radius));
+        }
+        objectHierarchy.update(objectBoxes);
+        objectHierarchy.cull(frustum, objectVisibilities);
+    }
+
+    //submit the draw packets of the objects, this also sends their data to the graphics card.
+    {
+        ProfilerScope submitScope("submit");
+        if (frustum.intersects(bounds->getBoundingBox())) {
+            boundsView->submit(renderQueue);
+        }
+        if (levelOfDetailWaterSurfaceView != NULL) {
+            levelOfDetailWaterSurfaceView->submit(snapshot->getSurfaceHeightValues(), snapshot->getTileVersions(), snapshot->getSurfaceVersion(), viewMatrix, frustum, renderQueue);
+        } else {
+            waterSurfaceView->submit(snapshot->getSurfaceHeightValues(), snapshot->getNormalVectors(), snapshot->getTileVersions(), snapshot->getSurfaceVersion(), frustum, renderQueue);
+        }
+        for (int n = 0; n < objectViews.size(); n++) {
+            objectViews[n]->submit(snapshot, objectVisibilities, renderQueue);
+        }
+    }
+    uploadTimer->end();
+
     //draw objects.
-    bounds->draw(viewMatrix, projectionMatrix);
-    waterSurface->draw(viewMatrix, projectionMatrix, lightPositionInWorldSpace, lightIntensity, ambientLightIntensity);
-    for (int n = 0; n < objects.size(); n++) {
-        objects[n]->draw(viewMatrix, projectionMatrix, lightPositionInWorldSpace, lightIntensity, ambientLightIntensity);
+    {
+        ProfilerScope flushScope("flush");
+        drawTimer->begin();
+        renderQueue->flush();
+        drawTimer->end();
     }
 
     int error = glGetError();
@@ -71,103 +144,3 @@ void Scene::render(int width, int height) {
         exit(-1);
     }
 }
-
-void Scene::interact(int interactionType) {
-    float xSize = waterSurface->getXSize();
-    float ySize = waterSurface->getYSize();
-    switch (interactionType) {
-        case ADD_WAVE_IN_SOUTH_WEST_CORNER_INTERACTION_TYPE:
-            waterSurface->addGaussian(ALPHA, -0.25f*xSize, -0.25f*ySize, SIGMA_X, SIGMA_Y);
-            break;
-        case ADD_WAVE_IN_SOUTH_EAST_CORNER_INTERACTION_TYPE:
-            waterSurface->addGaussian(ALPHA, 0.25f*xSize, -0.25f*ySize, SIGMA_X, SIGMA_Y);
-            break;
-        case ADD_WAVE_IN_NORTH_WEST_CORNER_INTERACTION_TYPE:
-            waterSurface->addGaussian(ALPHA, -0.25f*xSize, 0.25f*ySize, SIGMA_X, SIGMA_Y);
-            break;
-        case ADD_WAVE_IN_NORTH_EAST_CORNER_INTERACTION_TYPE:
-            waterSurface->addGaussian(ALPHA, 0.25f*xSize, 0.25f*ySize, SIGMA_X, SIGMA_Y);
-            break;
-        default:
-            fprintf(stderr, "Unknown interaction type: %i\n", interactionType);
-            glfwTerminate();
-            exit(-1);
-    }
-}
-
-void Scene::advanceSimulation(float deltaT) {
-    //water surface.
-    waterSurface->advanceSimulation(deltaT);
-
-    //objects.
-    BoundingBox simulationBounds = bounds->getBoundingBox();
-    for (int n = 0; n < objects.size(); n++) {
-        ObjectInterface* object = objects[n];
-
-        //advance position to next time step.
-        vec3 position = object->getPosition();
-        vec3 velocity = object->getVelocity();
-        position += velocity * deltaT;
-        object->setPosition(position);
-
-        //update velocity.
-        //object bounces elastically at simulation boundaries.
-        BoundingBox objectBounds = object->getBoundingBox();
-        bool zBounce = false;
-        if (objectBounds.getMinX() <= simulationBounds.getMinX() && velocity[0] < 0) {
-            velocity[0] *= -1;
-        }
-        if (objectBounds.getMaxX() >= simulationBounds.getMaxX() && velocity[0] > 0) {
-            velocity[0] *= -1;
-        }
-        if (objectBounds.getMinY() <= simulationBounds.getMinY() && velocity[1] < 0) {
-            velocity[1] *= -1;
-        }
-        if (objectBounds.getMaxY() >= simulationBounds.getMaxY() && velocity[1] > 0) {
-            velocity[1] *= -1;
-        }
-        if (objectBounds.getMinZ() <= simulationBounds.getMinZ() && velocity[2] < 0) {
-            velocity[2] *= -1;
-            zBounce = true;
-        }
-        if (objectBounds.getMaxZ() >= simulationBounds.getMaxZ() && velocity[2] > 0) {
-            velocity[2] *= -1;
-            zBounce = true;
-        }
-
-        //apply gravity in negative z direction.
-        //To make sure that energy is conserved, do not apply gravity during a bounce against the ground or ceiling.
-        if (!zBounce) {//if object is not bouncing against the ground or ceiling at the moment.
-            velocity[2] += - G * deltaT;
-        }
-
-        //apply forces from water surface on object.
-        int vertexIndex = waterSurface->getIndexOfClosestVertex(position[0], position[1]);
-        if (vertexIndex != -1) {//if object is above or below water surface.
-            float waterSurfaceHeight = waterSurface->getSurfaceHeight(vertexIndex);
-            if (objectBounds.getMinZ() <= waterSurfaceHeight) {//if object is floating or submersed.
-                vec3 force = vec3(0);
-
-                //horizontal force proportional and opposite to gradient of water surface.
-                vec2 waterSurfaceGradient = waterSurface->getSurfaceGradient(vertexIndex);
-                const float gradientCouplingConstant = 0.1f;//arbitrary coupling constant in kg*m/s2.
-                force[0] = - gradientCouplingConstant * waterSurfaceGradient[0];
-                force[1] = - gradientCouplingConstant * waterSurfaceGradient[1];
-
-                //buoyancy.
-                float displacedVolume = object->getVolumeBelowZ(waterSurfaceHeight);
-                force[2] = displacedVolume * DENSITY_OF_WATER * G;
-
-                //apply force.
-                velocity += (force / object->getMass()) * deltaT;
-
-                //friction due to moving through water.
-                velocity[0] *= 0.99f;//arbitrary value.
-                velocity[1] *= 0.99f;//arbitrary value.
-                velocity[2] *= 0.5f;//arbitrary value.
-            }
-        }
-
-        object->setVelocity(velocity);
-    }
-}
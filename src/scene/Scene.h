@@ -3,29 +3,44 @@
  */
 
 #include "util/ModelUtils.h"
-#include "model/SimulationBoundaries.h"
-#include "model/ObjectInterface.h"
-#include "model/WaterSurface.h"
+#include "scene/Simulation.h"
+#include "scene/SimulationSnapshot.h"
+#include "view/SimulationBoundariesView.h"
+#include "view/WaterSurfaceView.h"
+#include "view/LevelOfDetailWaterSurfaceView.h"
+#include "view/ObjectViewInterface.h"
+#include "shader/InstancedPhongShader.h"
+#include "util/RenderQueue.h"
+#include "util/BoundingVolumeHierarchy.h"
+#include "util/GpuTimer.h"
 
 #ifndef INCLUDED_SCENE_H
 #define INCLUDED_SCENE_H
 
-enum {
-    ADD_WAVE_IN_SOUTH_WEST_CORNER_INTERACTION_TYPE,
-    ADD_WAVE_IN_SOUTH_EAST_CORNER_INTERACTION_TYPE,
-    ADD_WAVE_IN_NORTH_WEST_CORNER_INTERACTION_TYPE,
-    ADD_WAVE_IN_NORTH_EAST_CORNER_INTERACTION_TYPE
-};
-
 /**
- * Stores and renders a collection of objects. Also controls user interaction and interactions between objects.
+ * Renders the objects of a Simulation to the current OpenGL context.
+ * Only the objects and the parts of the water surface that are in the view frustum of the camera are drawn.
  */
 class Scene {
     private:
-        //objects.
-        SimulationBoundaries* bounds;
-        WaterSurface* waterSurface;
-        vector<ObjectInterface*> objects;
+        //views of the simulated objects.
+        SimulationBoundariesView* boundsView;
+        WaterSurfaceView* waterSurfaceView;//one triangle pair per grid cell, only used if the level of detail view is disabled.
+        LevelOfDetailWaterSurfaceView* levelOfDetailWaterSurfaceView;//number of triangles independent of the grid resolution.
+        vector<ObjectViewInterface*> objectViews;//one view per object type, each view draws all objects of its type at once.
+        InstancedPhongShader* instancedShader;//shared by the views that use instanced rendering.
+        RenderQueue* renderQueue;//the views submit their draw packets to this queue every frame.
+        SimulationBoundaries* bounds;//does not change during the simulation, so it can be read while the simulation runs.
+
+        //frustum culling of the objects.
+        vector<float> objectBoundingRadii;//per object: radius in m of a sphere around its position that contains the object in any orientation.
+        vector<BoundingBox> objectBoxes;//per object: bounding box in world space in the current frame.
+        BoundingVolumeHierarchy objectHierarchy;//over objectBoxes.
+        vector<bool> objectVisibilities;//per object: true if its bounding box intersects the view frustum in the current frame.
+
+        //profiling, measure how long the graphics card takes for the uploads and the draw calls of a frame.
+        GpuTimer* uploadTimer;
+        GpuTimer* drawTimer;
 
         //camera.
         mat4 viewMatrix;
@@ -38,22 +53,16 @@ class Scene {
         float ambientLightIntensity[3] = {0.2f, 0.3f, 0.4f};
 
     public:
-        Scene();
-
-        /**
-         * Performs the specified user interaction.
-         */
-        void interact(int interactionType);
-
         /**
-         * Advances physics simulation of objects in this scene by the given deltaT (in seconds).
+         * Creates views for all objects in the given simulation.
          */
-        void advanceSimulation(float deltaT);
+        Scene(Simulation* simulation);
 
         /**
-         * Renders all objects in this scene to the current OpenGL context.
+         * Renders all objects in this scene to the current OpenGL context, in the state of the given snapshot.
+         * The snapshot must have been captured from the simulation that was used to create this scene.
          */
-        void render(int width, int height);
+        void render(const SimulationSnapshot* snapshot, int width, int height);
 
         ~Scene();
 };
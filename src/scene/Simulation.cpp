@@ -0,0 +1,261 @@
+/*
+ * Copyright (c) 2018 A.C. Kockx, All Rights Reserved.
+ */
+
+#include "scene/Simulation.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#define _USE_MATH_DEFINES
+#include <math.h>
+
+#include "model/BeachBall.h"
+#include "util/CpuFeatures.h"
+#include "util/Profiler.h"
+
+static const float ALPHA = 0.02f;//wave height in m.
+static const float SIGMA_X = 0.1f;//wave spread in x direction.
+static const float SIGMA_Y = 0.1f;//wave spread in y direction.
+
+static const float G = 9.80665f;//gravitational acceleration in m/s2.
+static const float DENSITY_OF_WATER = 997.0f;//density of water at 25 degrees Celsius in kg/m3.
+
+//sigma of the gaussian function by which a body displaces the water surface as a fraction of the radius of its waterline,
+//so that almost all of the displaced volume is within the waterline. It is at least the grid spacing, so that the grid can resolve it.
+static const float WATER_DISPLACEMENT_SIGMA_FACTOR = 0.5f;
+
+//fraction of the largest stable time step of the water surface solver that is used at most,
+//to leave a margin for rounding errors and for the nonlinear effects of interactions.
+static const float CFL_SAFETY_FACTOR = 0.9f;
+
+Simulation::Simulation(int waterSurfaceRowCount, int waterSurfaceColumnCount, int threadCount) {
+    threadPool = new ThreadPool(threadCount);
+
+    //create objects.
+    bounds = new SimulationBoundaries(-1, 1, -1, 1, 0, 1.5f);
+    waterSurface = new WaterSurface(waterSurfaceRowCount, waterSurfaceColumnCount, 2, 2, 0, 0, 0.5f, threadPool);
+    sphereBodies = new BodyStore(SPHERE_SHAPE_TYPE);
+    sphereCollisions = new SphereCollisions(threadPool);
+    addBeachBall(0.1f, 0.25f, 0, 0, 1);
+
+    //use the fastest body kernels that this processor supports.
+    instructionSet = getBestSupportedInstructionSet();
+    bodyMotionKernel = getBodyMotionKernel(instructionSet);
+    sphereWaterForceKernel = getSphereWaterForceKernel(instructionSet);
+
+    waterDisplacementEnabled = true;
+
+    minimumWaterSurfaceSubstepCount = 1;
+    waterSurfaceSubstepCount = 1;
+    waterSurfaceCflMargin = 1;
+}
+
+Simulation::~Simulation() {
+    for (int n = 0; n < objects.size(); n++) {
+        delete objects[n];
+    }
+    delete sphereCollisions;
+    delete sphereBodies;
+    delete waterSurface;
+    delete bounds;
+    delete threadPool;
+}
+
+void Simulation::setMinimumWaterSurfaceSubstepCount(int minimumWaterSurfaceSubstepCount) {
+    this->minimumWaterSurfaceSubstepCount = std::max(1, minimumWaterSurfaceSubstepCount);
+}
+
+int Simulation::getWaterSurfaceSubstepCount() {
+    return waterSurfaceSubstepCount;
+}
+
+float Simulation::getWaterSurfaceCflMargin() {
+    return waterSurfaceCflMargin;
+}
+
+void Simulation::setInstructionSet(int instructionSet) {
+    this->instructionSet = instructionSet;
+    waterSurface->setInstructionSet(instructionSet);
+    bodyMotionKernel = getBodyMotionKernel(instructionSet);
+    sphereWaterForceKernel = getSphereWaterForceKernel(instructionSet);
+}
+
+int Simulation::getInstructionSet() {
+    return instructionSet;
+}
+
+void Simulation::setWaterDisplacementEnabled(bool waterDisplacementEnabled) {
+    this->waterDisplacementEnabled = waterDisplacementEnabled;
+}
+
+bool Simulation::isWaterDisplacementEnabled() {
+    return waterDisplacementEnabled;
+}
+
+SimulationBoundaries* Simulation::getBounds() {
+    return bounds;
+}
+
+WaterSurface* Simulation::getWaterSurface() {
+    return waterSurface;
+}
+
+vector<ObjectInterface*>& Simulation::getObjects() {
+    return objects;
+}
+
+BodyStore* Simulation::getSphereBodies() {
+    return sphereBodies;
+}
+
+SphereCollisions* Simulation::getSphereCollisions() {
+    return sphereCollisions;
+}
+
+ThreadPool* Simulation::getThreadPool() {
+    return threadPool;
+}
+
+void Simulation::addBeachBall(float mass, float radius, float x, float y, float z) {
+    objects.push_back(new BeachBall(sphereBodies, mass, radius, x, y, z));
+}
+
+void Simulation::interact(int interactionType) {
+    float xSize = waterSurface->getXSize();
+    float ySize = waterSurface->getYSize();
+    switch (interactionType) {
+        case ADD_WAVE_IN_SOUTH_WEST_CORNER_INTERACTION_TYPE:
+            waterSurface->addGaussian(ALPHA, -0.25f*xSize, -0.25f*ySize, SIGMA_X, SIGMA_Y);
+            break;
+        case ADD_WAVE_IN_SOUTH_EAST_CORNER_INTERACTION_TYPE:
+            waterSurface->addGaussian(ALPHA, 0.25f*xSize, -0.25f*ySize, SIGMA_X, SIGMA_Y);
+            break;
+        case ADD_WAVE_IN_NORTH_WEST_CORNER_INTERACTION_TYPE:
+            waterSurface->addGaussian(ALPHA, -0.25f*xSize, 0.25f*ySize, SIGMA_X, SIGMA_Y);
+            break;
+        case ADD_WAVE_IN_NORTH_EAST_CORNER_INTERACTION_TYPE:
+            waterSurface->addGaussian(ALPHA, 0.25f*xSize, 0.25f*ySize, SIGMA_X, SIGMA_Y);
+            break;
+        default:
+            fprintf(stderr, "Unknown interaction type: %i\n", interactionType);
+            exit(-1);
+    }
+}
+
+void Simulation::advanceSimulation(float deltaT) {
+    ProfilerScope scope("advanceSimulation");
+
+    //water surface.
+    //split deltaT into the smallest number of equal substeps for which the solver is stable (CFL condition for the explicit solver).
+    float maxStableDeltaT = CFL_SAFETY_FACTOR * waterSurface->getMaxStableDeltaT();
+    waterSurfaceSubstepCount = std::max(minimumWaterSurfaceSubstepCount, (int) ceil(deltaT / maxStableDeltaT));
+    waterSurfaceCflMargin = 1 - waterSurface->getCourantNumber(deltaT / waterSurfaceSubstepCount);
+    {
+        ProfilerScope waterSurfaceScope("advanceWaterSurface");
+        if (waterSurfaceSubstepCount == 1) {
+            waterSurface->advanceSimulation(deltaT);
+        } else {
+            waterSurface->advanceSimulation(deltaT / waterSurfaceSubstepCount, waterSurfaceSubstepCount);
+        }
+    }
+
+    //objects.
+    {
+        ProfilerScope sphereBodiesScope("advanceSphereBodies");
+        advanceSphereBodies(deltaT);
+    }
+
+    //objects push the water surface. This is applied before the next time step of the water surface.
+    if (waterDisplacementEnabled) {
+        ProfilerScope displaceScope("displaceWaterSurface");
+        displaceWaterSurface();
+    }
+}
+
+void Simulation::advanceSphereBodies(float deltaT) {
+    int bodyCount = sphereBodies->getBodyCount();
+    if (bodyCount == 0) {
+        return;
+    }
+    BoundingBox simulationBounds = bounds->getBoundingBox();
+    const float boundaries[6] = {simulationBounds.getMinX(), simulationBounds.getMaxX(), simulationBounds.getMinY(), simulationBounds.getMaxY(),
+            simulationBounds.getMinZ(), simulationBounds.getMaxZ()};
+    float* positionsX = sphereBodies->getPositionsX();
+    float* positionsY = sphereBodies->getPositionsY();
+    float* positionsZ = sphereBodies->getPositionsZ();
+    float* velocitiesX = sphereBodies->getVelocitiesX();
+    float* velocitiesY = sphereBodies->getVelocitiesY();
+    float* velocitiesZ = sphereBodies->getVelocitiesZ();
+    const float* masses = sphereBodies->getMasses();
+    const float* radii = sphereBodies->getRadii();
+    bodyWaterHeights.resize(bodyCount);
+    bodyWaterGradientsX.resize(bodyCount);
+    bodyWaterGradientsY.resize(bodyCount);
+    bodyWaterDisplacements.resize(4 * bodyCount, 0);
+    newBodyWaterDisplacements.resize(4 * bodyCount);
+    float waterSurfaceX = waterSurface->getX();
+    float waterSurfaceY = waterSurface->getY();
+    float minimumSigma = std::max(waterSurface->getXSize() / (waterSurface->getColumnCount() - 1), waterSurface->getYSize() / (waterSurface->getRowCount() - 1));
+
+    //advance positions to next time step, bounce elastically at simulation boundaries and apply gravity in negative z direction.
+    //In parallel for bands of bodies.
+    threadPool->parallelFor(0, bodyCount, [&](int beginBody, int endBody) {
+        bodyMotionKernel(positionsX + beginBody, positionsY + beginBody, positionsZ + beginBody, velocitiesX + beginBody, velocitiesY + beginBody, velocitiesZ + beginBody,
+                radii + beginBody, endBody - beginBody, boundaries, deltaT, G * deltaT);
+    });
+
+    //find the height and gradient of the water surface below every body.
+    waterSurface->sampleSurface(positionsX, positionsY, bodyCount, &bodyWaterHeights[0], &bodyWaterGradientsX[0], &bodyWaterGradientsY[0]);
+
+    threadPool->parallelFor(0, bodyCount, [&](int beginBody, int endBody) {
+        //apply forces from water surface on bodies.
+        sphereWaterForceKernel(positionsZ + beginBody, velocitiesX + beginBody, velocitiesY + beginBody, velocitiesZ + beginBody, radii + beginBody, masses + beginBody,
+                &bodyWaterHeights[beginBody], &bodyWaterGradientsX[beginBody], &bodyWaterGradientsY[beginBody], endBody - beginBody, deltaT, DENSITY_OF_WATER * G);
+
+        //find the displacement of the water surface by every body: a gaussian function below the body with the submerged volume of the body,
+        //which is spread over the waterline, or over the whole body if its center is below the water surface.
+        if (waterDisplacementEnabled) {
+            for (int body = beginBody; body < endBody; body++) {
+                float* displacement = &newBodyWaterDisplacements[4 * body];
+                float radius = radii[body];
+                float depth = bodyWaterHeights[body] - (positionsZ[body] - radius);
+                displacement[0] = positionsX[body] - waterSurfaceX;
+                displacement[1] = positionsY[body] - waterSurfaceY;
+                displacement[2] = 0;
+                displacement[3] = 0;
+                if (depth > 0) {//if body is in the water.
+                    float waterlineRadius = depth >= radius ? radius : sqrtf(depth * (radius + radius - depth));
+                    float sigma = std::max(minimumSigma, WATER_DISPLACEMENT_SIGMA_FACTOR * waterlineRadius);
+                    displacement[2] = -calculateSphereVolumeBelowZ(depth, radius) / (2 * (float) M_PI * sigma * sigma);
+                    displacement[3] = sigma;
+                }
+            }
+        }
+    });
+
+    //bodies bounce elastically against each other.
+    sphereCollisions->detectCollisions(sphereBodies, simulationBounds);
+    sphereCollisions->resolveCollisions(sphereBodies);
+}
+
+void Simulation::displaceWaterSurface() {
+    //replace the displacement of the previous time step by the displacement of the current time step for every body that moved.
+    //This only queues gaussian functions, which the water surface applies in one pass binned by tiles, see WaterSurface::addGaussian.
+    //The gaussian functions are queued in the order of the bodies, so the results do not depend on the number of threads.
+    int bodyCount = sphereBodies->getBodyCount();
+    for (int body = 0; body < bodyCount; body++) {
+        const float* displacement = &bodyWaterDisplacements[4 * body];
+        const float* newDisplacement = &newBodyWaterDisplacements[4 * body];
+        if (displacement[0] == newDisplacement[0] && displacement[1] == newDisplacement[1] && displacement[2] == newDisplacement[2]
+                && displacement[3] == newDisplacement[3]) {
+            continue;
+        }
+        if (displacement[2] != 0) {
+            waterSurface->addGaussian(-displacement[2], displacement[0], displacement[1], displacement[3], displacement[3]);
+        }
+        if (newDisplacement[2] != 0) {
+            waterSurface->addGaussian(newDisplacement[2], newDisplacement[0], newDisplacement[1], newDisplacement[3], newDisplacement[3]);
+        }
+    }
+    bodyWaterDisplacements.swap(newBodyWaterDisplacements);
+}
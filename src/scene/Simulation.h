@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2018 A.C. Kockx, All Rights Reserved.
+ */
+
+#include "util/ModelUtils.h"
+#include "util/ThreadPool.h"
+#include "model/SimulationBoundaries.h"
+#include "model/ObjectInterface.h"
+#include "model/BodyStore.h"
+#include "model/BodyKernels.h"
+#include "model/SphereCollisions.h"
+#include "model/WaterSurface.h"
+
+#ifndef INCLUDED_SIMULATION_H
+#define INCLUDED_SIMULATION_H
+
+enum {
+    ADD_WAVE_IN_SOUTH_WEST_CORNER_INTERACTION_TYPE,
+    ADD_WAVE_IN_SOUTH_EAST_CORNER_INTERACTION_TYPE,
+    ADD_WAVE_IN_NORTH_WEST_CORNER_INTERACTION_TYPE,
+    ADD_WAVE_IN_NORTH_EAST_CORNER_INTERACTION_TYPE
+};
+
+/**
+ * Stores the physical state of a collection of objects. Also controls user interaction and interactions between objects.
+ * This class does not depend on OpenGL, so that it can also run without a window or a graphics card, see Scene for rendering.
+ */
+class Simulation {
+    private:
+        ThreadPool* threadPool;
+
+        //objects.
+        SimulationBoundaries* bounds;
+        WaterSurface* waterSurface;
+        //the physical state of the objects is stored per shape type in body stores, the objects are views onto these.
+        BodyStore* sphereBodies;
+        vector<ObjectInterface*> objects;
+
+        //body solver.
+        int instructionSet;//see CpuFeatures.h.
+        BodyMotionKernel bodyMotionKernel;
+        SphereWaterForceKernel sphereWaterForceKernel;
+        //per body of sphereBodies: surface height (in world space) and gradient of the water surface below it in the current time step.
+        vector<float, AlignedAllocator<float, CACHE_LINE_SIZE>> bodyWaterHeights;
+        vector<float, AlignedAllocator<float, CACHE_LINE_SIZE>> bodyWaterGradientsX;
+        vector<float, AlignedAllocator<float, CACHE_LINE_SIZE>> bodyWaterGradientsY;
+        SphereCollisions* sphereCollisions;
+
+        //two-way coupling. Every body in the water displaces the water surface below it by a gaussian function with the volume of the
+        //submerged part of the body, only the changes of these displacements are added to the water surface in every time step.
+        bool waterDisplacementEnabled;
+        //per body of sphereBodies: x and y center (in model space of the water surface), amplitude and sigma of the gaussian function
+        //by which it displaces the water surface, the amplitude is zero if it does not displace the water surface.
+        vector<float> bodyWaterDisplacements;
+        vector<float> newBodyWaterDisplacements;//the same for the current time step.
+
+        //water surface time step control.
+        int minimumWaterSurfaceSubstepCount;
+        int waterSurfaceSubstepCount;//number of time steps of the water surface in the last time step of the simulation.
+        float waterSurfaceCflMargin;//1 minus the Courant number of the water surface time steps in the last time step of the simulation.
+
+        void advanceSphereBodies(float deltaT);
+        void displaceWaterSurface();
+
+    public:
+        /**
+         * Creates a simulation with a water surface that is discretized as a grid with the given number of rows and columns.
+         * The simulation uses the given number of threads, if threadCount is zero then one thread per hardware thread is used.
+         * The results do not depend on the number of threads.
+         */
+        Simulation(int waterSurfaceRowCount, int waterSurfaceColumnCount, int threadCount);
+
+        /**
+         * Adds a beach ball with the given mass and radius centered on the given coordinates (in world space), initially at rest.
+         */
+        void addBeachBall(float mass, float radius, float x, float y, float z);
+
+        /**
+         * Performs the specified user interaction.
+         */
+        void interact(int interactionType);
+
+        /**
+         * Advances physics simulation of objects in this simulation by the given deltaT (in seconds).
+         * All bodies with the same shape are advanced together with vectorized kernels, in parallel for bands of bodies.
+         * Bodies bounce elastically against the simulation boundaries and against each other, see SphereCollisions.
+         */
+        void advanceSimulation(float deltaT);
+
+        /**
+         * Sets the minimum number of equal time steps (substeps) that the water surface is advanced by per call to advanceSimulation (default 1).
+         * Smaller time steps make the water surface simulation more accurate, see also WaterSurface::setTemporalBlockSize.
+         * If needed for stability, more substeps are used, see getWaterSurfaceSubstepCount.
+         */
+        void setMinimumWaterSurfaceSubstepCount(int minimumWaterSurfaceSubstepCount);
+
+        /**
+         * Returns the number of substeps that the water surface was advanced by in the last call to advanceSimulation.
+         * This is the smallest number of substeps (but at least the minimum number of substeps) for which the water surface solver is stable
+         * with a safety margin, so it increases with the grid resolution.
+         */
+        int getWaterSurfaceSubstepCount();
+
+        /**
+         * Returns how far the substeps in the last call to advanceSimulation were from the stability limit of the water surface solver,
+         * as a fraction of the largest stable time step of the explicit solver. 0 means at the limit, negative means unstable
+         * for the explicit solver. The ADI solver is stable for any time step (see WaterSurface::setSolverType), so then this can be negative.
+         */
+        float getWaterSurfaceCflMargin();
+
+        /**
+         * Sets whether the bodies push the water surface (enabled by default). Every body in the water displaces the water below it
+         * by a gaussian function with the volume of its submerged part and the width of its waterline, so moving and bobbing bodies make waves.
+         * Only the vertices near the bodies are changed, so the cost is proportional to the total footprint of the bodies.
+         * If this is disabled, then the water surface only acts on the bodies.
+         */
+        void setWaterDisplacementEnabled(bool waterDisplacementEnabled);
+
+        /**
+         * Sets the instruction set of the kernels of the water surface and of the bodies (see CpuFeatures.h).
+         * By default the widest instruction set that the processor supports is used. The results do not depend on the instruction set.
+         * The caller is responsible for checking that the instruction set is supported.
+         */
+        void setInstructionSet(int instructionSet);
+
+        /**
+         * Getters.
+         */
+        int getInstructionSet();
+        bool isWaterDisplacementEnabled();
+        SimulationBoundaries* getBounds();
+        WaterSurface* getWaterSurface();
+        vector<ObjectInterface*>& getObjects();
+        BodyStore* getSphereBodies();
+        SphereCollisions* getSphereCollisions();
+        ThreadPool* getThreadPool();
+
+        ~Simulation();
+};
+
+#endif
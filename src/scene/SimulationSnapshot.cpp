@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2018 A.C. Kockx, All Rights Reserved.
+ */
+
+#include "scene/SimulationSnapshot.h"
+
+SimulationSnapshot::SimulationSnapshot() {
+    stepCount = 0;
+    surfaceVersion = 0;
+}
+
+void SimulationSnapshot::capture(Simulation* simulation, long long stepCount) {
+    this->stepCount = stepCount;
+
+    //water surface. Everything is copied the first time, after that only the tiles that changed since the previous capture.
+    WaterSurface* waterSurface = simulation->getWaterSurface();
+    int floatCount = waterSurface->getRowCount() * waterSurface->getRowPitch();
+    const float* heightValues = waterSurface->getSurfaceHeightValues();
+    const unsigned int* surfaceTileVersions = waterSurface->getTileVersions();
+    if (surfaceHeightValues.size() != floatCount) {
+        surfaceHeightValues.assign(heightValues, heightValues + floatCount);
+    } else {
+        waterSurface->copyChangedVertices(surfaceTileVersions, surfaceVersion, false, heightValues, &surfaceHeightValues[0]);
+    }
+    if (waterSurface->isNormalVectorsEnabled()) {
+        const float* normals = waterSurface->getNormalVectors();
+        if (normalVectors.size() != 3 * floatCount) {
+            normalVectors.assign(normals, normals + 3 * floatCount);
+        } else {
+            waterSurface->copyChangedVertices(surfaceTileVersions, surfaceVersion, true, normals, &normalVectors[0]);
+        }
+    } else {
+        normalVectors.clear();
+    }
+    surfaceVersion = waterSurface->getSurfaceVersion();
+    tileVersions.assign(surfaceTileVersions, surfaceTileVersions + waterSurface->getTileRowCount() * waterSurface->getTileColumnCount());
+
+    //objects.
+    vector<ObjectInterface*>& objects = simulation->getObjects();
+    objectPositions.resize(objects.size());
+    for (int n = 0; n < objects.size(); n++) {
+        objectPositions[n] = objects[n]->getPosition();
+    }
+}
+
+long long SimulationSnapshot::getStepCount() const {
+    return stepCount;
+}
+
+const float* SimulationSnapshot::getSurfaceHeightValues() const {
+    return &surfaceHeightValues[0];
+}
+
+const float* SimulationSnapshot::getNormalVectors() const {
+    return normalVectors.empty() ? NULL : &normalVectors[0];
+}
+
+unsigned int SimulationSnapshot::getSurfaceVersion() const {
+    return surfaceVersion;
+}
+
+const unsigned int* SimulationSnapshot::getTileVersions() const {
+    return &tileVersions[0];
+}
+
+int SimulationSnapshot::getObjectCount() const {
+    return (int) objectPositions.size();
+}
+
+vec3 SimulationSnapshot::getObjectPosition(int objectIndex) const {
+    return objectPositions[objectIndex];
+}
@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2018 A.C. Kockx, All Rights Reserved.
+ */
+
+#include "util/ModelUtils.h"
+#include "util/AlignedAllocator.h"
+#include "scene/Simulation.h"
+
+#ifndef INCLUDED_SIMULATIONSNAPSHOT_H
+#define INCLUDED_SIMULATIONSNAPSHOT_H
+
+/**
+ * Copy of the part of the state of a Simulation that is needed for rendering, at the end of one time step.
+ * Snapshots are captured by the simulation thread and read by the render thread, see SimulationThread.
+ * A snapshot is not changed while it is being read, so the render thread does not need to access the simulation itself.
+ */
+class SimulationSnapshot {
+    private:
+        long long stepCount;//number of time steps that the simulation had been advanced when this snapshot was captured.
+
+        //water surface, in the same layout as WaterSurface::getSurfaceHeightValues and WaterSurface::getNormalVectors.
+        vector<float, AlignedAllocator<float, CACHE_LINE_SIZE>> surfaceHeightValues;
+        vector<float, AlignedAllocator<float, CACHE_LINE_SIZE>> normalVectors;//empty if the water surface does not calculate normal vectors.
+        unsigned int surfaceVersion;//see WaterSurface::getSurfaceVersion, 0 if nothing has been captured yet.
+        vector<unsigned int> tileVersions;//see WaterSurface::getTileVersions.
+
+        //objects, in the same order as Simulation::getObjects.
+        vector<vec3> objectPositions;//in world space.
+
+    public:
+        SimulationSnapshot();
+
+        /**
+         * Copies the current state of the given simulation to this snapshot. Must be called on the thread that advances the simulation.
+         * This reuses the memory of this snapshot, so it does not allocate memory after the first time.
+         * Only the tiles of the water surface that changed since the previous capture of this snapshot are copied.
+         */
+        void capture(Simulation* simulation, long long stepCount);
+
+        /**
+         * Getters.
+         */
+        long long getStepCount() const;
+        const float* getSurfaceHeightValues() const;
+        const float* getNormalVectors() const;//returns NULL if the water surface does not calculate normal vectors.
+        unsigned int getSurfaceVersion() const;
+        const unsigned int* getTileVersions() const;
+        int getObjectCount() const;
+        vec3 getObjectPosition(int objectIndex) const;
+};
+
+#endif
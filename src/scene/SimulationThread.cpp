@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2018 A.C. Kockx, All Rights Reserved.
+ */
+
+#include "scene/SimulationThread.h"
+
+#include <chrono>
+
+#include "util/Profiler.h"
+
+using namespace std::chrono;
+
+//if the simulation falls behind by more than this number of time steps (e.g. because the process was suspended),
+//then it continues from the current time instead of trying to catch up.
+static const int MAX_STEPS_BEHIND = 5;
+
+SimulationThread::SimulationThread(Simulation* simulation, float deltaT) : stopping(false) {
+    this->simulation = simulation;
+    this->deltaT = deltaT;
+
+    //publish the initial state, so that there is always a snapshot to render.
+    snapshots.getBackBuffer()->capture(simulation, 0);
+    snapshots.publish();
+
+    simulationThread = thread(&SimulationThread::run, this);
+}
+
+SimulationThread::~SimulationThread() {
+    stopping.store(true);
+    simulationThread.join();
+}
+
+void SimulationThread::interact(int interactionType) {
+    interactions.push(interactionType);
+}
+
+const SimulationSnapshot* SimulationThread::getLatestSnapshot() {
+    return snapshots.getLatest();
+}
+
+void SimulationThread::run() {
+    duration<double> period = duration<double>(deltaT);
+    steady_clock::time_point nextStepTime = steady_clock::now();
+    long long stepCount = 0;
+    Profiler::setThreadName("simulation");
+    while (!stopping.load()) {
+        //perform the interactions that were requested since the previous time step.
+        int interactionType;
+        while (interactions.pop(interactionType)) {
+            simulation->interact(interactionType);
+        }
+
+        //update physics.
+        simulation->advanceSimulation(deltaT);
+        stepCount++;
+
+        //publish the new state.
+        {
+            ProfilerScope scope("captureSnapshot");
+            snapshots.getBackBuffer()->capture(simulation, stepCount);
+            snapshots.publish();
+        }
+
+        //sleep until the next time step is due.
+        nextStepTime += duration_cast<steady_clock::duration>(period);
+        steady_clock::time_point now = steady_clock::now();
+        if (now - nextStepTime > MAX_STEPS_BEHIND * period) {
+            nextStepTime = now;
+        }
+        this_thread::sleep_until(nextStepTime);
+    }
+}
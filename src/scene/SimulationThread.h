@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2018 A.C. Kockx, All Rights Reserved.
+ */
+
+#include <atomic>
+#include <thread>
+
+#include "util/TripleBuffer.h"
+#include "util/SpscQueue.h"
+#include "scene/Simulation.h"
+#include "scene/SimulationSnapshot.h"
+
+#ifndef INCLUDED_SIMULATIONTHREAD_H
+#define INCLUDED_SIMULATIONTHREAD_H
+
+/**
+ * Advances a Simulation at a fixed rate on its own thread, so that the costs of the physics and of rendering overlap instead of adding up.
+ * After every time step the simulation thread publishes a snapshot of the state that is needed for rendering.
+ * The render thread always gets the latest snapshot without waiting and forwards user interactions without waiting.
+ * While this thread is running, the simulation must not be accessed by other threads.
+ */
+class SimulationThread {
+    private:
+        static const int INTERACTION_QUEUE_CAPACITY = 64;
+
+        Simulation* simulation;
+        float deltaT;//in seconds.
+        TripleBuffer<SimulationSnapshot> snapshots;
+        SpscQueue<int, INTERACTION_QUEUE_CAPACITY> interactions;
+        atomic<bool> stopping;
+        thread simulationThread;
+
+        void run();
+
+    public:
+        /**
+         * Starts advancing the given simulation by the given deltaT (in seconds) every deltaT seconds (real time).
+         */
+        SimulationThread(Simulation* simulation, float deltaT);
+
+        /**
+         * Forwards the specified user interaction (see Simulation::interact) to the simulation thread, which performs it before the next time step.
+         * Does not wait. If the simulation thread has fallen so far behind that the queue is full, then the interaction is ignored.
+         */
+        void interact(int interactionType);
+
+        /**
+         * Returns the snapshot of the most recent time step. Does not wait.
+         * The returned snapshot remains valid and unchanged until the next call to this method.
+         */
+        const SimulationSnapshot* getLatestSnapshot();
+
+        /**
+         * Stops the simulation thread after the current time step.
+         */
+        ~SimulationThread();
+};
+
+#endif
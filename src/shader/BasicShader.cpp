@@ -14,10 +14,13 @@ BasicShader::BasicShader() {
     vector<const GLchar*> attributeNames = {VERTEX_POSITION, VERTEX_COLOR};
     shaderProgramId = createShaderProgram(vertexShaderSourceCode, fragmentShaderSourceCode, attributeNames);
 
-    modelViewProjectionMatrixUniformIndex = glGetUniformLocation(shaderProgramId, MODEL_VIEW_PROJECTION_MATRIX);
+    modelMatrixUniformIndex = glGetUniformLocation(shaderProgramId, MODEL_MATRIX);
 }
 
-void BasicShader::use(mat4 modelViewProjectionMatrix) {
-    glUseProgram(shaderProgramId);
-    glUniformMatrix4fv(modelViewProjectionMatrixUniformIndex, 1, GL_FALSE, &modelViewProjectionMatrix[0][0]);
+GLuint BasicShader::getShaderProgramId() {
+    return shaderProgramId;
+}
+
+void BasicShader::setModelMatrix(mat4 modelMatrix) {
+    glUniformMatrix4fv(modelMatrixUniformIndex, 1, GL_FALSE, &modelMatrix[0][0]);
 }
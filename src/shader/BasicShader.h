@@ -14,15 +14,18 @@
 class BasicShader {
     private:
         GLuint shaderProgramId;
-        GLuint modelViewProjectionMatrixUniformIndex;
+        GLint modelMatrixUniformIndex;
 
     public:
         BasicShader();
 
+        GLuint getShaderProgramId();
+
         /**
-         * Makes this shader "active" so that it will be used in subsequent drawing calls.
+         * Supply the model matrix of the object that is drawn next to the shader.
+         * This shader must be active, e.g. in DrawableInterface::draw (the camera and light are supplied by the RenderQueue).
          */
-        void use(mat4 modelViewProjectionMatrix);
+        void setModelMatrix(mat4 modelMatrix);
 };
 
 #endif
@@ -3,37 +3,58 @@
  */
 
 #include "shader/DisplacedZPhongShader.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
 #include "util/FileUtils.h"
 
-DisplacedZPhongShader::DisplacedZPhongShader(float specularReflectionCoefficient, float shininess) {
+DisplacedZPhongShader::DisplacedZPhongShader(float specularReflectionCoefficient, float shininess, int displacementType) {
+    this->displacementType = displacementType;
+
     //this code assumes that the shader files are located in a folder called "shaders" next to the bin folder.
     //The current working directory should be e.g. bin/x64/
-    string vertexShaderSourceCode = readFile("../../shaders/displaced_z_phong_vertex_shader.glsl");
+    string vertexShaderSourceCode;
+    switch (displacementType) {
+        case VERTEX_ATTRIBUTE_DISPLACEMENT_TYPE:
+            vertexShaderSourceCode = readFile("../../shaders/displaced_z_phong_vertex_shader.glsl");
+            break;
+        case HEIGHT_TEXTURE_DISPLACEMENT_TYPE:
+            vertexShaderSourceCode = readFile("../../shaders/height_texture_phong_vertex_shader.glsl");
+            break;
+        default:
+            fprintf(stderr, "Unknown displacement type: %i\n", displacementType);
+            glfwTerminate();
+            exit(-1);
+    }
     string fragmentShaderSourceCode = readFile("../../shaders/phong_fragment_shader.glsl");
 
+    //the height texture shader has no normal and z displacement attributes, but uses the same indices for the other attributes.
     vector<const GLchar*> attributeNames = {VERTEX_POSITION, VERTEX_NORMAL, VERTEX_COLOR, VERTEX_Z_DISPLACEMENT};
     shaderProgramId = createShaderProgram(vertexShaderSourceCode, fragmentShaderSourceCode, attributeNames);
 
-    modelViewMatrixUniformIndex = glGetUniformLocation(shaderProgramId, MODEL_VIEW_MATRIX);
-    modelViewProjectionMatrixUniformIndex = glGetUniformLocation(shaderProgramId, MODEL_VIEW_PROJECTION_MATRIX);
+    modelMatrixUniformIndex = glGetUniformLocation(shaderProgramId, MODEL_MATRIX);
 
     glUseProgram(shaderProgramId);
     glUniform1f(glGetUniformLocation(shaderProgramId, SPECULAR_REFLECTION_COEFFICIENT), specularReflectionCoefficient);
     glUniform1f(glGetUniformLocation(shaderProgramId, SHININESS), shininess);
+    if (displacementType == HEIGHT_TEXTURE_DISPLACEMENT_TYPE) {
+        //the height texture is bound to texture unit 0.
+        glUniform1i(glGetUniformLocation(shaderProgramId, HEIGHT_TEXTURE), 0);
+    }
 }
 
-void DisplacedZPhongShader::setLight(float lightPositionInWorldSpace[], float lightIntensity[], float ambientLightIntensity[], mat4 viewMatrix) {
-    vec4 lightPositionInWorldSpaceVector = vec4(lightPositionInWorldSpace[0], lightPositionInWorldSpace[1], lightPositionInWorldSpace[2], 1);
-    vec4 lightPositionInCameraSpace = viewMatrix * lightPositionInWorldSpaceVector;
-
+void DisplacedZPhongShader::setGrid(int rowCount, int columnCount, int rowPitch, float dX, float dY) {
     glUseProgram(shaderProgramId);
-    glUniform3fv(glGetUniformLocation(shaderProgramId, LIGHT_POSITION), 1, &lightPositionInCameraSpace[0]);
-    glUniform3fv(glGetUniformLocation(shaderProgramId, LIGHT_INTENSITY), 1, lightIntensity);
-    glUniform3fv(glGetUniformLocation(shaderProgramId, AMBIENT_LIGHT_INTENSITY), 1, ambientLightIntensity);
+    glUniform1i(glGetUniformLocation(shaderProgramId, ROW_PITCH), rowPitch);
+    glUniform2i(glGetUniformLocation(shaderProgramId, GRID_SIZE), columnCount, rowCount);
+    glUniform2f(glGetUniformLocation(shaderProgramId, GRID_SPACING), dX, dY);
 }
 
-void DisplacedZPhongShader::use(mat4 modelViewMatrix, mat4 modelViewProjectionMatrix) {
-    glUseProgram(shaderProgramId);
-    glUniformMatrix4fv(modelViewMatrixUniformIndex, 1, GL_FALSE, &modelViewMatrix[0][0]);
-    glUniformMatrix4fv(modelViewProjectionMatrixUniformIndex, 1, GL_FALSE, &modelViewProjectionMatrix[0][0]);
+GLuint DisplacedZPhongShader::getShaderProgramId() {
+    return shaderProgramId;
+}
+
+void DisplacedZPhongShader::setModelMatrix(mat4 modelMatrix) {
+    glUniformMatrix4fv(modelMatrixUniformIndex, 1, GL_FALSE, &modelMatrix[0][0]);
 }
@@ -8,29 +8,45 @@
 #ifndef INCLUDED_DISPLACEDZPHONGSHADER_H
 #define INCLUDED_DISPLACEDZPHONGSHADER_H
 
+enum {
+    //z displacements and normal vectors are supplied per vertex as vertex attributes.
+    VERTEX_ATTRIBUTE_DISPLACEMENT_TYPE,
+    //z displacements are read from a height texture and normal vectors are reconstructed from it in the vertex shader.
+    HEIGHT_TEXTURE_DISPLACEMENT_TYPE
+};
+
 /**
  * A shader that implements Phong shading, see https://en.wikipedia.org/wiki/Phong_shading
  * Allows displacement of z coordinate per vertex.
  * This can be used for example to change the shape of a horizontal fluid surface every frame.
+ *
+ * With VERTEX_ATTRIBUTE_DISPLACEMENT_TYPE the z displacements and normal vectors are vertex attributes.
+ * With HEIGHT_TEXTURE_DISPLACEMENT_TYPE the vertices must form a grid with vertex index row * rowPitch + column, see setGrid.
+ * The z displacements are then read from a single-channel float texture with one texel per vertex (bound to texture unit 0)
+ * and the normal vectors are calculated from the neighbouring texels, so no normal vector attribute is needed.
  */
 class DisplacedZPhongShader {
     private:
         GLuint shaderProgramId;
-        GLuint modelViewMatrixUniformIndex;
-        GLuint modelViewProjectionMatrixUniformIndex;
+        GLint modelMatrixUniformIndex;
+        int displacementType;
 
     public:
-        DisplacedZPhongShader(float specularReflectionCoefficient, float shininess);
+        DisplacedZPhongShader(float specularReflectionCoefficient, float shininess, int displacementType);
 
         /**
-         * Supply lighting information to the shader.
+         * Supply the layout of the vertex grid to the shader, only used with HEIGHT_TEXTURE_DISPLACEMENT_TYPE.
+         * dX and dY are the distances between adjacent columns and rows in model space.
          */
-        void setLight(float lightPositionInWorldSpace[], float lightIntensity[], float ambientLightIntensity[], mat4 viewMatrix);
+        void setGrid(int rowCount, int columnCount, int rowPitch, float dX, float dY);
+
+        GLuint getShaderProgramId();
 
         /**
-         * Makes this shader "active" so that it will be used in subsequent drawing calls.
+         * Supply the model matrix of the object that is drawn next to the shader.
+         * This shader must be active, e.g. in DrawableInterface::draw (the camera and light are supplied by the RenderQueue).
          */
-        void use(mat4 modelViewMatrix, mat4 modelViewProjectionMatrix);
+        void setModelMatrix(mat4 modelMatrix);
 };
 
 #endif
@@ -0,0 +1,24 @@
+/*
+ * Copyright (c) 2018 A.C. Kockx, All Rights Reserved.
+ */
+
+#include "shader/InstancedPhongShader.h"
+#include "util/FileUtils.h"
+
+InstancedPhongShader::InstancedPhongShader(float specularReflectionCoefficient, float shininess) {
+    //this code assumes that the shader files are located in a folder called "shaders" next to the bin folder.
+    //The current working directory should be e.g. bin/x64/
+    string vertexShaderSourceCode = readFile("../../shaders/instanced_phong_vertex_shader.glsl");
+    string fragmentShaderSourceCode = readFile("../../shaders/phong_fragment_shader.glsl");
+
+    vector<const GLchar*> attributeNames = {VERTEX_POSITION, VERTEX_NORMAL, VERTEX_COLOR, INSTANCE_TRANSFORM, INSTANCE_COLOR};
+    shaderProgramId = createShaderProgram(vertexShaderSourceCode, fragmentShaderSourceCode, attributeNames);
+
+    glUseProgram(shaderProgramId);
+    glUniform1f(glGetUniformLocation(shaderProgramId, SPECULAR_REFLECTION_COEFFICIENT), specularReflectionCoefficient);
+    glUniform1f(glGetUniformLocation(shaderProgramId, SHININESS), shininess);
+}
+
+GLuint InstancedPhongShader::getShaderProgramId() {
+    return shaderProgramId;
+}
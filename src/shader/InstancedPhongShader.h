@@ -0,0 +1,28 @@
+/*
+ * Copyright (c) 2018 A.C. Kockx, All Rights Reserved.
+ */
+
+#include "util/ModelUtils.h"
+#include "util/OpenGLUtils.h"
+
+#ifndef INCLUDED_INSTANCEDPHONGSHADER_H
+#define INCLUDED_INSTANCEDPHONGSHADER_H
+
+/**
+ * A shader that implements Phong shading (see https://en.wikipedia.org/wiki/Phong_shading) for many instances of the same mesh,
+ * that are drawn with a single instanced draw call, see InstancedMesh. Every instance has its own translation, uniform scale factor
+ * and color factor, which are supplied as per-instance vertex attributes (instanceTransform and instanceColor).
+ * A single shader can be shared by all instanced meshes. The instances are positioned in world space, so apart from the camera
+ * and light (supplied by the RenderQueue) this shader has no uniforms that change per frame.
+ */
+class InstancedPhongShader {
+    private:
+        GLuint shaderProgramId;
+
+    public:
+        InstancedPhongShader(float specularReflectionCoefficient, float shininess);
+
+        GLuint getShaderProgramId();
+};
+
+#endif
@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2018 A.C. Kockx, All Rights Reserved.
+ */
+
+#include "shader/LevelOfDetailPhongShader.h"
+#include "util/FileUtils.h"
+
+LevelOfDetailPhongShader::LevelOfDetailPhongShader(float specularReflectionCoefficient, float shininess, float diffuseColor[]) {
+    //this code assumes that the shader files are located in a folder called "shaders" next to the bin folder.
+    //The current working directory should be e.g. bin/x64/
+    string vertexShaderSourceCode = readFile("../../shaders/level_of_detail_phong_vertex_shader.glsl");
+    string fragmentShaderSourceCode = readFile("../../shaders/phong_fragment_shader.glsl");
+
+    vector<const GLchar*> attributeNames = {VERTEX_POSITION, PATCH_TRANSFORM};
+    shaderProgramId = createShaderProgram(vertexShaderSourceCode, fragmentShaderSourceCode, attributeNames);
+
+    modelMatrixUniformIndex = glGetUniformLocation(shaderProgramId, MODEL_MATRIX);
+
+    glUseProgram(shaderProgramId);
+    glUniform1f(glGetUniformLocation(shaderProgramId, SPECULAR_REFLECTION_COEFFICIENT), specularReflectionCoefficient);
+    glUniform1f(glGetUniformLocation(shaderProgramId, SHININESS), shininess);
+    glUniform3fv(glGetUniformLocation(shaderProgramId, DIFFUSE_COLOR), 1, diffuseColor);
+    //the height texture is bound to texture unit 0.
+    glUniform1i(glGetUniformLocation(shaderProgramId, HEIGHT_TEXTURE), 0);
+}
+
+void LevelOfDetailPhongShader::setGrid(int rowCount, int columnCount, float dX, float dY, float lodRange, float morphStartFraction) {
+    glUseProgram(shaderProgramId);
+    glUniform2i(glGetUniformLocation(shaderProgramId, GRID_SIZE), columnCount, rowCount);
+    glUniform2f(glGetUniformLocation(shaderProgramId, GRID_SPACING), dX, dY);
+    glUniform1f(glGetUniformLocation(shaderProgramId, LOD_RANGE), lodRange);
+    glUniform1f(glGetUniformLocation(shaderProgramId, MORPH_START_FRACTION), morphStartFraction);
+}
+
+GLuint LevelOfDetailPhongShader::getShaderProgramId() {
+    return shaderProgramId;
+}
+
+void LevelOfDetailPhongShader::setModelMatrix(mat4 modelMatrix) {
+    glUniformMatrix4fv(modelMatrixUniformIndex, 1, GL_FALSE, &modelMatrix[0][0]);
+}
@@ -0,0 +1,43 @@
+/*
+ * Copyright (c) 2018 A.C. Kockx, All Rights Reserved.
+ */
+
+#include "util/ModelUtils.h"
+#include "util/OpenGLUtils.h"
+
+#ifndef INCLUDED_LEVELOFDETAILPHONGSHADER_H
+#define INCLUDED_LEVELOFDETAILPHONGSHADER_H
+
+/**
+ * A shader that implements Phong shading (see https://en.wikipedia.org/wiki/Phong_shading) for a grid of surface heights
+ * that is drawn with patches of different levels of detail, see LevelOfDetailWaterSurfaceView.
+ * Every patch is an instance of the same vertex grid (vertexPosition is the column and row of a vertex within the patch)
+ * and has its own translation and scale within the grid of surface heights (patchTransform, a per-instance vertex attribute).
+ * The surface heights are read from a single-channel float texture with mipmaps (bound to texture unit 0)
+ * and the normal vectors are calculated from the surface heights at the resolution of each patch.
+ */
+class LevelOfDetailPhongShader {
+    private:
+        GLuint shaderProgramId;
+        GLint modelMatrixUniformIndex;
+
+    public:
+        LevelOfDetailPhongShader(float specularReflectionCoefficient, float shininess, float diffuseColor[]);
+
+        /**
+         * Supply the layout of the grid of surface heights to the shader. dX and dY are the distances between adjacent columns
+         * and rows in model space. lodRange is the distance from the camera at which the patches of level 0 are completely morphed
+         * into level 1, the range doubles per level. The morph starts at morphStartFraction of the distance between the ranges of two levels.
+         */
+        void setGrid(int rowCount, int columnCount, float dX, float dY, float lodRange, float morphStartFraction);
+
+        GLuint getShaderProgramId();
+
+        /**
+         * Supply the model matrix of the object that is drawn next to the shader.
+         * This shader must be active, e.g. in DrawableInterface::draw (the camera and light are supplied by the RenderQueue).
+         */
+        void setModelMatrix(mat4 modelMatrix);
+};
+
+#endif
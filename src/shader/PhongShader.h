@@ -14,21 +14,18 @@
 class PhongShader {
     private:
         GLuint shaderProgramId;
-        GLuint modelViewMatrixUniformIndex;
-        GLuint modelViewProjectionMatrixUniformIndex;
+        GLint modelMatrixUniformIndex;
 
     public:
         PhongShader(float specularReflectionCoefficient, float shininess);
 
-        /**
-         * Supply lighting information to the shader.
-         */
-        void setLight(float lightPositionInWorldSpace[], float lightIntensity[], float ambientLightIntensity[], mat4 viewMatrix);
+        GLuint getShaderProgramId();
 
         /**
-         * Makes this shader "active" so that it will be used in subsequent drawing calls.
+         * Supply the model matrix of the object that is drawn next to the shader.
+         * This shader must be active, e.g. in DrawableInterface::draw (the camera and light are supplied by the RenderQueue).
          */
-        void use(mat4 modelViewMatrix, mat4 modelViewProjectionMatrix);
+        void setModelMatrix(mat4 modelMatrix);
 };
 
 #endif
@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2018 A.C. Kockx, All Rights Reserved.
+ */
+
+#include <stddef.h>
+#include <new>
+#include <xmmintrin.h>
+
+#ifndef INCLUDED_ALIGNEDALLOCATOR_H
+#define INCLUDED_ALIGNEDALLOCATOR_H
+
+static const int CACHE_LINE_SIZE = 64;//in bytes.
+
+/**
+ * Allocator for standard containers that aligns the start of the allocated memory to the given alignment (in bytes).
+ * E.g. vector<float, AlignedAllocator<float, CACHE_LINE_SIZE>> stores its first element at the start of a cache line.
+ */
+template <typename T, size_t alignment>
+class AlignedAllocator {
+    public:
+        typedef T value_type;
+
+        template <typename U>
+        struct rebind {
+            typedef AlignedAllocator<U, alignment> other;
+        };
+
+        AlignedAllocator() {}
+
+        template <typename U>
+        AlignedAllocator(const AlignedAllocator<U, alignment>&) {}
+
+        T* allocate(size_t count) {
+            void* memory = _mm_malloc(count * sizeof(T), alignment);
+            if (memory == NULL) {
+                throw std::bad_alloc();
+            }
+            return (T*) memory;
+        }
+
+        void deallocate(T* memory, size_t) {
+            _mm_free(memory);
+        }
+
+        template <typename U>
+        bool operator==(const AlignedAllocator<U, alignment>&) const {
+            return true;
+        }
+
+        template <typename U>
+        bool operator!=(const AlignedAllocator<U, alignment>&) const {
+            return false;
+        }
+};
+
+#endif
@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2018 A.C. Kockx, All Rights Reserved.
+ */
+
+#include "util/BoundingVolumeHierarchy.h"
+
+#include <algorithm>
+
+//maximum number of boxes in a leaf node. Testing a few boxes one by one is cheaper than visiting more nodes.
+static const int MAX_LEAF_BOX_COUNT = 4;
+//the tree is rebuilt if the total surface area of its nodes has grown by more than this factor since the last build.
+static const float REBUILD_SURFACE_AREA_FACTOR = 2;
+
+BoundingVolumeHierarchy::BoundingVolumeHierarchy() {
+    builtSurfaceArea = 0;
+}
+
+int BoundingVolumeHierarchy::buildNode(int first, int last) {
+    int node = (int) nodeFirstBoxes.size();
+    nodeMinimums.push_back(vec3(0));
+    nodeMaximums.push_back(vec3(0));
+    nodeFirstBoxes.push_back(first);
+    nodeBoxCounts.push_back(last - first);
+    nodeSecondChildren.push_back(-1);
+    if (last - first <= MAX_LEAF_BOX_COUNT) {
+        return node;
+    }
+
+    //split along the axis along which the centers of the boxes are spread out the most.
+    vec3 centerMinimum = boxMinimums[first] + boxMaximums[first];
+    vec3 centerMaximum = centerMinimum;
+    for (int n = first + 1; n < last; n++) {
+        vec3 center = boxMinimums[n] + boxMaximums[n];//twice the center, which has the same order.
+        centerMinimum = min(centerMinimum, center);
+        centerMaximum = max(centerMaximum, center);
+    }
+    vec3 spread = centerMaximum - centerMinimum;
+    int axis = spread.x >= spread.y && spread.x >= spread.z ? 0 : spread.y >= spread.z ? 1 : 2;
+
+    //move the boxes with a center below the median to the first half.
+    int middle = (first + last) / 2;
+    vector<int> order(last - first);
+    for (int n = 0; n < order.size(); n++) {
+        order[n] = first + n;
+    }
+    std::nth_element(order.begin(), order.begin() + (middle - first), order.end(), [this, axis](int a, int b) {
+        return boxMinimums[a][axis] + boxMaximums[a][axis] < boxMinimums[b][axis] + boxMaximums[b][axis];
+    });
+    vector<int> indices(order.size());
+    vector<vec3> minimums(order.size());
+    vector<vec3> maximums(order.size());
+    for (int n = 0; n < order.size(); n++) {
+        indices[n] = boxIndices[order[n]];
+        minimums[n] = boxMinimums[order[n]];
+        maximums[n] = boxMaximums[order[n]];
+    }
+    std::copy(indices.begin(), indices.end(), boxIndices.begin() + first);
+    std::copy(minimums.begin(), minimums.end(), boxMinimums.begin() + first);
+    std::copy(maximums.begin(), maximums.end(), boxMaximums.begin() + first);
+
+    buildNode(first, middle);
+    nodeSecondChildren[node] = buildNode(middle, last);
+    return node;
+}
+
+float BoundingVolumeHierarchy::refit() {
+    //children come after their parent, so going backwards visits the children first.
+    float surfaceArea = 0;
+    for (int node = (int) nodeFirstBoxes.size() - 1; node >= 0; node--) {
+        vec3 minimum, maximum;
+        if (nodeSecondChildren[node] < 0) {
+            int first = nodeFirstBoxes[node];
+            minimum = boxMinimums[first];
+            maximum = boxMaximums[first];
+            for (int n = first + 1; n < first + nodeBoxCounts[node]; n++) {
+                minimum = min(minimum, boxMinimums[n]);
+                maximum = max(maximum, boxMaximums[n]);
+            }
+        } else {
+            int secondChild = nodeSecondChildren[node];
+            minimum = min(nodeMinimums[node + 1], nodeMinimums[secondChild]);
+            maximum = max(nodeMaximums[node + 1], nodeMaximums[secondChild]);
+        }
+        nodeMinimums[node] = minimum;
+        nodeMaximums[node] = maximum;
+        vec3 size = maximum - minimum;
+        surfaceArea += 2 * (size.x * size.y + size.y * size.z + size.z * size.x);
+    }
+    return surfaceArea;
+}
+
+void BoundingVolumeHierarchy::update(const vector<BoundingBox>& boxes) {
+    int boxCount = (int) boxes.size();
+    bool rebuild = boxCount != boxIndices.size();
+    if (!rebuild) {
+        for (int n = 0; n < boxCount; n++) {
+            BoundingBox box = boxes[boxIndices[n]];
+            boxMinimums[n] = vec3(box.getMinX(), box.getMinY(), box.getMinZ());
+            boxMaximums[n] = vec3(box.getMaxX(), box.getMaxY(), box.getMaxZ());
+        }
+        rebuild = refit() > REBUILD_SURFACE_AREA_FACTOR * builtSurfaceArea;
+    }
+
+    if (rebuild) {
+        boxIndices.resize(boxCount);
+        boxMinimums.resize(boxCount);
+        boxMaximums.resize(boxCount);
+        for (int n = 0; n < boxCount; n++) {
+            BoundingBox box = boxes[n];
+            boxIndices[n] = n;
+            boxMinimums[n] = vec3(box.getMinX(), box.getMinY(), box.getMinZ());
+            boxMaximums[n] = vec3(box.getMaxX(), box.getMaxY(), box.getMaxZ());
+        }
+        nodeMinimums.clear();
+        nodeMaximums.clear();
+        nodeFirstBoxes.clear();
+        nodeBoxCounts.clear();
+        nodeSecondChildren.clear();
+        if (boxCount > 0) {
+            buildNode(0, boxCount);
+        }
+        builtSurfaceArea = refit();
+    }
+}
+
+void BoundingVolumeHierarchy::cull(const ViewFrustum& frustum, vector<bool>& visibilities) {
+    visibilities.assign(boxIndices.size(), false);
+    if (nodeFirstBoxes.empty()) {
+        return;
+    }
+
+    //depth-first traversal that skips all nodes below a node that is outside of the frustum.
+    nodeStack.clear();
+    nodeStack.push_back(0);
+    while (!nodeStack.empty()) {
+        int node = nodeStack.back();
+        nodeStack.pop_back();
+        if (!frustum.intersects(nodeMinimums[node], nodeMaximums[node])) {
+            continue;
+        }
+        if (nodeSecondChildren[node] < 0) {
+            int first = nodeFirstBoxes[node];
+            for (int n = first; n < first + nodeBoxCounts[node]; n++) {
+                visibilities[boxIndices[n]] = frustum.intersects(boxMinimums[n], boxMaximums[n]);
+            }
+        } else {
+            nodeStack.push_back(nodeSecondChildren[node]);
+            nodeStack.push_back(node + 1);
+        }
+    }
+}
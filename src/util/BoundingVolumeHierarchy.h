@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2018 A.C. Kockx, All Rights Reserved.
+ */
+
+#include "util/ModelUtils.h"
+#include "util/BoundingBox.h"
+#include "util/ViewFrustum.h"
+
+#ifndef INCLUDED_BOUNDINGVOLUMEHIERARCHY_H
+#define INCLUDED_BOUNDINGVOLUMEHIERARCHY_H
+
+/**
+ * Binary tree of bounding boxes over a set of boxes that move, e.g. the bounding boxes of the objects of a scene,
+ * so that the boxes that intersect a view frustum can be found without testing every box.
+ *
+ * The tree is built by recursively splitting the boxes at the median of their centers along the longest axis.
+ * Every update, the bounds of the nodes are recalculated for the new boxes (refit) while the tree keeps its structure,
+ * which is much cheaper than building it. Since boxes that were close together can move apart, the nodes can grow
+ * over time, so the tree is rebuilt when the total surface area of the nodes has grown too much since the last build.
+ */
+class BoundingVolumeHierarchy {
+    private:
+        //boxes, in tree order: the boxes of a node are consecutive.
+        vector<int> boxIndices;//per position in tree order: index of the box in the boxes that were passed to update.
+        vector<vec3> boxMinimums;//in tree order.
+        vector<vec3> boxMaximums;//in tree order.
+
+        //nodes in depth-first order: the first child of an inner node directly follows it, so children always come after their parent.
+        vector<vec3> nodeMinimums;
+        vector<vec3> nodeMaximums;
+        vector<int> nodeFirstBoxes;//position of the first box of the node in tree order.
+        vector<int> nodeBoxCounts;
+        vector<int> nodeSecondChildren;//-1 for leaf nodes.
+
+        float builtSurfaceArea;//total surface area of the nodes directly after the last build.
+        vector<int> nodeStack;//reused by cull.
+
+        //appends the node for the boxes from tree position first up to last (exclusive) and its children, returns the index of the node.
+        int buildNode(int first, int last);
+
+        //recalculates the bounds of all nodes from the boxes and returns their total surface area.
+        float refit();
+
+    public:
+        BoundingVolumeHierarchy();
+
+        /**
+         * Updates this tree to the given boxes. The tree is rebuilt if the number of boxes changed or the nodes grew too much, see above.
+         */
+        void update(const vector<BoundingBox>& boxes);
+
+        /**
+         * Sets visibilities[n] to true if box n (as passed to the last call to update) intersects the given frustum and to false if not.
+         */
+        void cull(const ViewFrustum& frustum, vector<bool>& visibilities);
+};
+
+#endif
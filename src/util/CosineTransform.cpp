@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2018 A.C. Kockx, All Rights Reserved.
+ */
+
+#include "util/CosineTransform.h"
+
+#define _USE_MATH_DEFINES
+#include <math.h>
+
+CosineTransform::CosineTransform(int length) {
+    this->length = length;
+    fourierTransform = new FourierTransform(length);
+
+    twiddles.resize(2 * length);
+    for (int k = 0; k < length; k++) {
+        double angle = -M_PI * k / (2 * length);
+        twiddles[2 * k] = (float) cos(angle);
+        twiddles[2 * k + 1] = (float) sin(angle);
+    }
+}
+
+CosineTransform::~CosineTransform() {
+    delete fourierTransform;
+}
+
+int CosineTransform::getLength() {
+    return length;
+}
+
+int CosineTransform::getScratchSize() {
+    return 2 * length + fourierTransform->getScratchSize();
+}
+
+void CosineTransform::transform(float* values, float* scratch) {
+    //Makhoul's algorithm: reorder x into v with the even elements in increasing order followed by the odd elements in decreasing order.
+    //Then X[k] is the real part of exp(-pi i k / (2 * length)) * V[k], where V is the Fourier transform of v.
+    float* v = scratch;
+    float* fourierScratch = scratch + 2 * length;
+    for (int j = 0; 2 * j < length; j++) {
+        v[2 * j] = values[2 * j];
+        v[2 * j + 1] = 0;
+    }
+    for (int j = 0; 2 * j + 1 < length; j++) {
+        v[2 * (length - 1 - j)] = values[2 * j + 1];
+        v[2 * (length - 1 - j) + 1] = 0;
+    }
+
+    fourierTransform->transform(v, fourierScratch);
+
+    for (int k = 0; k < length; k++) {
+        values[k] = v[2 * k] * twiddles[2 * k] - v[2 * k + 1] * twiddles[2 * k + 1];
+    }
+}
+
+void CosineTransform::inverseTransform(float* values, float* scratch) {
+    //reverse the steps of transform. Since v is real, V[length - k] is the conjugate of V[k], which gives
+    //exp(-pi i k / (2 * length)) * V[k] = X[k] - i * X[length - k] (with X[length] = 0).
+    float* v = scratch;
+    float* fourierScratch = scratch + 2 * length;
+    for (int k = 0; k < length; k++) {
+        float re = values[k];
+        float im = k == 0 ? 0 : -values[length - k];
+        //multiply by the conjugate twiddle factor.
+        v[2 * k] = re * twiddles[2 * k] + im * twiddles[2 * k + 1];
+        v[2 * k + 1] = im * twiddles[2 * k] - re * twiddles[2 * k + 1];
+    }
+
+    fourierTransform->inverseTransform(v, fourierScratch);
+
+    float scale = 1.0f / length;
+    for (int j = 0; 2 * j < length; j++) {
+        values[2 * j] = v[2 * j] * scale;
+    }
+    for (int j = 0; 2 * j + 1 < length; j++) {
+        values[2 * j + 1] = v[2 * (length - 1 - j)] * scale;
+    }
+}
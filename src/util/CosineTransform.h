@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2018 A.C. Kockx, All Rights Reserved.
+ */
+
+#include <vector>
+
+#include "util/FourierTransform.h"
+
+using namespace std;
+
+#ifndef INCLUDED_COSINETRANSFORM_H
+#define INCLUDED_COSINETRANSFORM_H
+
+/**
+ * Plan for the discrete cosine transform (DCT-II) of real sequences with a fixed length and its inverse (DCT-III).
+ * The cosines are the eigenvectors of the second-order finite-difference approximation of the second derivative on a line
+ * with reflecting (zero-gradient) ends, so this transform decouples the wave equation on such a line into independent modes.
+ * The transform is calculated with a complex FFT of the same length (Makhoul's algorithm), see FourierTransform.
+ * A plan is read-only after it has been created, so it can be used by multiple threads at once (each with its own scratch memory).
+ */
+class CosineTransform {
+    private:
+        int length;
+        FourierTransform* fourierTransform;
+        vector<float> twiddles;//exp(-pi i k / (2 * length)) for k < length.
+
+    public:
+        /**
+         * Creates a plan for sequences with the given length (at least 1).
+         */
+        CosineTransform(int length);
+
+        /**
+         * Getters.
+         */
+        int getLength();
+
+        /**
+         * Returns the number of floats of scratch memory that transform and inverseTransform need.
+         */
+        int getScratchSize();
+
+        /**
+         * Replaces the given length real values x by their discrete cosine transform X[k] = sum over j of x[j] * cos(pi k (j + 1/2) / length).
+         * scratch must point to getScratchSize() floats of memory that does not overlap with values.
+         */
+        void transform(float* values, float* scratch);
+
+        /**
+         * Replaces the given length real values X by their inverse discrete cosine transform, i.e. inverseTransform(transform(x)) is x.
+         */
+        void inverseTransform(float* values, float* scratch);
+
+        ~CosineTransform();
+};
+
+#endif
@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2018 A.C. Kockx, All Rights Reserved.
+ */
+
+#include "util/CpuFeatures.h"
+
+#include <stddef.h>
+#include <string.h>
+#include <xmmintrin.h>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+
+static const char* INSTRUCTION_SET_NAMES[] = {"scalar", "sse", "avx2", "avx512"};
+
+//flush-to-zero (FTZ) and denormals-are-zero (DAZ) bits of the MXCSR register.
+static const unsigned int FLUSH_DENORMALS_TO_ZERO_FLAGS = 0x8040;
+
+static void cpuid(int function, int subfunction, unsigned int registers[4]) {
+#ifdef _MSC_VER
+    int info[4];
+    __cpuidex(info, function, subfunction);
+    for (int n = 0; n < 4; n++) {
+        registers[n] = (unsigned int) info[n];
+    }
+#else
+    __cpuid_count(function, subfunction, registers[0], registers[1], registers[2], registers[3]);
+#endif
+}
+
+static unsigned long long xgetbv(unsigned int index) {
+#ifdef _MSC_VER
+    return _xgetbv(index);
+#else
+    unsigned int eax, edx;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(index));
+    return ((unsigned long long) edx << 32) | eax;
+#endif
+}
+
+static int detectBestSupportedInstructionSet() {
+    unsigned int registers[4];//eax, ebx, ecx, edx.
+    cpuid(0, 0, registers);
+    unsigned int maxFunction = registers[0];
+    if (maxFunction < 1) {
+        return SCALAR_INSTRUCTION_SET;
+    }
+
+    cpuid(1, 0, registers);
+    bool sse2 = (registers[3] & (1 << 26)) != 0;
+    if (!sse2) {
+        return SCALAR_INSTRUCTION_SET;
+    }
+
+    //AVX registers can only be used if the operating system saves them on a context switch (OSXSAVE and XCR0 bits 1 and 2).
+    bool osxsave = (registers[2] & (1 << 27)) != 0;
+    bool avx = (registers[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || maxFunction < 7) {
+        return SSE_INSTRUCTION_SET;
+    }
+    unsigned long long xcr0 = xgetbv(0);
+    if ((xcr0 & 0x6) != 0x6) {
+        return SSE_INSTRUCTION_SET;
+    }
+
+    cpuid(7, 0, registers);
+    bool avx2 = (registers[1] & (1 << 5)) != 0;
+    if (!avx2) {
+        return SSE_INSTRUCTION_SET;
+    }
+
+    //AVX-512 additionally needs the opmask and upper zmm register state (XCR0 bits 5, 6 and 7).
+    bool avx512f = (registers[1] & (1 << 16)) != 0;
+    if (!avx512f || (xcr0 & 0xE6) != 0xE6) {
+        return AVX2_INSTRUCTION_SET;
+    }
+
+    return AVX512_INSTRUCTION_SET;
+}
+
+int getBestSupportedInstructionSet() {
+    static int bestSupportedInstructionSet = detectBestSupportedInstructionSet();
+    return bestSupportedInstructionSet;
+}
+
+bool isInstructionSetSupported(int instructionSet) {
+    return instructionSet >= SCALAR_INSTRUCTION_SET && instructionSet <= getBestSupportedInstructionSet();
+}
+
+const char* getInstructionSetName(int instructionSet) {
+    if (instructionSet < SCALAR_INSTRUCTION_SET || instructionSet > AVX512_INSTRUCTION_SET) {
+        return NULL;
+    }
+    return INSTRUCTION_SET_NAMES[instructionSet];
+}
+
+int getInstructionSetByName(const char* name) {
+    for (int instructionSet = SCALAR_INSTRUCTION_SET; instructionSet <= AVX512_INSTRUCTION_SET; instructionSet++) {
+        if (strcmp(name, INSTRUCTION_SET_NAMES[instructionSet]) == 0) {
+            return instructionSet;
+        }
+    }
+    return -1;
+}
+
+unsigned int enableFlushDenormalsToZero() {
+    unsigned int state = _mm_getcsr();
+    _mm_setcsr(state | FLUSH_DENORMALS_TO_ZERO_FLAGS);
+    return state;
+}
+
+void restoreFloatingPointControlState(unsigned int state) {
+    _mm_setcsr(state);
+}
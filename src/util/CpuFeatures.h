@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2018 A.C. Kockx, All Rights Reserved.
+ */
+
+#ifndef INCLUDED_CPUFEATURES_H
+#define INCLUDED_CPUFEATURES_H
+
+/**
+ * Instruction sets for which there are specialized implementations of the performance-critical kernels,
+ * in order of increasing vector width.
+ */
+enum {
+    SCALAR_INSTRUCTION_SET,
+    SSE_INSTRUCTION_SET,
+    AVX2_INSTRUCTION_SET,
+    AVX512_INSTRUCTION_SET
+};
+
+/**
+ * Returns true if the given instruction set is supported by both the processor and the operating system.
+ * Uses the CPUID instruction, the result is determined once and then cached.
+ */
+bool isInstructionSetSupported(int instructionSet);
+
+/**
+ * Returns the widest instruction set that is supported by both the processor and the operating system.
+ */
+int getBestSupportedInstructionSet();
+
+/**
+ * Returns the name of the given instruction set, e.g. "avx2".
+ * Returns NULL if the given instructionSet is unknown.
+ */
+const char* getInstructionSetName(int instructionSet);
+
+/**
+ * Returns the instruction set with the given name (see getInstructionSetName).
+ * Returns -1 if the given name is unknown.
+ */
+int getInstructionSetByName(const char* name);
+
+/**
+ * Makes the calling thread treat denormal floating point numbers (smaller than about 1e-38) as zero, both as inputs and as results.
+ * Arithmetic with denormal numbers is many times slower than with normal numbers, this avoids that for values that are negligible anyway.
+ * Returns the previous floating point control state of the calling thread, which can be restored with restoreFloatingPointControlState.
+ */
+unsigned int enableFlushDenormalsToZero();
+
+/**
+ * Restores the floating point control state of the calling thread that was returned by enableFlushDenormalsToZero.
+ */
+void restoreFloatingPointControlState(unsigned int state);
+
+#endif
@@ -0,0 +1,23 @@
+/*
+ * Copyright (c) 2018 A.C. Kockx, All Rights Reserved.
+ */
+
+#ifndef INCLUDED_DRAWABLEINTERFACE_H
+#define INCLUDED_DRAWABLEINTERFACE_H
+
+/**
+ * Interface for classes that issue draw calls for a draw packet that was submitted to a RenderQueue.
+ */
+class DrawableInterface {
+    public:
+        /**
+         * Issues the draw calls of this drawable. Called by RenderQueue::flush while the shader program, vertex array object
+         * and render state of the draw packet are active, so this only needs to set per-object uniforms (e.g. the model matrix)
+         * and bind per-object buffers.
+         */
+        virtual void draw() = 0;
+
+        virtual ~DrawableInterface() {}
+};
+
+#endif
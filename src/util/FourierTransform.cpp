@@ -0,0 +1,278 @@
+/*
+ * Copyright (c) 2018 A.C. Kockx, All Rights Reserved.
+ */
+
+#include "util/FourierTransform.h"
+
+#include <stddef.h>
+#include <string.h>
+#define _USE_MATH_DEFINES
+#include <math.h>
+
+//radices of the mixed-radix algorithm, in the order in which they are tried. Radix 4 comes first, since it needs the fewest operations per value.
+static const int RADICES[] = {4, 2, 3, 5, 7, 11, 13};
+static const int RADIX_COUNT = sizeof(RADICES) / sizeof(RADICES[0]);
+static const int MAX_RADIX = 13;
+
+//one stage of the mixed-radix algorithm for each kind of radix. The input of a butterfly is stride values apart and
+//its output is stageProduct values apart, so the innermost loops run over consecutive values.
+static void transformRadix4Stage(const float* input, float* output, const float* twiddles, int stride, int stageProduct) {
+    const float* twiddles1 = twiddles;
+    const float* twiddles2 = twiddles1 + 2 * stageProduct;
+    const float* twiddles3 = twiddles2 + 2 * stageProduct;
+    for (int jBase = 0; jBase < stride; jBase += stageProduct) {
+        const float* in0 = input + 2 * jBase;
+        const float* in1 = in0 + 2 * stride;
+        const float* in2 = in1 + 2 * stride;
+        const float* in3 = in2 + 2 * stride;
+        float* out0 = output + 2 * 4 * jBase;
+        float* out1 = out0 + 2 * stageProduct;
+        float* out2 = out1 + 2 * stageProduct;
+        float* out3 = out2 + 2 * stageProduct;
+        for (int j = 0; j < 2 * stageProduct; j += 2) {
+            //multiply by twiddle factors.
+            float x0Re = in0[j];
+            float x0Im = in0[j + 1];
+            float x1Re = in1[j] * twiddles1[j] - in1[j + 1] * twiddles1[j + 1];
+            float x1Im = in1[j] * twiddles1[j + 1] + in1[j + 1] * twiddles1[j];
+            float x2Re = in2[j] * twiddles2[j] - in2[j + 1] * twiddles2[j + 1];
+            float x2Im = in2[j] * twiddles2[j + 1] + in2[j + 1] * twiddles2[j];
+            float x3Re = in3[j] * twiddles3[j] - in3[j + 1] * twiddles3[j + 1];
+            float x3Im = in3[j] * twiddles3[j + 1] + in3[j + 1] * twiddles3[j];
+
+            //butterfly.
+            float aRe = x0Re + x2Re, aIm = x0Im + x2Im;
+            float bRe = x0Re - x2Re, bIm = x0Im - x2Im;
+            float cRe = x1Re + x3Re, cIm = x1Im + x3Im;
+            //(x1 - x3) multiplied by -i.
+            float dRe = x1Im - x3Im, dIm = x3Re - x1Re;
+            out0[j] = aRe + cRe;
+            out0[j + 1] = aIm + cIm;
+            out1[j] = bRe + dRe;
+            out1[j + 1] = bIm + dIm;
+            out2[j] = aRe - cRe;
+            out2[j + 1] = aIm - cIm;
+            out3[j] = bRe - dRe;
+            out3[j + 1] = bIm - dIm;
+        }
+    }
+}
+
+static void transformRadix2Stage(const float* input, float* output, const float* twiddles, int stride, int stageProduct) {
+    for (int jBase = 0; jBase < stride; jBase += stageProduct) {
+        const float* in0 = input + 2 * jBase;
+        const float* in1 = in0 + 2 * stride;
+        float* out0 = output + 2 * 2 * jBase;
+        float* out1 = out0 + 2 * stageProduct;
+        for (int j = 0; j < 2 * stageProduct; j += 2) {
+            float x1Re = in1[j] * twiddles[j] - in1[j + 1] * twiddles[j + 1];
+            float x1Im = in1[j] * twiddles[j + 1] + in1[j + 1] * twiddles[j];
+            out0[j] = in0[j] + x1Re;
+            out0[j + 1] = in0[j + 1] + x1Im;
+            out1[j] = in0[j] - x1Re;
+            out1[j + 1] = in0[j + 1] - x1Im;
+        }
+    }
+}
+
+static void transformGenericRadixStage(const float* input, float* output, const float* twiddles, const float* roots, int radix, int stride, int stageProduct) {
+    float v[2 * MAX_RADIX];
+    for (int jBase = 0; jBase < stride; jBase += stageProduct) {
+        for (int j = 0; j < stageProduct; j++) {
+            //load and multiply by twiddle factors.
+            const float* in = input + 2 * (jBase + j);
+            v[0] = in[0];
+            v[1] = in[1];
+            for (int q = 1; q < radix; q++) {
+                const float* twiddle = twiddles + 2 * ((q - 1) * stageProduct + j);
+                float re = in[2 * q * stride];
+                float im = in[2 * q * stride + 1];
+                v[2 * q] = re * twiddle[0] - im * twiddle[1];
+                v[2 * q + 1] = re * twiddle[1] + im * twiddle[0];
+            }
+
+            //butterfly, i.e. discrete Fourier transform of length radix.
+            float* out = output + 2 * (jBase * radix + j);
+            for (int p = 0; p < radix; p++) {
+                float re = 0;
+                float im = 0;
+                for (int q = 0; q < radix; q++) {
+                    const float* root = roots + 2 * ((p * q) % radix);
+                    re += v[2 * q] * root[0] - v[2 * q + 1] * root[1];
+                    im += v[2 * q] * root[1] + v[2 * q + 1] * root[0];
+                }
+                out[2 * p * stageProduct] = re;
+                out[2 * p * stageProduct + 1] = im;
+            }
+        }
+    }
+}
+
+FourierTransform::FourierTransform(int length) {
+    this->length = length;
+    convolutionTransform = NULL;
+
+    //factor the length into radices.
+    int remainingLength = length;
+    for (int n = 0; n < RADIX_COUNT; n++) {
+        while (remainingLength % RADICES[n] == 0) {
+            radices.push_back(RADICES[n]);
+            remainingLength /= RADICES[n];
+        }
+    }
+
+    if (remainingLength == 1) {//if mixed-radix.
+        //twiddle factors for every stage.
+        int stageProduct = 1;
+        for (int stage = 0; stage < radices.size(); stage++) {
+            int radix = radices[stage];
+            for (int q = 1; q < radix; q++) {
+                for (int j = 0; j < stageProduct; j++) {
+                    double angle = -2 * M_PI * j * q / (stageProduct * radix);
+                    stageTwiddles.push_back((float) cos(angle));
+                    stageTwiddles.push_back((float) sin(angle));
+                }
+            }
+            for (int q = 0; q < radix; q++) {
+                double angle = -2 * M_PI * q / radix;
+                radixRoots.push_back((float) cos(angle));
+                radixRoots.push_back((float) sin(angle));
+            }
+            stageProduct *= radix;
+        }
+
+    } else {//if Bluestein.
+        radices.clear();
+        //the convolution must be at least 2 * length - 1 long to avoid wrap-around.
+        int convolutionLength = 1;
+        while (convolutionLength < 2 * length - 1) {
+            convolutionLength *= 2;
+        }
+        convolutionTransform = new FourierTransform(convolutionLength);
+
+        chirp.resize(2 * length);
+        for (int k = 0; k < length; k++) {
+            //calculate k^2 modulo 2 * length in integers, since the angle is periodic and k^2 itself would lose precision.
+            long long kSquared = ((long long) k * k) % (2 * (long long) length);
+            double angle = -M_PI * kSquared / length;
+            chirp[2 * k] = (float) cos(angle);
+            chirp[2 * k + 1] = (float) sin(angle);
+        }
+
+        chirpSpectrum.assign(2 * convolutionLength, 0.0f);
+        for (int k = 0; k < length; k++) {
+            //conjugate chirp at k and -k.
+            chirpSpectrum[2 * k] = chirp[2 * k];
+            chirpSpectrum[2 * k + 1] = -chirp[2 * k + 1];
+            if (k > 0) {
+                chirpSpectrum[2 * (convolutionLength - k)] = chirp[2 * k];
+                chirpSpectrum[2 * (convolutionLength - k) + 1] = -chirp[2 * k + 1];
+            }
+        }
+        vector<float> scratch(convolutionTransform->getScratchSize());
+        convolutionTransform->transform(&chirpSpectrum[0], &scratch[0]);
+        //include the scaling of the inverse transform of the convolution.
+        for (int k = 0; k < 2 * convolutionLength; k++) {
+            chirpSpectrum[k] /= convolutionLength;
+        }
+    }
+}
+
+FourierTransform::~FourierTransform() {
+    delete convolutionTransform;
+}
+
+int FourierTransform::getLength() {
+    return length;
+}
+
+int FourierTransform::getScratchSize() {
+    if (convolutionTransform != NULL) {
+        int convolutionLength = convolutionTransform->getLength();
+        return 2 * convolutionLength + convolutionTransform->getScratchSize();
+    }
+    return 2 * length;
+}
+
+void FourierTransform::transform(float* values, float* scratch) {
+    if (convolutionTransform != NULL) {
+        transformBluestein(values, scratch);
+    } else {
+        transformMixedRadix(values, scratch);
+    }
+}
+
+void FourierTransform::inverseTransform(float* values, float* scratch) {
+    //the inverse transform is the conjugate of the transform of the conjugate.
+    for (int k = 0; k < length; k++) {
+        values[2 * k + 1] = -values[2 * k + 1];
+    }
+    transform(values, scratch);
+    for (int k = 0; k < length; k++) {
+        values[2 * k + 1] = -values[2 * k + 1];
+    }
+}
+
+void FourierTransform::transformMixedRadix(float* values, float* scratch) {
+    //Stockham algorithm: every stage reads all values from one buffer and writes them to the other buffer in a different order,
+    //such that the result ends up in natural order without a separate bit-reversal permutation.
+    //At a stage with radix r after stages with product s, the sub-transforms of length s are combined into sub-transforms of length s * r.
+    float* input = values;
+    float* output = scratch;
+    const float* twiddles = stageTwiddles.empty() ? NULL : &stageTwiddles[0];
+    const float* roots = radixRoots.empty() ? NULL : &radixRoots[0];
+    int stageProduct = 1;
+    for (int stage = 0; stage < radices.size(); stage++) {
+        int radix = radices[stage];
+        if (radix == 4) {
+            transformRadix4Stage(input, output, twiddles, length / radix, stageProduct);
+        } else if (radix == 2) {
+            transformRadix2Stage(input, output, twiddles, length / radix, stageProduct);
+        } else {
+            transformGenericRadixStage(input, output, twiddles, roots, radix, length / radix, stageProduct);
+        }
+
+        twiddles += 2 * (radix - 1) * stageProduct;
+        roots += 2 * radix;
+        stageProduct *= radix;
+        float* swap = input;
+        input = output;
+        output = swap;
+    }
+
+    //after an odd number of stages the result is in scratch.
+    if (input != values) {
+        memcpy(values, input, 2 * length * sizeof(float));
+    }
+}
+
+void FourierTransform::transformBluestein(float* values, float* scratch) {
+    //Bluestein's algorithm: since j * k = (j^2 + k^2 - (k - j)^2) / 2, the transform is X[k] = chirp[k] * sum over j of (chirp[j] * x[j]) * conj(chirp[k - j]),
+    //which is a convolution that is calculated by multiplying the transforms.
+    int convolutionLength = convolutionTransform->getLength();
+    float* a = scratch;
+    float* convolutionScratch = scratch + 2 * convolutionLength;
+    for (int k = 0; k < length; k++) {
+        float re = values[2 * k];
+        float im = values[2 * k + 1];
+        a[2 * k] = re * chirp[2 * k] - im * chirp[2 * k + 1];
+        a[2 * k + 1] = re * chirp[2 * k + 1] + im * chirp[2 * k];
+    }
+    memset(a + 2 * length, 0, 2 * (convolutionLength - length) * sizeof(float));
+
+    convolutionTransform->transform(a, convolutionScratch);
+    for (int k = 0; k < convolutionLength; k++) {
+        float re = a[2 * k];
+        float im = a[2 * k + 1];
+        a[2 * k] = re * chirpSpectrum[2 * k] - im * chirpSpectrum[2 * k + 1];
+        a[2 * k + 1] = re * chirpSpectrum[2 * k + 1] + im * chirpSpectrum[2 * k];
+    }
+    convolutionTransform->inverseTransform(a, convolutionScratch);
+
+    for (int k = 0; k < length; k++) {
+        float re = a[2 * k];
+        float im = a[2 * k + 1];
+        values[2 * k] = re * chirp[2 * k] - im * chirp[2 * k + 1];
+        values[2 * k + 1] = re * chirp[2 * k + 1] + im * chirp[2 * k];
+    }
+}
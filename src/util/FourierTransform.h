@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2018 A.C. Kockx, All Rights Reserved.
+ */
+
+#include <vector>
+
+using namespace std;
+
+#ifndef INCLUDED_FOURIERTRANSFORM_H
+#define INCLUDED_FOURIERTRANSFORM_H
+
+/**
+ * Plan for the discrete Fourier transform of complex sequences with a fixed length, using the fast Fourier transform (FFT).
+ * All twiddle factors are calculated once when the plan is created, so that one plan can be used to transform many sequences.
+ * Lengths whose prime factors are all small are transformed with a mixed-radix (2, 3, 4, 5, 7, 11, 13) Stockham algorithm.
+ * Other lengths are transformed with Bluestein's algorithm, which expresses the transform as a convolution
+ * that is calculated with a power-of-two FFT, so that the cost is O(n log n) for any length.
+ * A plan is read-only after it has been created, so it can be used by multiple threads at once (each with its own scratch memory).
+ * Complex values are stored as interleaved (real, imaginary) pairs of floats.
+ */
+class FourierTransform {
+    private:
+        int length;
+
+        //mixed-radix plan.
+        vector<int> radices;//one per stage.
+        vector<float> stageTwiddles;//per stage with radix r after stages with product s: exp(-2 pi i j q / (s r)) for 0 < q < r and j < s.
+        vector<float> radixRoots;//per stage: exp(-2 pi i q / r) for q < r, used for radices without a specialized butterfly.
+
+        //Bluestein plan, only used if the length has a prime factor that is larger than the largest radix.
+        FourierTransform* convolutionTransform;//power-of-two transform that is used for the convolution.
+        vector<float> chirp;//exp(-pi i k^2 / length) for k < length.
+        vector<float> chirpSpectrum;//transform of the conjugate chirp (wrapped around), divided by the convolution length.
+
+        void transformMixedRadix(float* values, float* scratch);
+        void transformBluestein(float* values, float* scratch);
+
+    public:
+        /**
+         * Creates a plan for sequences with the given length (at least 1).
+         */
+        FourierTransform(int length);
+
+        /**
+         * Getters.
+         */
+        int getLength();
+
+        /**
+         * Returns the number of floats of scratch memory that transform and inverseTransform need.
+         */
+        int getScratchSize();
+
+        /**
+         * Replaces the given length complex values x by their discrete Fourier transform X[k] = sum over j of x[j] * exp(-2 pi i j k / length).
+         * scratch must point to getScratchSize() floats of memory that does not overlap with values.
+         */
+        void transform(float* values, float* scratch);
+
+        /**
+         * Replaces the given length complex values X by their inverse discrete Fourier transform without scaling,
+         * i.e. x[j] = sum over k of X[k] * exp(2 pi i j k / length). inverseTransform(transform(x)) is length * x.
+         */
+        void inverseTransform(float* values, float* scratch);
+
+        ~FourierTransform();
+};
+
+#endif
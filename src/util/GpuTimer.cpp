@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2018 A.C. Kockx, All Rights Reserved.
+ */
+
+#include "util/GpuTimer.h"
+
+GpuTimer::GpuTimer(const char* name) {
+    this->name = name;
+    glGenQueries(QUERY_COUNT, queryIds);
+    for (int n = 0; n < QUERY_COUNT; n++) {
+        beginTimes[n] = -1;
+    }
+    queryIndex = 0;
+    active = false;
+}
+
+GpuTimer::~GpuTimer() {
+    glDeleteQueries(QUERY_COUNT, queryIds);
+}
+
+void GpuTimer::readResults() {
+    //the queries complete in the order in which they were issued, which starts after the query of the current frame.
+    for (int n = 0; n < QUERY_COUNT; n++) {
+        int index = (queryIndex + n) % QUERY_COUNT;
+        if (beginTimes[index] < 0) {
+            continue;
+        }
+        GLint available = 0;
+        glGetQueryObjectiv(queryIds[index], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) {
+            break;
+        }
+        GLuint64 elapsedTime = 0;//in ns.
+        glGetQueryObjectui64v(queryIds[index], GL_QUERY_RESULT, &elapsedTime);
+        Profiler::addGpuPhase(name, beginTimes[index], (long long) elapsedTime);
+        beginTimes[index] = -1;
+    }
+}
+
+void GpuTimer::begin() {
+    readResults();
+    //skip this frame if the graphics card is so far behind that the result of the oldest query is not available yet.
+    active = Profiler::isEnabled() && beginTimes[queryIndex] < 0;
+    if (active) {
+        beginTimes[queryIndex] = Profiler::getTime();
+        glBeginQuery(GL_TIME_ELAPSED, queryIds[queryIndex]);
+    }
+}
+
+void GpuTimer::end() {
+    if (active) {
+        glEndQuery(GL_TIME_ELAPSED);
+        queryIndex = (queryIndex + 1) % QUERY_COUNT;
+        active = false;
+    }
+}
@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2018 A.C. Kockx, All Rights Reserved.
+ */
+
+#include "util/OpenGLUtils.h"
+#include "util/Profiler.h"
+
+#ifndef INCLUDED_GPUTIMER_H
+#define INCLUDED_GPUTIMER_H
+
+/**
+ * Measures how long the graphics card takes to execute the commands of one phase of a frame (GL_TIME_ELAPSED query),
+ * if profiling is enabled, see Profiler. The result of a query is only read a few frames later, when it is available,
+ * so that the CPU never waits for the graphics card. OpenGL does not allow GL_TIME_ELAPSED queries to overlap,
+ * so the phases of different timers must not be nested.
+ *
+ * Usage per frame: call begin, issue the commands of the phase and call end, on the thread that calls Profiler::collect.
+ */
+class GpuTimer {
+    private:
+        static const int QUERY_COUNT = 4;//number of frames that a result may take to become available.
+
+        const char* name;
+        GLuint queryIds[QUERY_COUNT];
+        long long beginTimes[QUERY_COUNT];//per query: time (see Profiler::getTime) at which it began, -1 if it is not pending.
+        int queryIndex;//query of the current frame.
+        bool active;//true between begin and end if the current frame is measured.
+
+        //passes the results of the pending queries that are available to the profiler, oldest first.
+        void readResults();
+
+    public:
+        /**
+         * Creates a timer for the phase with the given name, which must be a string literal.
+         */
+        GpuTimer(const char* name);
+
+        ~GpuTimer();
+
+        /**
+         * Starts measuring the commands that are issued from now on.
+         * Does nothing if profiling is disabled or if all queries are still pending.
+         */
+        void begin();
+
+        /**
+         * Stops measuring.
+         */
+        void end();
+};
+
+#endif
@@ -4,6 +4,14 @@
 
 #include "util/ModelUtils.h"
 
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+
+const unsigned int PRIMITIVE_RESTART_INDEX = 0xFFFFFFFF;
+const int VERTEX_CACHE_SIZE = 16;
+static const unsigned short SHORT_PRIMITIVE_RESTART_INDEX = 0xFFFF;
+
 mat4 createModelMatrix(float x, float y, float z, float yawInDegrees, float pitchInDegrees, float rollInDegrees, float xScale, float yScale, float zScale) {
     //create scaling matrix.
     mat4 scalingMatrix = scale(mat4(1), vec3(xScale, yScale, zScale));
@@ -154,13 +162,13 @@ void createBeachBall(int horizontalLevelOfDetail, int verticalLevelOfDetail, vec
     }
 }
 
-void createHorizontal2DGrid(int rowCount, int columnCount, float xSize, float ySize, float color[], vector<float> &vertices, vector<float> &normals, vector<float> &colors) {
+void createHorizontal2DGrid(int rowCount, int columnCount, int rowPitch, float xSize, float ySize, float color[], vector<float> &vertices, vector<float> &normals, vector<float> &colors) {
     float x, y;
-    int vertexIndex = 0;
-    int normalIndex = 0;
-    int colorIndex = 0;
     for (int row = 0; row < rowCount; row++) {
         y = (row / (float) (rowCount - 1) - 0.5f) * ySize;
+        int vertexIndex = row * rowPitch * 3;
+        int normalIndex = vertexIndex;
+        int colorIndex = vertexIndex;
 
         for (int column = 0; column < columnCount; column++) {
             x = (column / (float) (columnCount - 1) - 0.5f) * xSize;
@@ -183,6 +191,110 @@ void createHorizontal2DGrid(int rowCount, int columnCount, float xSize, float yS
     }
 }
 
+static void addQuadIndices(int row, int column, int rowPitch, vector<unsigned int> &indices) {
+    unsigned int lowerLeftIndex = row * rowPitch + column;
+    unsigned int lowerRightIndex = lowerLeftIndex + 1;
+    unsigned int upperLeftIndex = lowerLeftIndex + rowPitch;
+    unsigned int upperRightIndex = upperLeftIndex + 1;
+
+    //triangle one.
+    indices.push_back(lowerLeftIndex);
+    indices.push_back(lowerRightIndex);
+    indices.push_back(upperLeftIndex);
+
+    //triangle two.
+    indices.push_back(upperLeftIndex);
+    indices.push_back(lowerRightIndex);
+    indices.push_back(upperRightIndex);
+}
+
+void createGridIndices(int firstRow, int firstColumn, int quadRowCount, int quadColumnCount, int rowPitch, int indexOrder, int vertexCacheSize, vector<unsigned int> &indices) {
+    switch (indexOrder) {
+        case ROW_MAJOR_INDEX_ORDER:
+            for (int row = firstRow; row < firstRow + quadRowCount; row++) {
+                for (int column = firstColumn; column < firstColumn + quadColumnCount; column++) {
+                    addQuadIndices(row, column, rowPitch, indices);
+                }
+            }
+            break;
+        case BLOCK_INDEX_ORDER: {
+            //a row of blockWidth quads inserts blockWidth + 1 new vertices (its top edge) into the cache, the first row of a block also its bottom edge.
+            //With a first-in-first-out cache, the vertices of the top edge of a row are then still in the cache when they are used as the bottom edge
+            //of the next row, as long as both edges fit in the cache.
+            int blockWidth = std::max(vertexCacheSize / 2 - 1, 1);
+            for (int blockColumn = firstColumn; blockColumn < firstColumn + quadColumnCount; blockColumn += blockWidth) {
+                int endColumn = std::min(blockColumn + blockWidth, firstColumn + quadColumnCount);
+                for (int row = firstRow; row < firstRow + quadRowCount; row++) {
+                    for (int column = blockColumn; column < endColumn; column++) {
+                        addQuadIndices(row, column, rowPitch, indices);
+                    }
+                }
+            }
+            break;
+        }
+        case ROW_STRIP_INDEX_ORDER:
+            for (int row = firstRow; row < firstRow + quadRowCount; row++) {
+                if (row > firstRow) {
+                    indices.push_back(PRIMITIVE_RESTART_INDEX);
+                }
+                //alternating between the top and the bottom edge of the row keeps all triangles counterclockwise.
+                for (int column = firstColumn; column <= firstColumn + quadColumnCount; column++) {
+                    indices.push_back((row + 1) * rowPitch + column);
+                    indices.push_back(row * rowPitch + column);
+                }
+            }
+            break;
+        default:
+            fprintf(stderr, "Unknown index order: %i\n", indexOrder);
+            exit(-1);
+    }
+}
+
+float getAverageCacheMissRatio(const vector<unsigned int> &indices, bool triangleStrips, int vertexCacheSize) {
+    unsigned int vertexCount = 0;
+    for (int n = 0; n < indices.size(); n++) {
+        if (indices[n] != PRIMITIVE_RESTART_INDEX) {
+            vertexCount = std::max(vertexCount, indices[n] + 1);
+        }
+    }
+
+    //hits do not change a first-in-first-out cache, so a vertex is in the cache if fewer than vertexCacheSize misses occurred since it was inserted.
+    vector<int> insertionMissCounts(vertexCount, -1);//per vertex: number of misses before it was last inserted, -1 if never.
+    int missCount = 0;
+    int triangleCount = 0;
+    int stripLength = 0;
+    for (int n = 0; n < indices.size(); n++) {
+        unsigned int index = indices[n];
+        if (index == PRIMITIVE_RESTART_INDEX) {
+            stripLength = 0;
+            continue;
+        }
+        int insertionMissCount = insertionMissCounts[index];
+        if (insertionMissCount < 0 || missCount - insertionMissCount >= vertexCacheSize) {
+            insertionMissCounts[index] = missCount;
+            missCount++;
+        }
+        stripLength++;
+        if (triangleStrips ? stripLength >= 3 : stripLength % 3 == 0) {
+            triangleCount++;
+        }
+    }
+    return triangleCount == 0 ? 0 : missCount / (float) triangleCount;
+}
+
+int getMaxShortIndexQuadRowCount(int columnCount, int rowPitch) {
+    //the largest index of quadRowCount rows is quadRowCount * rowPitch + columnCount - 1, 0xFFFF is reserved for primitive restart.
+    int quadRowCount = (SHORT_PRIMITIVE_RESTART_INDEX - 1 - (columnCount - 1)) / rowPitch;
+    return std::max(quadRowCount, 0);
+}
+
+void convertToShortIndices(const vector<unsigned int> &indices, vector<unsigned short> &shortIndices) {
+    shortIndices.resize(indices.size());
+    for (int n = 0; n < indices.size(); n++) {
+        shortIndices[n] = indices[n] == PRIMITIVE_RESTART_INDEX ? SHORT_PRIMITIVE_RESTART_INDEX : (unsigned short) indices[n];
+    }
+}
+
 float gaussian(float x, float y, float alpha, float xCenter, float yCenter, float sigmaX, float sigmaY) {
     return alpha * exp(-pow((x - xCenter) / sigmaX, 2) / 2 - pow((y - yCenter) / sigmaY, 2) / 2);
 }
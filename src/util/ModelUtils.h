@@ -11,6 +11,25 @@
 using namespace std;
 using namespace glm;
 
+#ifndef INCLUDED_MODELUTILS_H
+#define INCLUDED_MODELUTILS_H
+
+enum {
+    //two triangles per quad, quads in row-major order.
+    ROW_MAJOR_INDEX_ORDER,
+    //two triangles per quad, in vertical blocks of vertexCacheSize / 2 - 1 quads wide and row by row within a block,
+    //so that the vertices that a row shares with the previous row are still in the post-transform vertex cache.
+    BLOCK_INDEX_ORDER,
+    //one triangle strip per row of quads, separated by PRIMITIVE_RESTART_INDEX (draw with GL_TRIANGLE_STRIP and primitive restart enabled).
+    ROW_STRIP_INDEX_ORDER
+};
+
+//index that ends a triangle strip, see ROW_STRIP_INDEX_ORDER. Converted to 0xFFFF by convertToShortIndices.
+extern const unsigned int PRIMITIVE_RESTART_INDEX;
+//assumed number of vertices in the post-transform vertex cache of the graphics card, small enough for most graphics cards
+//and software renderers, see createGridIndices.
+extern const int VERTEX_CACHE_SIZE;
+
 /**
  * Creates and returns a model matrix, using the given position, orientation and scale of the model.
  *
@@ -40,10 +59,40 @@ void createBeachBall(int horizontalLevelOfDetail, int verticalLevelOfDetail, vec
 /**
  * Creates a horizontal 2D grid with the given size and color, centered on the origin in model space.
  * Vertices are spaced equidistantly and are arranged in row-major order, starting at (x, y) = (-0.5 * xSize, -0.5 * ySize).
+ * Consecutive rows start rowPitch vertices apart (rowPitch >= columnCount), the padding vertices at the end of each row are left unchanged.
+ */
+void createHorizontal2DGrid(int rowCount, int columnCount, int rowPitch, float xSize, float ySize, float color[], vector<float> &vertices, vector<float> &normals, vector<float> &colors);
+
+/**
+ * Appends the indices of the triangles of quadRowCount x quadColumnCount quads of a grid of vertices to the given indices,
+ * starting at the quad with the given row and column. The vertex with a given row and column has index row * rowPitch + column.
+ * All triangles are counterclockwise as seen from the positive z-axis (see createHorizontal2DGrid).
+ * indexOrder determines the order of the triangles, vertexCacheSize the (assumed) number of vertices in the post-transform vertex cache.
+ */
+void createGridIndices(int firstRow, int firstColumn, int quadRowCount, int quadColumnCount, int rowPitch, int indexOrder, int vertexCacheSize, vector<unsigned int> &indices);
+
+/**
+ * Returns the average cache miss ratio (ACMR) of the given triangle list (or triangle strips, separated by PRIMITIVE_RESTART_INDEX),
+ * i.e. the number of vertex shader invocations per triangle for a first-in-first-out post-transform vertex cache with the given size.
+ * This is 3 without any reuse, and approaches 0.5 for an optimal order of a large grid.
+ */
+float getAverageCacheMissRatio(const vector<unsigned int> &indices, bool triangleStrips, int vertexCacheSize);
+
+/**
+ * Returns the maximum number of rows of quads of a grid with the given number of columns and row pitch, for which the indices fit
+ * in 16 bits (see createGridIndices), so that a large grid can be drawn as bands of rows with 16-bit indices and a base vertex per band.
+ * Returns 0 if not even a single row fits.
  */
-void createHorizontal2DGrid(int rowCount, int columnCount, float xSize, float ySize, float color[], vector<float> &vertices, vector<float> &normals, vector<float> &colors);
+int getMaxShortIndexQuadRowCount(int columnCount, int rowPitch);
+
+/**
+ * Converts the given indices to 16 bits, all indices must be smaller than 0xFFFF (or PRIMITIVE_RESTART_INDEX).
+ */
+void convertToShortIndices(const vector<unsigned int> &indices, vector<unsigned short> &shortIndices);
 
 /**
  * Returns the value of a 2D gaussian function with the given parameters for the given x and y.
  */
 float gaussian(float x, float y, float alpha, float xCenter, float yCenter, float sigmaX, float sigmaY);
+
+#endif
@@ -6,18 +6,26 @@
 
 #include <stdlib.h>
 
-const GLchar* MODEL_VIEW_PROJECTION_MATRIX = "modelViewProjectionMatrix";
-const GLchar* MODEL_VIEW_MATRIX = "modelViewMatrix";
+const GLchar* SCENE_PARAMETERS = "SceneParameters";
+const GLuint SCENE_PARAMETERS_BINDING_POINT = 0;
+const GLchar* MODEL_MATRIX = "modelMatrix";
 const GLchar* VERTEX_POSITION = "vertexPosition";
 const GLchar* VERTEX_NORMAL = "vertexNormal";
 const GLchar* VERTEX_COLOR = "vertexColor";
 const GLchar* VERTEX_Z_DISPLACEMENT = "vertexZDisplacement";
-const GLchar* LIGHT_POSITION = "lightPosition";
-const GLchar* LIGHT_INTENSITY = "lightIntensity";
-const GLchar* AMBIENT_LIGHT_INTENSITY = "ambientLightIntensity";
+const GLchar* INSTANCE_TRANSFORM = "instanceTransform";
+const GLchar* INSTANCE_COLOR = "instanceColor";
+const GLchar* PATCH_TRANSFORM = "patchTransform";
 const GLchar* SPECULAR_REFLECTION_COEFFICIENT = "specularReflectionCoefficient";
 const GLchar* SHININESS = "shininess";
 const GLchar* FRAGMENT_COLOR = "fragmentColor";
+const GLchar* HEIGHT_TEXTURE = "heightTexture";
+const GLchar* ROW_PITCH = "rowPitch";
+const GLchar* GRID_SIZE = "gridSize";
+const GLchar* GRID_SPACING = "gridSpacing";
+const GLchar* LOD_RANGE = "lodRange";
+const GLchar* MORPH_START_FRACTION = "morphStartFraction";
+const GLchar* DIFFUSE_COLOR = "diffuseColor";
 
 GLFWwindow* createOpenGLWindow(int width, int height, const char* title) {
     //init GLFW.
@@ -82,6 +90,33 @@ GLuint createIndexBufferObject(int indexCount, unsigned int indices[]) {
     return indexBufferObjectId;
 }
 
+GLuint createIndexBufferObject(int indexCount, unsigned short indices[]) {
+    //the same as above.
+    GLuint indexBufferObjectId;
+    glGenBuffers(1, &indexBufferObjectId);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBufferObjectId);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCount * sizeof(unsigned short), indices, GL_STATIC_DRAW);
+
+    return indexBufferObjectId;
+}
+
+GLuint createFloatTexture(int width, int height, const float data[]) {
+    //create texture.
+    GLuint textureId;
+    glGenTextures(1, &textureId);
+    glBindTexture(GL_TEXTURE_2D, textureId);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+
+    //store texels in graphics card memory (single channel 32-bit float, available since OpenGL 3.0).
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, width, height, 0, GL_RED, GL_FLOAT, data);
+
+    return textureId;
+}
+
 GLuint createShaderProgram(string vertexShaderSourceCodeString, string fragmentShaderSourceCodeString, vector<const GLchar*> attributeNames) {
     const GLchar* vertexShaderSourceCode = vertexShaderSourceCodeString.c_str();
     const GLchar* fragmentShaderSourceCode = fragmentShaderSourceCodeString.c_str();
@@ -107,5 +142,11 @@ GLuint createShaderProgram(string vertexShaderSourceCodeString, string fragmentS
     glLinkProgram(programId);
     glValidateProgram(programId);
 
+    //let the uniform block with the camera and light read from the uniform buffer object of the scene (uniform blocks are available since OpenGL 3.1).
+    GLuint sceneParametersBlockIndex = glGetUniformBlockIndex(programId, SCENE_PARAMETERS);
+    if (sceneParametersBlockIndex != GL_INVALID_INDEX) {
+        glUniformBlockBinding(programId, sceneParametersBlockIndex, SCENE_PARAMETERS_BINDING_POINT);
+    }
+
     return programId;
 }
@@ -9,18 +9,26 @@
 
 using namespace std;
 
-extern const GLchar* MODEL_VIEW_PROJECTION_MATRIX;
-extern const GLchar* MODEL_VIEW_MATRIX;
+extern const GLchar* SCENE_PARAMETERS;
+extern const GLuint SCENE_PARAMETERS_BINDING_POINT;
+extern const GLchar* MODEL_MATRIX;
 extern const GLchar* VERTEX_POSITION;
 extern const GLchar* VERTEX_NORMAL;
 extern const GLchar* VERTEX_COLOR;
 extern const GLchar* VERTEX_Z_DISPLACEMENT;
-extern const GLchar* LIGHT_POSITION;
-extern const GLchar* LIGHT_INTENSITY;
-extern const GLchar* AMBIENT_LIGHT_INTENSITY;
+extern const GLchar* INSTANCE_TRANSFORM;
+extern const GLchar* INSTANCE_COLOR;
+extern const GLchar* PATCH_TRANSFORM;
 extern const GLchar* SPECULAR_REFLECTION_COEFFICIENT;
 extern const GLchar* SHININESS;
 extern const GLchar* FRAGMENT_COLOR;
+extern const GLchar* HEIGHT_TEXTURE;
+extern const GLchar* ROW_PITCH;
+extern const GLchar* GRID_SIZE;
+extern const GLchar* GRID_SPACING;
+extern const GLchar* LOD_RANGE;
+extern const GLchar* MORPH_START_FRACTION;
+extern const GLchar* DIFFUSE_COLOR;
 
 /**
  * Creates and shows a window with the given width, height (in pixels) and title that contains an OpenGL context.
@@ -39,7 +47,22 @@ GLuint createVertexBufferObject(GLuint attributeIndex, int vertexCount, int dime
  */
 GLuint createIndexBufferObject(int indexCount, unsigned int indices[]);
 
+/**
+ * Creates an index buffer object with the given 16-bit indices, for meshes with at most 65536 vertices.
+ * Returns id of created index buffer object.
+ */
+GLuint createIndexBufferObject(int indexCount, unsigned short indices[]);
+
+/**
+ * Creates a 2D texture with the given width and height (in texels) and the given data, that stores one float per texel.
+ * The texture is meant to be read with texelFetch, so it has no mipmaps and no filtering.
+ * Returns id of created texture.
+ */
+GLuint createFloatTexture(int width, int height, const float data[]);
+
 /**
  * Returns id of created shader program.
+ * If the shader program uses the SceneParameters uniform block, then the block is bound to SCENE_PARAMETERS_BINDING_POINT,
+ * so that all shader programs read the camera and light from the same uniform buffer object, see RenderQueue.
  */
 GLuint createShaderProgram(string vertexShaderSourceCode, string fragmentShaderSourceCode, vector<const GLchar*> attributeNames);
@@ -0,0 +1,220 @@
+/*
+ * Copyright (c) 2018 A.C. Kockx, All Rights Reserved.
+ */
+
+#include "util/Profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <math.h>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "util/SpscQueue.h"
+
+using namespace std::chrono;
+
+//number of scopes that a thread can measure between two calls to collect.
+static const int THREAD_QUEUE_CAPACITY = 4096;
+//thread index of the phases that were measured by the graphics card.
+static const int GPU_THREAD_INDEX = -1;
+
+/**
+ * A measured phase.
+ */
+class ProfilerEvent {
+    public:
+        const char* name;
+        long long beginTime;//in ns since the start of the program.
+        long long duration;//in ns.
+        int threadIndex;
+};
+
+/**
+ * The scopes that one thread measured and did not collect yet.
+ */
+class ProfilerThread {
+    public:
+        SpscQueue<ProfilerEvent, THREAD_QUEUE_CAPACITY> queue;
+        const char* name;//NULL if not set.
+        atomic<int> droppedEventCount;//number of scopes that did not fit in the queue.
+
+        ProfilerThread() : droppedEventCount(0) {
+            name = NULL;
+        }
+};
+
+/**
+ * The durations of the last ROLLING_SAMPLE_COUNT measurements of one phase.
+ */
+class PhaseStatistics {
+    public:
+        vector<float> durations;//in ms.
+        int nextIndex;//index in durations of the next measurement once it is full.
+        long long count;//number of measurements since profiling was enabled.
+
+        PhaseStatistics() {
+            nextIndex = 0;
+            count = 0;
+        }
+};
+
+atomic<bool> Profiler::enabled(false);
+
+static const steady_clock::time_point startTime = steady_clock::now();
+
+//threads that measured scopes, only added to. The threads are not deleted, so that the last scopes of a thread can still be collected after it ended.
+static mutex threadsMutex;
+static vector<ProfilerThread*> threads;
+static thread_local ProfilerThread* currentThread = NULL;
+
+//only accessed by the thread that calls collect.
+static map<string, PhaseStatistics> statistics;
+static vector<ProfilerEvent> traceEvents;//ring buffer once it has MAX_TRACE_EVENT_COUNT events.
+static int nextTraceEventIndex = 0;
+static long long droppedEventCount = 0;
+
+static ProfilerThread* getCurrentThread() {
+    if (currentThread == NULL) {
+        currentThread = new ProfilerThread();
+        lock_guard<mutex> lock(threadsMutex);
+        threads.push_back(currentThread);
+    }
+    return currentThread;
+}
+
+static void addEvent(const ProfilerEvent& event) {
+    PhaseStatistics& phaseStatistics = statistics[event.name];
+    float duration = event.duration * 1e-6f;
+    if (phaseStatistics.durations.size() < Profiler::ROLLING_SAMPLE_COUNT) {
+        phaseStatistics.durations.push_back(duration);
+    } else {
+        phaseStatistics.durations[phaseStatistics.nextIndex] = duration;
+        phaseStatistics.nextIndex = (phaseStatistics.nextIndex + 1) % Profiler::ROLLING_SAMPLE_COUNT;
+    }
+    phaseStatistics.count++;
+
+    if (traceEvents.size() < Profiler::MAX_TRACE_EVENT_COUNT) {
+        traceEvents.push_back(event);
+    } else {
+        traceEvents[nextTraceEventIndex] = event;
+        nextTraceEventIndex = (nextTraceEventIndex + 1) % Profiler::MAX_TRACE_EVENT_COUNT;
+    }
+}
+
+//returns the value below which the given fraction of the given values lie (nearest rank), the values must be sorted.
+static float getPercentile(const vector<float>& sortedValues, float fraction) {
+    int index = (int) ceil(fraction * sortedValues.size()) - 1;
+    return sortedValues[std::min(std::max(index, 0), (int) sortedValues.size() - 1)];
+}
+
+void Profiler::setEnabled(bool enabled) {
+    if (enabled && !isEnabled()) {
+        collect();//discard the scopes that were still measured while enabled the previous time.
+        statistics.clear();
+        traceEvents.clear();
+        nextTraceEventIndex = 0;
+        droppedEventCount = 0;
+    }
+    Profiler::enabled.store(enabled, memory_order_relaxed);
+}
+
+void Profiler::setThreadName(const char* name) {
+    ProfilerThread* thread = getCurrentThread();
+    lock_guard<mutex> lock(threadsMutex);
+    thread->name = name;
+}
+
+long long Profiler::getTime() {
+    return duration_cast<nanoseconds>(steady_clock::now() - startTime).count();
+}
+
+long long Profiler::beginScope() {
+    //register the thread before the measurement starts, so that this is not part of the measurement.
+    getCurrentThread();
+    return getTime();
+}
+
+void Profiler::endScope(const char* name, long long beginTime) {
+    ProfilerEvent event;
+    event.name = name;
+    event.beginTime = beginTime;
+    event.duration = getTime() - beginTime;
+    ProfilerThread* thread = getCurrentThread();
+    if (!thread->queue.push(event)) {
+        thread->droppedEventCount.fetch_add(1, memory_order_relaxed);
+    }
+}
+
+void Profiler::addGpuPhase(const char* name, long long beginTime, long long duration) {
+    ProfilerEvent event;
+    event.name = name;
+    event.beginTime = beginTime;
+    event.duration = duration;
+    event.threadIndex = GPU_THREAD_INDEX;
+    addEvent(event);
+}
+
+void Profiler::collect() {
+    vector<ProfilerThread*> currentThreads;
+    {
+        lock_guard<mutex> lock(threadsMutex);
+        currentThreads = threads;
+    }
+    for (int n = 0; n < currentThreads.size(); n++) {
+        ProfilerEvent event;
+        while (currentThreads[n]->queue.pop(event)) {
+            event.threadIndex = n;
+            addEvent(event);
+        }
+        droppedEventCount += currentThreads[n]->droppedEventCount.exchange(0, memory_order_relaxed);
+    }
+}
+
+void Profiler::printStatistics(FILE* file) {
+    for (map<string, PhaseStatistics>::iterator iterator = statistics.begin(); iterator != statistics.end(); iterator++) {
+        vector<float> sortedDurations = iterator->second.durations;
+        std::sort(sortedDurations.begin(), sortedDurations.end());
+        fprintf(file, "%-24s count = %-8lli p50 = %8.3f ms  p99 = %8.3f ms\n", iterator->first.c_str(), iterator->second.count,
+                getPercentile(sortedDurations, 0.5f), getPercentile(sortedDurations, 0.99f));
+    }
+    if (droppedEventCount > 0) {
+        fprintf(file, "Dropped scopes = %lli (collect was not called often enough)\n", droppedEventCount);
+    }
+}
+
+bool Profiler::writeChromeTrace(const char* fileName) {
+    FILE* file = fopen(fileName, "w");
+    if (file == NULL) {
+        return false;
+    }
+
+    //the phases of the graphics card are shown as an extra thread after the real threads.
+    vector<const char*> threadNames;
+    {
+        lock_guard<mutex> lock(threadsMutex);
+        for (int n = 0; n < threads.size(); n++) {
+            threadNames.push_back(threads[n]->name);
+        }
+    }
+    int gpuThreadId = (int) threadNames.size();
+    fprintf(file, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+    for (int n = 0; n < threadNames.size(); n++) {
+        if (threadNames[n] != NULL) {
+            fprintf(file, "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %i, \"args\": {\"name\": \"%s\"}},\n", n, threadNames[n]);
+        }
+    }
+    fprintf(file, "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %i, \"args\": {\"name\": \"gpu\"}}", gpuThreadId);
+
+    //complete events with begin time and duration in microseconds, oldest first.
+    for (int n = 0; n < traceEvents.size(); n++) {
+        const ProfilerEvent& event = traceEvents[(nextTraceEventIndex + n) % traceEvents.size()];
+        int threadId = event.threadIndex == GPU_THREAD_INDEX ? gpuThreadId : event.threadIndex;
+        fprintf(file, ",\n{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %i, \"ts\": %.3f, \"dur\": %.3f}",
+                event.name, threadId, event.beginTime * 1e-3, event.duration * 1e-3);
+    }
+    fprintf(file, "\n]}\n");
+    return fclose(file) == 0;
+}
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2018 A.C. Kockx, All Rights Reserved.
+ */
+
+#include <atomic>
+#include <stdio.h>
+
+using namespace std;
+
+#ifndef INCLUDED_PROFILER_H
+#define INCLUDED_PROFILER_H
+
+/**
+ * Measures how long the phases of a frame or time step take, e.g. advancing the water surface, uploading the surface heights
+ * and drawing. A phase is measured by a ProfilerScope on the stack (CPU) or by a GpuTimer (graphics card).
+ *
+ * Every thread writes the scopes that it measured to its own wait-free queue (see SpscQueue), so measuring does not
+ * lock and threads do not wait for each other. One thread (e.g. the render thread) calls collect regularly, which moves
+ * the measurements of all threads to the statistics (p50 and p99 of the last ROLLING_SAMPLE_COUNT measurements per phase)
+ * and to the trace (the last MAX_TRACE_EVENT_COUNT measurements), which can be exported in the Chrome trace event format
+ * (open in chrome://tracing or https://ui.perfetto.dev).
+ *
+ * Profiling can be enabled and disabled at any time. While it is disabled, a ProfilerScope only reads one flag.
+ * All methods except isEnabled, setThreadName and the ones that ProfilerScope uses must be called on the thread that calls collect.
+ */
+class Profiler {
+    private:
+        static atomic<bool> enabled;
+
+    public:
+        static const int ROLLING_SAMPLE_COUNT = 256;
+        static const int MAX_TRACE_EVENT_COUNT = 1 << 18;
+
+        /**
+         * Returns true if scopes are measured.
+         */
+        static bool isEnabled() {
+            return enabled.load(memory_order_relaxed);
+        }
+
+        /**
+         * Enables or disables measuring. Enabling clears the statistics and the trace of the previous time it was enabled.
+         */
+        static void setEnabled(bool enabled);
+
+        /**
+         * Sets the name of the calling thread in the trace, e.g. "main" or "simulation". name must be a string literal.
+         */
+        static void setThreadName(const char* name);
+
+        /**
+         * Returns the current time in ns since the start of the program.
+         */
+        static long long getTime();
+
+        /**
+         * Called by ProfilerScope on the thread that measured the scope. Returns the begin time of the scope.
+         */
+        static long long beginScope();
+        static void endScope(const char* name, long long beginTime);
+
+        /**
+         * Adds a phase that the graphics card executed in the given duration (in ns), see GpuTimer. beginTime is the time
+         * at which the commands of the phase were issued, which is where the phase is shown in the trace. name must be a string literal.
+         */
+        static void addGpuPhase(const char* name, long long beginTime, long long duration);
+
+        /**
+         * Moves the scopes that all threads measured since the last call to the statistics and the trace.
+         * Must be called regularly while profiling is enabled, otherwise the queue of a thread can be full and its scopes are dropped.
+         */
+        static void collect();
+
+        /**
+         * Prints the number of measurements, p50 and p99 (in ms) of every phase to the given file, e.g. stdout.
+         */
+        static void printStatistics(FILE* file);
+
+        /**
+         * Writes the trace to the file with the given name in the Chrome trace event format. Returns false if the file cannot be written.
+         */
+        static bool writeChromeTrace(const char* fileName);
+};
+
+/**
+ * Measures the time from its construction to its destruction as a phase with the given name, if profiling is enabled, see Profiler.
+ * Scopes can be nested. name must be a string literal, e.g. ProfilerScope scope("advanceSimulation");
+ */
+class ProfilerScope {
+    private:
+        const char* name;//NULL if profiling was disabled at construction.
+        long long beginTime;
+
+    public:
+        ProfilerScope(const char* name) {
+            if (Profiler::isEnabled()) {
+                this->name = name;
+                beginTime = Profiler::beginScope();
+            } else {
+                this->name = NULL;
+            }
+        }
+
+        ~ProfilerScope() {
+            if (name != NULL) {
+                Profiler::endScope(name, beginTime);
+            }
+        }
+};
+
+#endif
@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2018 A.C. Kockx, All Rights Reserved.
+ */
+
+#include "util/RenderQueue.h"
+
+#include <algorithm>
+#include <string.h>
+
+//size of the SceneParameters uniform block in bytes (std140 layout): view matrix, projection matrix,
+//light position, light intensity and ambient light intensity (each padded to 4 floats).
+static const int SCENE_PARAMETERS_FLOAT_COUNT = 16 + 16 + 4 + 4 + 4;
+
+RenderQueue::RenderQueue() {
+    //create uniform buffer object and attach it to the binding point that all shader programs read the SceneParameters block from.
+    glGenBuffers(1, &sceneParametersBufferObjectId);
+    glBindBuffer(GL_UNIFORM_BUFFER, sceneParametersBufferObjectId);
+    glBufferData(GL_UNIFORM_BUFFER, SCENE_PARAMETERS_FLOAT_COUNT * sizeof(float), NULL, GL_STREAM_DRAW);
+    glBindBufferBase(GL_UNIFORM_BUFFER, SCENE_PARAMETERS_BINDING_POINT, sceneParametersBufferObjectId);
+
+    //only enabling and disabling of face culling is part of the render state.
+    glCullFace(GL_BACK);
+
+    stateChangeCount = 0;
+}
+
+RenderQueue::~RenderQueue() {
+    glDeleteBuffers(1, &sceneParametersBufferObjectId);
+}
+
+void RenderQueue::setSceneParameters(mat4 viewMatrix, mat4 projectionMatrix, float lightPositionInWorldSpace[], float lightIntensity[], float ambientLightIntensity[]) {
+    vec4 lightPositionInCameraSpace = viewMatrix * vec4(lightPositionInWorldSpace[0], lightPositionInWorldSpace[1], lightPositionInWorldSpace[2], 1);
+
+    float data[SCENE_PARAMETERS_FLOAT_COUNT] = {};
+    memcpy(data, &viewMatrix[0][0], 16 * sizeof(float));
+    memcpy(data + 16, &projectionMatrix[0][0], 16 * sizeof(float));
+    memcpy(data + 32, &lightPositionInCameraSpace[0], 3 * sizeof(float));
+    memcpy(data + 36, lightIntensity, 3 * sizeof(float));
+    memcpy(data + 40, ambientLightIntensity, 3 * sizeof(float));
+
+    //orphan the storage of the previous frame, so the driver does not need to wait until the graphics card has finished reading it.
+    glBindBuffer(GL_UNIFORM_BUFFER, sceneParametersBufferObjectId);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(data), data, GL_STREAM_DRAW);
+}
+
+void RenderQueue::submit(GLuint shaderProgramId, GLuint vertexArrayObjectId, int renderState, DrawableInterface* drawable) {
+    packetShaderProgramIds.push_back(shaderProgramId);
+    packetVertexArrayObjectIds.push_back(vertexArrayObjectId);
+    packetRenderStates.push_back(renderState);
+    packetDrawables.push_back(drawable);
+}
+
+void RenderQueue::flush() {
+    //sort the packets by state, the packet index as last key keeps the submission order of packets with the same state.
+    int packetCount = (int) packetDrawables.size();
+    sortedPacketIndices.resize(packetCount);
+    for (int n = 0; n < packetCount; n++) {
+        sortedPacketIndices[n] = n;
+    }
+    std::sort(sortedPacketIndices.begin(), sortedPacketIndices.end(), [this](int a, int b) {
+        if (packetShaderProgramIds[a] != packetShaderProgramIds[b]) return packetShaderProgramIds[a] < packetShaderProgramIds[b];
+        if (packetVertexArrayObjectIds[a] != packetVertexArrayObjectIds[b]) return packetVertexArrayObjectIds[a] < packetVertexArrayObjectIds[b];
+        if (packetRenderStates[a] != packetRenderStates[b]) return packetRenderStates[a] < packetRenderStates[b];
+        return a < b;
+    });
+
+    //the drawables may have changed the bindings while they were submitted (e.g. to upload data), so the first packet sets all state.
+    stateChangeCount = 0;
+    for (int n = 0; n < packetCount; n++) {
+        int packet = sortedPacketIndices[n];
+        if (n == 0 || packetShaderProgramIds[packet] != packetShaderProgramIds[sortedPacketIndices[n - 1]]) {
+            glUseProgram(packetShaderProgramIds[packet]);
+            stateChangeCount++;
+        }
+        if (n == 0 || packetVertexArrayObjectIds[packet] != packetVertexArrayObjectIds[sortedPacketIndices[n - 1]]) {
+            glBindVertexArray(packetVertexArrayObjectIds[packet]);
+            stateChangeCount++;
+        }
+        int renderState = packetRenderStates[packet];
+        if (n == 0 || renderState != packetRenderStates[sortedPacketIndices[n - 1]]) {
+            if (renderState & CULL_BACK_FACES_RENDER_STATE) {
+                glEnable(GL_CULL_FACE);
+            } else {
+                glDisable(GL_CULL_FACE);
+            }
+            stateChangeCount++;
+        }
+        packetDrawables[packet]->draw();
+    }
+
+    packetShaderProgramIds.clear();
+    packetVertexArrayObjectIds.clear();
+    packetRenderStates.clear();
+    packetDrawables.clear();
+}
+
+int RenderQueue::getStateChangeCount() {
+    return stateChangeCount;
+}
@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2018 A.C. Kockx, All Rights Reserved.
+ */
+
+#include "util/ModelUtils.h"
+#include "util/OpenGLUtils.h"
+#include "util/DrawableInterface.h"
+
+#ifndef INCLUDED_RENDERQUEUE_H
+#define INCLUDED_RENDERQUEUE_H
+
+enum {
+    //render state flags of a draw packet, 0 means no flags.
+    CULL_BACK_FACES_RENDER_STATE = 1
+};
+
+/**
+ * Collects the draw packets of a frame and issues them with as few OpenGL state changes as possible.
+ * A draw packet consists of a shader program, a vertex array object, render state flags and a drawable that issues the draw calls.
+ * The packets are sorted by shader program, then by vertex array object, then by render state, so that packets that share
+ * state are drawn one after the other and every state is only set when it differs from the previous packet.
+ *
+ * The camera and light are the same for all packets of a frame, so they are stored in a single uniform buffer object
+ * that is written once per frame and is read by all shader programs via the SceneParameters uniform block, see createShaderProgram.
+ *
+ * Usage per frame: call setSceneParameters, submit all draw packets and call flush.
+ */
+class RenderQueue {
+    private:
+        GLuint sceneParametersBufferObjectId;
+
+        //draw packets of the current frame, in the order in which they were submitted.
+        vector<GLuint> packetShaderProgramIds;
+        vector<GLuint> packetVertexArrayObjectIds;
+        vector<int> packetRenderStates;
+        vector<DrawableInterface*> packetDrawables;
+        vector<int> sortedPacketIndices;
+
+        int stateChangeCount;//number of state changes during the last call to flush.
+
+    public:
+        RenderQueue();
+
+        ~RenderQueue();
+
+        /**
+         * Writes the camera and light of the current frame to the uniform buffer object.
+         * The light position is transformed to camera space here, so that the shaders do not need to do this per vertex.
+         */
+        void setSceneParameters(mat4 viewMatrix, mat4 projectionMatrix, float lightPositionInWorldSpace[], float lightIntensity[], float ambientLightIntensity[]);
+
+        /**
+         * Adds a draw packet to the current frame. The drawable must stay valid until the next call to flush.
+         */
+        void submit(GLuint shaderProgramId, GLuint vertexArrayObjectId, int renderState, DrawableInterface* drawable);
+
+        /**
+         * Draws all packets that were submitted since the last call to flush, sorted by state, and removes them from this queue.
+         * Packets with the same state are drawn in the order in which they were submitted.
+         */
+        void flush();
+
+        /**
+         * Returns the number of shader program, vertex array object and render state changes during the last call to flush.
+         */
+        int getStateChangeCount();
+};
+
+#endif
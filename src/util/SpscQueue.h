@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2018 A.C. Kockx, All Rights Reserved.
+ */
+
+#include <atomic>
+
+using namespace std;
+
+#ifndef INCLUDED_SPSCQUEUE_H
+#define INCLUDED_SPSCQUEUE_H
+
+/**
+ * Wait-free bounded queue for passing items from one producer thread to one consumer thread (single producer, single consumer).
+ * It can hold up to capacity - 1 items. Pushing and popping never wait, instead they return false if the queue is full or empty.
+ */
+template <typename T, int capacity>
+class SpscQueue {
+    private:
+        T items[capacity];
+        atomic<int> head;//index of the next item to pop, only written by the consumer.
+        atomic<int> tail;//index of the next item to push, only written by the producer.
+
+    public:
+        SpscQueue() : head(0), tail(0) {}
+
+        /**
+         * Adds the given item to the end of this queue. Only called by the producer.
+         * Returns false (and does not add the item) if this queue is full.
+         */
+        bool push(const T& item) {
+            int currentTail = tail.load(memory_order_relaxed);
+            int nextTail = (currentTail + 1) % capacity;
+            if (nextTail == head.load(memory_order_acquire)) {
+                return false;
+            }
+
+            items[currentTail] = item;
+            tail.store(nextTail, memory_order_release);
+            return true;
+        }
+
+        /**
+         * Removes the item at the start of this queue and stores it in the given item. Only called by the consumer.
+         * Returns false (and does not change the given item) if this queue is empty.
+         */
+        bool pop(T& item) {
+            int currentHead = head.load(memory_order_relaxed);
+            if (currentHead == tail.load(memory_order_acquire)) {
+                return false;
+            }
+
+            item = items[currentHead];
+            head.store((currentHead + 1) % capacity, memory_order_release);
+            return true;
+        }
+};
+
+#endif
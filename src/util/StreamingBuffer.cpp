@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2018 A.C. Kockx, All Rights Reserved.
+ */
+
+#include "util/StreamingBuffer.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static const GLuint64 FENCE_TIMEOUT = 1000000000;//in nanoseconds.
+
+StreamingBuffer::StreamingBuffer(GLenum target, int size) {
+    this->target = target;
+    this->size = size;
+    regionIndex = 0;
+    mappedMemory = NULL;
+    for (int n = 0; n < REGION_COUNT; n++) {
+        fences[n] = NULL;
+    }
+
+    glGenBuffers(1, &bufferObjectId);
+    glBindBuffer(target, bufferObjectId);
+    persistentlyMapped = GLEW_ARB_buffer_storage && GLEW_ARB_sync;
+    if (persistentlyMapped) {
+        //allocate immutable storage for all regions and keep it mapped. Coherent mapping means that writes
+        //become visible to the graphics card without explicit flushing.
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(target, (GLsizeiptr) REGION_COUNT * size, NULL, flags);
+        mappedMemory = (char*) glMapBufferRange(target, 0, (GLsizeiptr) REGION_COUNT * size, flags);
+        if (mappedMemory == NULL) {
+            fprintf(stderr, "Error: cannot map streaming buffer\n");
+            glfwTerminate();
+            exit(-1);
+        }
+    } else {
+        glBufferData(target, size, NULL, GL_STREAM_DRAW);
+    }
+}
+
+StreamingBuffer::~StreamingBuffer() {
+    for (int n = 0; n < REGION_COUNT; n++) {
+        if (fences[n] != NULL) {
+            glDeleteSync(fences[n]);
+        }
+    }
+    if (persistentlyMapped) {
+        glBindBuffer(target, bufferObjectId);
+        glUnmapBuffer(target);
+    }
+    glDeleteBuffers(1, &bufferObjectId);
+}
+
+GLuint StreamingBuffer::getBufferObjectId() {
+    return bufferObjectId;
+}
+
+bool StreamingBuffer::isPersistentlyMapped() {
+    return persistentlyMapped;
+}
+
+int StreamingBuffer::getRegionCount() {
+    return REGION_COUNT;
+}
+
+int StreamingBuffer::getRegionIndex() {
+    return regionIndex;
+}
+
+void* StreamingBuffer::beginWrite() {
+    if (!persistentlyMapped) {
+        //orphan the old storage, the graphics card can keep reading from it until it is no longer needed.
+        glBindBuffer(target, bufferObjectId);
+        glBufferData(target, size, NULL, GL_STREAM_DRAW);
+        void* memory = glMapBufferRange(target, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+        if (memory == NULL) {
+            fprintf(stderr, "Error: cannot map streaming buffer\n");
+            glfwTerminate();
+            exit(-1);
+        }
+        return memory;
+    }
+
+    //use the next region and wait until the graphics card has finished reading it (REGION_COUNT frames ago).
+    regionIndex = (regionIndex + 1) % REGION_COUNT;
+    GLsync fence = fences[regionIndex];
+    if (fence != NULL) {
+        GLbitfield waitFlags = GL_SYNC_FLUSH_COMMANDS_BIT;
+        while (true) {
+            GLenum result = glClientWaitSync(fence, waitFlags, FENCE_TIMEOUT);
+            if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED) {
+                break;
+            }
+            if (result == GL_WAIT_FAILED) {
+                fprintf(stderr, "Error while waiting for streaming buffer fence\n");
+                glfwTerminate();
+                exit(-1);
+            }
+            //timeout expired, commands have already been flushed.
+            waitFlags = 0;
+        }
+        glDeleteSync(fence);
+        fences[regionIndex] = NULL;
+    }
+    return mappedMemory + (size_t) regionIndex * size;
+}
+
+GLintptr StreamingBuffer::endWrite() {
+    glBindBuffer(target, bufferObjectId);
+    if (!persistentlyMapped) {
+        glUnmapBuffer(target);
+        return 0;
+    }
+    return (GLintptr) regionIndex * size;
+}
+
+void StreamingBuffer::endRead() {
+    if (persistentlyMapped) {
+        //if the same region was drawn again, then only the last draw calls need to be waited for.
+        if (fences[regionIndex] != NULL) {
+            glDeleteSync(fences[regionIndex]);
+        }
+        fences[regionIndex] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+}
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2018 A.C. Kockx, All Rights Reserved.
+ */
+
+#include "util/OpenGLUtils.h"
+
+#ifndef INCLUDED_STREAMINGBUFFER_H
+#define INCLUDED_STREAMINGBUFFER_H
+
+/**
+ * Buffer object for data that is rewritten by the CPU every frame, e.g. dynamic vertex data or texture data that is
+ * uploaded via a pixel unpack buffer. The CPU writes directly into mapped buffer memory, so no staging copy is needed.
+ *
+ * If ARB_buffer_storage is available, then the buffer object contains REGION_COUNT regions that stay mapped
+ * during the whole lifetime of this buffer (persistent mapping). Every frame the next region is written, while the
+ * graphics card may still read the regions of previous frames. A fence after the draw calls that read a region ensures
+ * that the region is not overwritten before the graphics card has finished reading it.
+ * Otherwise the buffer object is orphaned every frame, i.e. it gets new storage, so the driver does not need to wait
+ * until the graphics card has finished reading the old storage.
+ *
+ * Usage per frame: call beginWrite, write size bytes to the returned memory, call endWrite and bind the buffer with
+ * the returned offset (e.g. with glVertexAttribPointer), issue the draw calls that read the data and then call endRead.
+ * If the data did not change, then the writing can be skipped and the data of the previous frame can be drawn again (followed by endRead).
+ * If persistently mapped, then a region still contains the data that was written to it REGION_COUNT frames ago,
+ * so only the data that changed since then needs to be written, see getRegionIndex.
+ */
+class StreamingBuffer {
+    private:
+        static const int REGION_COUNT = 3;//triple buffering.
+
+        GLenum target;
+        int size;//in bytes, per region.
+        GLuint bufferObjectId;
+        bool persistentlyMapped;
+        char* mappedMemory;//only used if persistentlyMapped.
+        GLsync fences[REGION_COUNT];//only used if persistentlyMapped.
+        int regionIndex;//region that is written in the current frame.
+
+    public:
+        /**
+         * Creates a streaming buffer for the given target (e.g. GL_ARRAY_BUFFER) that can hold size bytes per frame.
+         */
+        StreamingBuffer(GLenum target, int size);
+
+        GLuint getBufferObjectId();
+        bool isPersistentlyMapped();
+        int getRegionCount();
+
+        /**
+         * Returns the index of the region that is written in the current frame, i.e. that the memory returned by the last call to beginWrite belongs to.
+         * If not persistently mapped, then this is always 0 and the contents of that memory are undefined.
+         */
+        int getRegionIndex();
+
+        /**
+         * Returns a pointer to size bytes of mapped buffer memory that the data for the current frame can be written to.
+         * The memory is write-only, i.e. reading from it can be very slow. Waits if the graphics card may still read from this memory.
+         */
+        void* beginWrite();
+
+        /**
+         * Finishes writing the data for the current frame and leaves the buffer object bound to the target.
+         * Returns the offset (in bytes) of the data in the buffer object.
+         */
+        GLintptr endWrite();
+
+        /**
+         * Must be called after the draw calls that read the data of the current frame have been issued.
+         */
+        void endRead();
+
+        ~StreamingBuffer();
+};
+
+#endif
@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2018 A.C. Kockx, All Rights Reserved.
+ */
+
+#include "util/ThreadPool.h"
+
+ThreadPool::ThreadPool(int threadCount) {
+    if (threadCount <= 0) {
+        threadCount = (int) thread::hardware_concurrency();
+        if (threadCount <= 0) threadCount = 1;//if unknown.
+    }
+
+    stopping = false;
+    bandFunction = NULL;
+    body = NULL;
+    begin = 0;
+    end = 0;
+    generation = 0;
+    unfinishedWorkerCount = 0;
+
+    //the calling thread also works, so create one worker less.
+    for (int workerIndex = 0; workerIndex < threadCount - 1; workerIndex++) {
+        workers.push_back(thread(&ThreadPool::workerLoop, this, workerIndex));
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        lock_guard<mutex> lock(poolMutex);
+        stopping = true;
+    }
+    startCondition.notify_all();
+    for (int n = 0; n < workers.size(); n++) {
+        workers[n].join();
+    }
+}
+
+int ThreadPool::getThreadCount() {
+    return (int) workers.size() + 1;
+}
+
+void ThreadPool::workerLoop(int workerIndex) {
+    int lastGeneration = 0;
+    unique_lock<mutex> lock(poolMutex);
+    while (true) {
+        startCondition.wait(lock, [&] { return stopping || generation != lastGeneration; });
+        if (stopping) {
+            return;
+        }
+        lastGeneration = generation;
+
+        lock.unlock();
+        //band 0 is processed by the calling thread.
+        runBand(workerIndex + 1);
+        lock.lock();
+
+        unfinishedWorkerCount--;
+        if (unfinishedWorkerCount == 0) {
+            finishCondition.notify_one();
+        }
+    }
+}
+
+void ThreadPool::runBand(int bandIndex) {
+    long long length = end - begin;
+    long long bandCount = getThreadCount();
+    int bandBegin = begin + (int) (length * bandIndex / bandCount);
+    int bandEnd = begin + (int) (length * (bandIndex + 1) / bandCount);
+    if (bandBegin < bandEnd) {
+        bandFunction(body, bandBegin, bandEnd);
+    }
+}
+
+void ThreadPool::run(BandFunction bandFunction, const void* body, int begin, int end) {
+    if (workers.empty() || end - begin <= 1) {//if nothing to parallelize.
+        if (begin < end) {
+            bandFunction(body, begin, end);
+        }
+        return;
+    }
+
+    //start workers.
+    {
+        lock_guard<mutex> lock(poolMutex);
+        this->bandFunction = bandFunction;
+        this->body = body;
+        this->begin = begin;
+        this->end = end;
+        unfinishedWorkerCount = (int) workers.size();
+        generation++;
+    }
+    startCondition.notify_all();
+
+    runBand(0);
+
+    //wait for workers.
+    unique_lock<mutex> lock(poolMutex);
+    finishCondition.wait(lock, [&] { return unfinishedWorkerCount == 0; });
+}
@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2018 A.C. Kockx, All Rights Reserved.
+ */
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+using namespace std;
+
+#ifndef INCLUDED_THREADPOOL_H
+#define INCLUDED_THREADPOOL_H
+
+/**
+ * Pool of persistent worker threads that is used to run loops in parallel.
+ * The threads are created once and wait for work in between, so that starting a parallel loop is cheap enough to do several times per time step.
+ */
+class ThreadPool {
+    private:
+        typedef void (*BandFunction)(const void* body, int begin, int end);
+
+        vector<thread> workers;
+        mutex poolMutex;
+        condition_variable startCondition;
+        condition_variable finishCondition;
+        bool stopping;
+
+        //current loop.
+        BandFunction bandFunction;
+        const void* body;
+        int begin;
+        int end;
+        int generation;//incremented for every loop, so that the workers can detect that there is a new loop to run.
+        int unfinishedWorkerCount;
+
+        void workerLoop(int workerIndex);
+        void runBand(int bandIndex);
+        void run(BandFunction bandFunction, const void* body, int begin, int end);
+
+        template <typename Body>
+        static void invokeBody(const void* body, int begin, int end) {
+            (*(const Body*) body)(begin, end);
+        }
+
+    public:
+        /**
+         * Creates a pool that uses the given number of threads (including the calling thread) to run loops.
+         * If threadCount is zero or negative, then one thread per hardware thread of the processor is used.
+         */
+        ThreadPool(int threadCount);
+
+        /**
+         * Returns the number of threads (including the calling thread) that are used to run loops.
+         */
+        int getThreadCount();
+
+        /**
+         * Splits the range [begin, end) into one contiguous band per thread and calls body(bandBegin, bandEnd) for each non-empty band in parallel.
+         * The calling thread processes the first band. Returns when all bands have been processed, i.e. this acts as a barrier.
+         * The split only depends on the range and the number of threads, bands are never split further.
+         * This must not be called from within body and must only be called by one thread at a time.
+         */
+        template <typename Body>
+        void parallelFor(int begin, int end, const Body& body) {
+            run(&invokeBody<Body>, &body, begin, end);
+        }
+
+        ~ThreadPool();
+};
+
+#endif
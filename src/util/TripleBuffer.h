@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2018 A.C. Kockx, All Rights Reserved.
+ */
+
+#include <atomic>
+
+using namespace std;
+
+#ifndef INCLUDED_TRIPLEBUFFER_H
+#define INCLUDED_TRIPLEBUFFER_H
+
+/**
+ * Lock-free triple buffer for passing the latest version of some data from one producer thread to one consumer thread.
+ * The producer writes to the back buffer and then publishes it, the consumer reads the front buffer. The third buffer
+ * is in between. Publishing swaps the back buffer with the middle buffer and getting the latest data swaps the front buffer
+ * with the middle buffer if it contains newer data. Both are a single atomic exchange, so neither thread ever waits for the other.
+ * Versions that are published faster than the consumer reads them are skipped.
+ */
+template <typename T>
+class TripleBuffer {
+    private:
+        static const int INDEX_MASK = 3;
+        static const int NEW_DATA_BIT = 4;//set if the middle buffer has been published but not yet read.
+
+        T buffers[3];
+        atomic<int> middle;//index of the middle buffer, plus NEW_DATA_BIT.
+        int back;//index of the back buffer, only used by the producer.
+        int front;//index of the front buffer, only used by the consumer.
+
+    public:
+        TripleBuffer() : middle(1) {
+            back = 0;
+            front = 2;
+        }
+
+        /**
+         * Returns the back buffer, that the producer can write the next version of the data to.
+         */
+        T* getBackBuffer() {
+            return &buffers[back];
+        }
+
+        /**
+         * Makes the data in the back buffer available to the consumer. Only called by the producer.
+         * After this getBackBuffer returns a different buffer, which may contain an older version of the data.
+         */
+        void publish() {
+            back = middle.exchange(back | NEW_DATA_BIT, memory_order_acq_rel) & INDEX_MASK;
+        }
+
+        /**
+         * Returns the most recently published data. Only called by the consumer. The returned data remains valid and
+         * unchanged until the next call to this method. Returns the front buffer as it was initialized if nothing has been published yet.
+         */
+        const T* getLatest() {
+            if (middle.load(memory_order_relaxed) & NEW_DATA_BIT) {
+                front = middle.exchange(front, memory_order_acq_rel) & INDEX_MASK;
+            }
+            return &buffers[front];
+        }
+};
+
+#endif
@@ -0,0 +1,34 @@
+/*
+ * Copyright (c) 2018 A.C. Kockx, All Rights Reserved.
+ */
+
+#include "util/ViewFrustum.h"
+
+ViewFrustum::ViewFrustum(mat4 clipMatrix) {
+    //a point is inside if -w <= x, y, z <= w in clip space, so every plane is a sum or difference of two rows of the matrix (Gribb and Hartmann).
+    //Row n of the (column-major) matrix gives clip space coordinate n.
+    vec4 rows[4];
+    for (int n = 0; n < 4; n++) {
+        rows[n] = vec4(clipMatrix[0][n], clipMatrix[1][n], clipMatrix[2][n], clipMatrix[3][n]);
+    }
+    for (int n = 0; n < 3; n++) {
+        planes[2 * n] = rows[3] + rows[n];
+        planes[2 * n + 1] = rows[3] - rows[n];
+    }
+}
+
+bool ViewFrustum::intersects(BoundingBox box) const {
+    return intersects(vec3(box.getMinX(), box.getMinY(), box.getMinZ()), vec3(box.getMaxX(), box.getMaxY(), box.getMaxZ()));
+}
+
+bool ViewFrustum::intersects(vec3 minimum, vec3 maximum) const {
+    for (int n = 0; n < 6; n++) {
+        //the corner of the box that is furthest on the inner side of the plane.
+        vec4 plane = planes[n];
+        vec3 corner = vec3(plane.x >= 0 ? maximum.x : minimum.x, plane.y >= 0 ? maximum.y : minimum.y, plane.z >= 0 ? maximum.z : minimum.z);
+        if (dot(vec3(plane), corner) + plane.w < 0) {
+            return false;
+        }
+    }
+    return true;
+}
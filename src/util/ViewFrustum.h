@@ -0,0 +1,38 @@
+/*
+ * Copyright (c) 2018 A.C. Kockx, All Rights Reserved.
+ */
+
+#include "util/ModelUtils.h"
+#include "util/BoundingBox.h"
+
+#ifndef INCLUDED_VIEWFRUSTUM_H
+#define INCLUDED_VIEWFRUSTUM_H
+
+/**
+ * The part of space that is visible to a camera, bounded by 6 planes (left, right, bottom, top, near and far).
+ */
+class ViewFrustum {
+    private:
+        //per plane: (a, b, c, d) such that a * x + b * y + c * z + d >= 0 for points (x, y, z) on the inner side of the plane.
+        vec4 planes[6];
+
+    public:
+        /**
+         * Creates the view frustum of the given matrix, which transforms coordinates to clip space,
+         * e.g. projectionMatrix * viewMatrix for a frustum in world space.
+         */
+        ViewFrustum(mat4 clipMatrix);
+
+        /**
+         * Returns false if the given box is completely outside of this frustum. Boxes that are close to a corner of the frustum
+         * can be outside but still return true, which only costs a superfluous draw.
+         */
+        bool intersects(BoundingBox box) const;
+
+        /**
+         * Returns the same as intersects, for the box with the given bounds.
+         */
+        bool intersects(vec3 minimum, vec3 maximum) const;
+};
+
+#endif
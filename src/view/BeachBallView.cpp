@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2018 A.C. Kockx, All Rights Reserved.
+ */
+
+#include "view/BeachBallView.h"
+
+#include "util/ModelUtils.h"
+#include "util/OpenGLUtils.h"
+
+BeachBallView::BeachBallView(InstancedPhongShader* shader) {
+    //create geometry.
+    int vertexCountPerTriangleStrip = verticalLevelOfDetail * 2;
+    const int vertexCount = triangleStripCount * vertexCountPerTriangleStrip;
+    //vertices are in 3D, i.e. 3 coordinates together form 1 vertex.
+    const GLint dimensionCount = 3;
+    vector<float> vertices(vertexCount * dimensionCount);//vertex coordinates (x, y, z) in model space.
+    vector<float> normals(vertexCount * dimensionCount);//vertex normal vectors (x, y, z) in model space.
+    createBeachBall(triangleStripCount, verticalLevelOfDetail, vertices, normals);
+
+    //create colors.
+    vector<float> colors(vertexCount * dimensionCount);//vertex colors (r, g, b).
+    //loop over triangleStripColors to give each triangle strip a single color.
+    int colorIndex = 0;
+    int index = 0;
+    for (int p = 0; p < triangleStripCount; p++) {
+        float r = triangleStripColors[colorIndex][0];
+        float g = triangleStripColors[colorIndex][1];
+        float b = triangleStripColors[colorIndex][2];
+
+        for (int n = 0; n < vertexCountPerTriangleStrip; n++) {
+            colors[index++] = r;
+            colors[index++] = g;
+            colors[index++] = b;
+        }
+
+        colorIndex = (colorIndex + 1) % size(triangleStripColors);
+    }
+
+    //convert the triangle strips to separate triangles, so that the whole beach ball is drawn with one draw call.
+    //Every other triangle of a strip has its first two vertices swapped, so that all triangles keep the same winding order.
+    vector<unsigned int> indices;
+    indices.reserve(triangleStripCount * (vertexCountPerTriangleStrip - 2) * 3);
+    for (int p = 0; p < triangleStripCount; p++) {
+        unsigned int firstVertex = p * vertexCountPerTriangleStrip;
+        for (int n = 0; n < vertexCountPerTriangleStrip - 2; n++) {
+            unsigned int vertex = firstVertex + n;
+            indices.push_back(n % 2 == 0 ? vertex : vertex + 1);
+            indices.push_back(n % 2 == 0 ? vertex + 1 : vertex);
+            indices.push_back(vertex + 2);
+        }
+    }
+    mesh = new InstancedMesh(vertices, normals, colors, indices, shader);
+}
+
+BeachBallView::~BeachBallView() {
+    delete mesh;
+}
+
+void BeachBallView::addObject(ObjectInterface* object, int objectIndex) {
+    objectIndices.push_back(objectIndex);
+    radii.push_back(((BeachBall*) object)->getRadius());
+}
+
+void BeachBallView::submit(const SimulationSnapshot* snapshot, const vector<bool>& objectVisibilities, RenderQueue* renderQueue) {
+    //write position, radius and color of every visible beach ball directly to graphics card memory.
+    int beachBallCount = (int) objectIndices.size();
+    int visibleBeachBallCount = 0;
+    for (int n = 0; n < beachBallCount; n++) {
+        if (objectVisibilities[objectIndices[n]]) {
+            visibleBeachBallCount++;
+        }
+    }
+    float* instance = mesh->beginInstances(visibleBeachBallCount);
+    for (int n = 0; n < beachBallCount; n++) {
+        if (!objectVisibilities[objectIndices[n]]) {
+            continue;
+        }
+        vec3 position = snapshot->getObjectPosition(objectIndices[n]);
+        instance[0] = position[0];
+        instance[1] = position[1];
+        instance[2] = position[2];
+        instance[3] = radii[n];
+        instance[4] = instanceColor[0];
+        instance[5] = instanceColor[1];
+        instance[6] = instanceColor[2];
+        instance += InstancedMesh::INSTANCE_FLOAT_COUNT;
+    }
+
+    mesh->submit(renderQueue);
+}
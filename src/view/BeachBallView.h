@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2018 A.C. Kockx, All Rights Reserved.
+ */
+
+#include "model/BeachBall.h"
+#include "view/ObjectViewInterface.h"
+#include "view/InstancedMesh.h"
+
+#ifndef INCLUDED_BEACHBALLVIEW_H
+#define INCLUDED_BEACHBALLVIEW_H
+
+/**
+ * Draws all BeachBalls of a scene using OpenGL, with one instanced draw call per frame, see InstancedMesh.
+ */
+class BeachBallView : public ObjectViewInterface {
+    private:
+        //beach balls.
+        vector<int> objectIndices;//per beach ball: index in the snapshot.
+        vector<float> radii;//per beach ball: radius in m, which does not change during the simulation.
+
+        //geometry of a beach ball with radius 1 (the instances are scaled by their radius).
+        const int verticalLevelOfDetail = 60;
+        const int triangleStripCount = 6;
+        InstancedMesh* mesh;
+
+        //material.
+        const float triangleStripColors[3][3] = {
+            {0, 0, 0.9f},//blue.
+            {1, 1, 1},//white.
+            {1, 1, 0},//yellow.
+        };
+        const float instanceColor[3] = {1, 1, 1};//factors of the triangle strip colors, the same for all beach balls.
+
+    public:
+        /**
+         * Creates the geometry that is needed to draw beach balls, which are drawn with the given shader.
+         */
+        BeachBallView(InstancedPhongShader* shader);
+
+        ~BeachBallView();
+
+        /**
+         * Adds the given beach ball to the beach balls that this view draws.
+         */
+        virtual void addObject(ObjectInterface* object, int objectIndex);
+
+        /**
+         * Submits one draw packet that draws all visible beach balls to the given queue, see ObjectViewInterface.
+         */
+        virtual void submit(const SimulationSnapshot* snapshot, const vector<bool>& objectVisibilities, RenderQueue* renderQueue);
+};
+
+#endif
@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2018 A.C. Kockx, All Rights Reserved.
+ */
+
+#include "view/InstancedMesh.h"
+
+#include <algorithm>
+
+//vertex attribute indices, see InstancedPhongShader.
+static const GLuint INSTANCE_TRANSFORM_ATTRIBUTE_INDEX = 3;
+static const GLuint INSTANCE_COLOR_ATTRIBUTE_INDEX = 4;
+
+InstancedMesh::InstancedMesh(const vector<float>& vertices, const vector<float>& normals, const vector<float>& colors, const vector<unsigned int>& indices, InstancedPhongShader* shader) {
+    this->shader = shader;
+
+    //create vertex array object.
+    //vertices are in 3D, i.e. 3 coordinates together form 1 vertex.
+    const GLint dimensionCount = 3;
+    int vertexCount = (int) vertices.size() / dimensionCount;
+    glGenVertexArrays(1, &vertexArrayObjectId);
+    glBindVertexArray(vertexArrayObjectId);
+    createVertexBufferObject(0, vertexCount, dimensionCount, (float*) &vertices[0], GL_STATIC_DRAW);
+    createVertexBufferObject(1, vertexCount, dimensionCount, (float*) &normals[0], GL_STATIC_DRAW);
+    createVertexBufferObject(2, vertexCount, dimensionCount, (float*) &colors[0], GL_STATIC_DRAW);
+    indexCount = (int) indices.size();
+    indexBufferObjectId = createIndexBufferObject(indexCount, (unsigned int*) &indices[0]);
+
+    //the per-instance attributes advance once per instance instead of once per vertex (available since OpenGL 3.3).
+    //They are attached to the instance buffer every frame.
+    glVertexAttribDivisor(INSTANCE_TRANSFORM_ATTRIBUTE_INDEX, 1);
+    glVertexAttribDivisor(INSTANCE_COLOR_ATTRIBUTE_INDEX, 1);
+    glEnableVertexAttribArray(INSTANCE_TRANSFORM_ATTRIBUTE_INDEX);
+    glEnableVertexAttribArray(INSTANCE_COLOR_ATTRIBUTE_INDEX);
+
+    instanceBuffer = NULL;
+    instanceCapacity = 0;
+    instanceCount = 0;
+}
+
+InstancedMesh::~InstancedMesh() {
+    delete instanceBuffer;
+}
+
+float* InstancedMesh::beginInstances(int instanceCount) {
+    this->instanceCount = instanceCount;
+    if (instanceCount > instanceCapacity) {
+        //grow geometrically, so that adding objects one at a time does not recreate the buffer every frame.
+        delete instanceBuffer;
+        instanceCapacity = std::max(instanceCount, 2 * instanceCapacity);
+        instanceBuffer = new StreamingBuffer(GL_ARRAY_BUFFER, instanceCapacity * INSTANCE_FLOAT_COUNT * sizeof(float));
+    }
+    return instanceCount == 0 ? NULL : (float*) instanceBuffer->beginWrite();
+}
+
+void InstancedMesh::submit(RenderQueue* renderQueue) {
+    if (instanceCount == 0) {
+        return;
+    }
+
+    //attach the instance data of this frame to the per-instance attributes.
+    glBindVertexArray(vertexArrayObjectId);
+    GLintptr offset = instanceBuffer->endWrite();
+    const GLsizei stride = INSTANCE_FLOAT_COUNT * sizeof(float);
+    glVertexAttribPointer(INSTANCE_TRANSFORM_ATTRIBUTE_INDEX, 4, GL_FLOAT, GL_FALSE, stride, (void*) offset);
+    glVertexAttribPointer(INSTANCE_COLOR_ATTRIBUTE_INDEX, 3, GL_FLOAT, GL_FALSE, stride, (void*) (offset + 4 * sizeof(float)));
+
+    renderQueue->submit(shader->getShaderProgramId(), vertexArrayObjectId, CULL_BACK_FACES_RENDER_STATE, this);
+}
+
+void InstancedMesh::draw() {
+    //draw all instances at once.
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBufferObjectId);
+    //note that this uses indexCount, not triangleCount.
+    glDrawElementsInstanced(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0, instanceCount);
+
+    //the region of this frame can be reused as soon as the graphics card has finished drawing.
+    instanceBuffer->endRead();
+}
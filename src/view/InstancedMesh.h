@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2018 A.C. Kockx, All Rights Reserved.
+ */
+
+#include "shader/InstancedPhongShader.h"
+#include "util/StreamingBuffer.h"
+#include "util/RenderQueue.h"
+
+#ifndef INCLUDED_INSTANCEDMESH_H
+#define INCLUDED_INSTANCEDMESH_H
+
+/**
+ * A triangle mesh that is drawn many times per frame with a single instanced draw call, e.g. for many objects of the same shape.
+ * The vertices are stored once in graphics card memory. The per-instance data (INSTANCE_FLOAT_COUNT floats per instance:
+ * translation x, y, z in world space, uniform scale factor and color factors r, g, b) is written every frame to a single streaming buffer,
+ * so that the graphics card can still draw the previous frame in the meantime, see StreamingBuffer.
+ *
+ * Usage per frame: call beginInstances, write the data of all instances to the returned memory and call submit.
+ */
+class InstancedMesh : public DrawableInterface {
+    private:
+        //geometry.
+        GLuint vertexArrayObjectId;
+        GLuint indexBufferObjectId;
+        int indexCount;
+
+        //instances.
+        StreamingBuffer* instanceBuffer;
+        int instanceCapacity;//number of instances that fit in instanceBuffer.
+        int instanceCount;//number of instances of the current frame.
+
+        //material, shared with other meshes.
+        InstancedPhongShader* shader;
+
+    public:
+        static const int INSTANCE_FLOAT_COUNT = 7;
+
+        /**
+         * Creates a mesh from the given vertex coordinates (x, y, z) and normal vectors (x, y, z) in model space, vertex colors (r, g, b)
+         * and triangles (3 vertex indices per triangle), which is drawn with the given shader.
+         */
+        InstancedMesh(const vector<float>& vertices, const vector<float>& normals, const vector<float>& colors, const vector<unsigned int>& indices, InstancedPhongShader* shader);
+
+        ~InstancedMesh();
+
+        /**
+         * Returns memory for instanceCount * INSTANCE_FLOAT_COUNT floats of per-instance data that is drawn by the next call to draw.
+         * The memory is write-only mapped graphics card memory, see StreamingBuffer::beginWrite.
+         */
+        float* beginInstances(int instanceCount);
+
+        /**
+         * Submits a draw packet to the given queue that draws all instances that were written after the last call to beginInstances, with one draw call.
+         */
+        void submit(RenderQueue* renderQueue);
+
+        /**
+         * Issues the instanced draw call, see DrawableInterface.
+         */
+        virtual void draw();
+};
+
+#endif
@@ -0,0 +1,202 @@
+/*
+ * Copyright (c) 2018 A.C. Kockx, All Rights Reserved.
+ */
+
+#include "view/LevelOfDetailWaterSurfaceView.h"
+
+#include <algorithm>
+#include <string.h>
+
+#include "util/ModelUtils.h"
+#include "util/OpenGLUtils.h"
+
+//range of level 0 in units of the size of a patch of level 0. Together with LOD_MORPH_START_FRACTION this must be large enough
+//that a vertex on the seam between two levels is completely morphed on the side of the finer level before the coarser level
+//starts to morph, i.e. LOD_MORPH_START_FRACTION * LOD_RANGE_FACTOR >= 2 * sqrt(2).
+static const float LOD_RANGE_FACTOR = 8;
+static const float LOD_MORPH_START_FRACTION = 0.5f;
+
+//vertex attribute indices, see LevelOfDetailPhongShader.
+static const GLuint PATCH_TRANSFORM_ATTRIBUTE_INDEX = 1;
+
+LevelOfDetailWaterSurfaceView::LevelOfDetailWaterSurfaceView(WaterSurface* waterSurface, SimulationBoundaries* bounds) : shader(0.9f, 15, waterColor) {
+    this->waterSurface = waterSurface;
+    rowCount = waterSurface->getRowCount();
+    columnCount = waterSurface->getColumnCount();
+    dX = waterSurface->getXSize() / (columnCount - 1);
+    dY = waterSurface->getYSize() / (rowCount - 1);
+    levelCount = 1;
+    while ((PATCH_RESOLUTION << (levelCount - 1)) < std::max(rowCount, columnCount) - 1) {
+        levelCount++;
+    }
+    //the ranges scale with the grid spacing, so that a finer grid only adds finer levels close to the camera.
+    lodRange = LOD_RANGE_FACTOR * PATCH_RESOLUTION * std::max(dX, dY);
+    shader.setGrid(rowCount, columnCount, dX, dY, lodRange, LOD_MORPH_START_FRACTION);
+    BoundingBox box = bounds->getBoundingBox();
+    minZ = box.getMinZ() - waterSurface->getZ();
+    maxZ = box.getMaxZ() - waterSurface->getZ();
+
+    //create geometry: a grid of (PATCH_RESOLUTION + 1) x (PATCH_RESOLUTION + 1) vertices, with the column and row of every vertex as its position.
+    const int vertexCountPerSide = PATCH_RESOLUTION + 1;
+    vector<float> vertices;
+    vertices.reserve(vertexCountPerSide * vertexCountPerSide * 2);
+    for (int row = 0; row < vertexCountPerSide; row++) {
+        for (int column = 0; column < vertexCountPerSide; column++) {
+            vertices.push_back((float) column);
+            vertices.push_back((float) row);
+        }
+    }
+    glGenVertexArrays(1, &vertexArrayObjectId);
+    glBindVertexArray(vertexArrayObjectId);
+    createVertexBufferObject(0, vertexCountPerSide * vertexCountPerSide, 2, &vertices[0], GL_STATIC_DRAW);
+
+    //create index buffer object, one quarter of the patch at a time, so that a quarter patch can be drawn with the first quarter of the indices.
+    const int halfResolution = PATCH_RESOLUTION / 2;
+    vector<unsigned int> indices;
+    for (int quarter = 0; quarter < 4; quarter++) {
+        int firstColumn = (quarter % 2) * halfResolution;
+        int firstRow = (quarter / 2) * halfResolution;
+        createGridIndices(firstRow, firstColumn, halfResolution, halfResolution, vertexCountPerSide, BLOCK_INDEX_ORDER, VERTEX_CACHE_SIZE, indices);
+    }
+    indexCount = (int) indices.size();
+    quarterIndexCount = indexCount / 4;
+    vector<unsigned short> shortIndices;
+    convertToShortIndices(indices, shortIndices);
+    indexBufferObjectId = createIndexBufferObject(indexCount, &shortIndices[0]);
+
+    //the patch transform advances once per patch instead of once per vertex. It is attached to the patch buffer every frame.
+    glVertexAttribDivisor(PATCH_TRANSFORM_ATTRIBUTE_INDEX, 1);
+    glEnableVertexAttribArray(PATCH_TRANSFORM_ATTRIBUTE_INDEX);
+    patchCapacity = 64;
+    patchBuffer = new StreamingBuffer(GL_ARRAY_BUFFER, patchCapacity * PATCH_FLOAT_COUNT * sizeof(float));
+    patchBufferOffset = 0;
+    triangleCount = 0;
+
+    //the shader samples the surface heights at a lower resolution far away from the camera and calculates the normals itself.
+    heightTexture = new WaterSurfaceHeightTexture(waterSurface, true);
+    waterSurface->setNormalVectorsEnabled(false);
+
+    //init model matrix.
+    modelMatrix = createModelMatrix(waterSurface->getX(), waterSurface->getY(), waterSurface->getZ(), 0, 0, 0, 1, 1, 1);
+}
+
+LevelOfDetailWaterSurfaceView::~LevelOfDetailWaterSurfaceView() {
+    delete heightTexture;
+    delete patchBuffer;
+}
+
+float LevelOfDetailWaterSurfaceView::getDistance(int column, int row, int level, vec3 cameraPosition) {
+    //the patch on the flat surface (z = 0 in model space), clipped to the grid.
+    int cellCount = PATCH_RESOLUTION << level;
+    float xMin = (column - 0.5f * (columnCount - 1)) * dX;
+    float xMax = (std::min(column + cellCount, columnCount - 1) - 0.5f * (columnCount - 1)) * dX;
+    float yMin = (row - 0.5f * (rowCount - 1)) * dY;
+    float yMax = (std::min(row + cellCount, rowCount - 1) - 0.5f * (rowCount - 1)) * dY;
+
+    float distanceX = std::max(std::max(xMin - cameraPosition.x, cameraPosition.x - xMax), 0.0f);
+    float distanceY = std::max(std::max(yMin - cameraPosition.y, cameraPosition.y - yMax), 0.0f);
+    return sqrt(distanceX * distanceX + distanceY * distanceY + cameraPosition.z * cameraPosition.z);
+}
+
+bool LevelOfDetailWaterSurfaceView::isInFrustum(int column, int row, int level, const ViewFrustum& frustum) {
+    //the model matrix only translates.
+    int cellCount = PATCH_RESOLUTION << level;
+    vec3 translation = vec3(modelMatrix[3]);
+    vec3 minimum = vec3((column - 0.5f * (columnCount - 1)) * dX, (row - 0.5f * (rowCount - 1)) * dY, minZ);
+    vec3 maximum = vec3((std::min(column + cellCount, columnCount - 1) - 0.5f * (columnCount - 1)) * dX,
+                        (std::min(row + cellCount, rowCount - 1) - 0.5f * (rowCount - 1)) * dY, maxZ);
+    return frustum.intersects(minimum + translation, maximum + translation);
+}
+
+bool LevelOfDetailWaterSurfaceView::selectPatches(int column, int row, int level, vec3 cameraPosition, const ViewFrustum& frustum) {
+    if (column >= columnCount - 1 || row >= rowCount - 1) {
+        return true;//outside of the grid, nothing to draw.
+    }
+    if (!isInFrustum(column, row, level, frustum)) {
+        return true;//not visible, nothing to draw.
+    }
+
+    float distance = getDistance(column, row, level, cameraPosition);
+    if (distance >= lodRange * (1 << level)) {
+        return false;
+    }
+    if (level == 0 || distance >= lodRange * (1 << (level - 1))) {
+        //no part of this patch is in range of the next finer level.
+        addPatch(patches, column, row, level);
+        return true;
+    }
+
+    int halfCellCount = (PATCH_RESOLUTION << level) / 2;
+    for (int child = 0; child < 4; child++) {
+        int childColumn = column + (child % 2) * halfCellCount;
+        int childRow = row + (child / 2) * halfCellCount;
+        if (!selectPatches(childColumn, childRow, level - 1, cameraPosition, frustum)) {
+            addPatch(quarterPatches, childColumn, childRow, level);
+        }
+    }
+    return true;
+}
+
+void LevelOfDetailWaterSurfaceView::addPatch(vector<float>& patches, int column, int row, int level) {
+    patches.push_back((float) column);
+    patches.push_back((float) row);
+    patches.push_back((float) (1 << level));
+}
+
+void LevelOfDetailWaterSurfaceView::submit(const float* surfaceHeightValues, const unsigned int* tileVersions, unsigned int surfaceVersion, mat4 viewMatrix, const ViewFrustum& frustum, RenderQueue* renderQueue) {
+    heightTexture->update(surfaceHeightValues, tileVersions, surfaceVersion);
+
+    //select the patches for the camera position in model space. The root patch is always drawn if it is visible, also if the camera is far away.
+    vec3 cameraPosition = vec3(inverse(viewMatrix * modelMatrix)[3]);
+    patches.clear();
+    quarterPatches.clear();
+    if (!selectPatches(0, 0, levelCount - 1, cameraPosition, frustum)) {
+        addPatch(patches, 0, 0, levelCount - 1);
+    }
+    int patchCount = (int) patches.size() / PATCH_FLOAT_COUNT;
+    int quarterPatchCount = (int) quarterPatches.size() / PATCH_FLOAT_COUNT;
+    triangleCount = (patchCount * indexCount + quarterPatchCount * quarterIndexCount) / 3;
+
+    //write the patches directly to graphics card memory, first the whole patches, then the quarter patches.
+    if (patchCount + quarterPatchCount > patchCapacity) {
+        delete patchBuffer;
+        patchCapacity = std::max(patchCount + quarterPatchCount, 2 * patchCapacity);
+        patchBuffer = new StreamingBuffer(GL_ARRAY_BUFFER, patchCapacity * PATCH_FLOAT_COUNT * sizeof(float));
+    }
+    float* memory = (float*) patchBuffer->beginWrite();
+    memcpy(memory, patches.data(), patches.size() * sizeof(float));
+    memcpy(memory + patches.size(), quarterPatches.data(), quarterPatches.size() * sizeof(float));
+    patchBufferOffset = patchBuffer->endWrite();
+
+    //the water surface can be seen from below, so do not cull back faces.
+    renderQueue->submit(shader.getShaderProgramId(), vertexArrayObjectId, 0, this);
+}
+
+void LevelOfDetailWaterSurfaceView::draw() {
+    //prepare shader.
+    shader.setModelMatrix(modelMatrix);
+    heightTexture->bind(0);
+
+    //draw the whole patches and the quarter patches, each with one draw call.
+    int patchCount = (int) patches.size() / PATCH_FLOAT_COUNT;
+    int quarterPatchCount = (int) quarterPatches.size() / PATCH_FLOAT_COUNT;
+    glBindBuffer(GL_ARRAY_BUFFER, patchBuffer->getBufferObjectId());
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBufferObjectId);
+    if (patchCount > 0) {
+        glVertexAttribPointer(PATCH_TRANSFORM_ATTRIBUTE_INDEX, PATCH_FLOAT_COUNT, GL_FLOAT, GL_FALSE, 0, (void*) patchBufferOffset);
+        glDrawElementsInstanced(GL_TRIANGLES, indexCount, GL_UNSIGNED_SHORT, 0, patchCount);
+    }
+    if (quarterPatchCount > 0) {
+        GLintptr offset = patchBufferOffset + (GLintptr) patches.size() * sizeof(float);
+        glVertexAttribPointer(PATCH_TRANSFORM_ATTRIBUTE_INDEX, PATCH_FLOAT_COUNT, GL_FLOAT, GL_FALSE, 0, (void*) offset);
+        glDrawElementsInstanced(GL_TRIANGLES, quarterIndexCount, GL_UNSIGNED_SHORT, 0, quarterPatchCount);
+    }
+
+    //the streaming buffer regions of this frame can be reused as soon as the graphics card has finished drawing.
+    patchBuffer->endRead();
+    heightTexture->endRead();
+}
+
+int LevelOfDetailWaterSurfaceView::getTriangleCount() {
+    return triangleCount;
+}
@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2018 A.C. Kockx, All Rights Reserved.
+ */
+
+#include "model/WaterSurface.h"
+#include "model/SimulationBoundaries.h"
+#include "shader/LevelOfDetailPhongShader.h"
+#include "util/StreamingBuffer.h"
+#include "util/RenderQueue.h"
+#include "util/ViewFrustum.h"
+#include "view/WaterSurfaceHeightTexture.h"
+
+#ifndef INCLUDED_LEVELOFDETAILWATERSURFACEVIEW_H
+#define INCLUDED_LEVELOFDETAILWATERSURFACEVIEW_H
+
+/**
+ * Draws a WaterSurface using OpenGL with a continuous level of detail (CDLOD), so that the number of triangles does not
+ * depend on the resolution of the simulation grid, but only on the distance between the camera and the water surface.
+ *
+ * The grid is divided into a quadtree of square patches. A patch of level L covers PATCH_RESOLUTION * 2^L grid cells per side,
+ * but is always drawn with the same PATCH_RESOLUTION x PATCH_RESOLUTION quads, so it has 2^L grid cells between adjacent vertices.
+ * The root of the quadtree is a single patch that covers the whole grid. Every frame, a patch is split into its 4 children
+ * as long as (part of) it is closer to the camera than the range of the level of its children. The range of a level is
+ * twice the range of the previous level, so the patches become coarser with the distance from the camera. Children that
+ * are out of range of their own level are drawn as a quarter of their parent instead. Patches that are outside of the view frustum
+ * are skipped together with all their children, so the quadtree also serves as a bounding volume hierarchy over the water surface.
+ *
+ * All patches are instances of one vertex grid and are drawn with two instanced draw calls per frame (whole patches and quarter
+ * patches). The surface heights are read from a height texture with mipmaps, at the mipmap level that matches the level of each patch.
+ * Towards the end of the range of a level, the vertices of its patches gradually move onto the vertex grid of the next level
+ * and the heights are blended into the next mipmap level, so that the seams between levels have no cracks, see LevelOfDetailPhongShader.
+ */
+class LevelOfDetailWaterSurfaceView : public DrawableInterface {
+    private:
+        WaterSurface* waterSurface;
+        mat4 modelMatrix;
+        int rowCount;
+        int columnCount;
+        float dX;//distance between adjacent columns in model space.
+        float dY;//distance between adjacent rows in model space.
+        int levelCount;//the patch of level levelCount - 1 covers the whole grid.
+        float lodRange;//distance from the camera up to which the patches of level 0 are drawn, doubles per level.
+        float minZ;//minimum z displacement in model space, the surface heights stay within the simulation boundaries.
+        float maxZ;//maximum z displacement in model space.
+
+        //geometry, shared by all patches.
+        GLuint vertexArrayObjectId;
+        GLuint indexBufferObjectId;
+        int indexCount;//of a whole patch.
+        int quarterIndexCount;//of a quarter patch, the indices of the south-west quarter come first.
+
+        //patches of the current frame, with PATCH_FLOAT_COUNT floats per patch: first column and row in the grid and number of grid cells between adjacent vertices.
+        vector<float> patches;
+        vector<float> quarterPatches;
+        StreamingBuffer* patchBuffer;
+        int patchCapacity;//number of patches that fit in patchBuffer.
+        GLintptr patchBufferOffset;//offset of the patches of the current frame in patchBuffer.
+        int triangleCount;//of the current frame.
+
+        //material.
+        WaterSurfaceHeightTexture* heightTexture;
+        float waterColor[3] = {0, 0, 1};//blue.
+        LevelOfDetailPhongShader shader;
+
+        //returns the distance from the given camera position (in model space) to the patch at the given column and row of the given level.
+        float getDistance(int column, int row, int level, vec3 cameraPosition);
+
+        //returns true if the bounding box of the patch at the given column and row of the given level intersects the given frustum (in world space).
+        bool isInFrustum(int column, int row, int level, const ViewFrustum& frustum);
+
+        //adds the visible patches that cover the patch at the given column and row of the given level to this frame and returns true,
+        //or returns false if the patch is out of range of its level, so that its parent must cover it instead.
+        bool selectPatches(int column, int row, int level, vec3 cameraPosition, const ViewFrustum& frustum);
+
+        void addPatch(vector<float>& patches, int column, int row, int level);
+
+    public:
+        static const int PATCH_RESOLUTION = 32;//number of quads per side of a patch, must be a multiple of 4.
+        static const int PATCH_FLOAT_COUNT = 3;
+
+        /**
+         * Creates the geometry that is needed to draw the given waterSurface, whose heights stay within the given bounds.
+         * The water surface no longer calculates normal vectors for all vertices every time step, since the shader calculates them.
+         */
+        LevelOfDetailWaterSurfaceView(WaterSurface* waterSurface, SimulationBoundaries* bounds);
+
+        ~LevelOfDetailWaterSurfaceView();
+
+        /**
+         * Sends the given surface heights (see WaterSurface::getSurfaceHeightValues) to the graphics card, e.g. from a SimulationSnapshot,
+         * selects the patches for the camera of the given view matrix that are in the given view frustum (in world space)
+         * and submits a draw packet that draws them to the given queue.
+         * tileVersions and surfaceVersion must be the tile versions and the surface version of the given data (see WaterSurface::getTileVersions).
+         */
+        void submit(const float* surfaceHeightValues, const unsigned int* tileVersions, unsigned int surfaceVersion, mat4 viewMatrix, const ViewFrustum& frustum, RenderQueue* renderQueue);
+
+        /**
+         * Draws the selected patches, see DrawableInterface.
+         */
+        virtual void draw();
+
+        /**
+         * Returns the number of triangles that were submitted by the last call to submit.
+         */
+        int getTriangleCount();
+};
+
+#endif
@@ -0,0 +1,34 @@
+/*
+ * Copyright (c) 2018 A.C. Kockx, All Rights Reserved.
+ */
+
+#include "util/ModelUtils.h"
+#include "model/ObjectInterface.h"
+#include "scene/SimulationSnapshot.h"
+#include "util/RenderQueue.h"
+
+#ifndef INCLUDED_OBJECTVIEWINTERFACE_H
+#define INCLUDED_OBJECTVIEWINTERFACE_H
+
+/**
+ * Interface for classes that draw all objects (see ObjectInterface) of one type using OpenGL.
+ * Objects of the same type share the same mesh, so a view can draw all of them at once, e.g. with instanced rendering.
+ */
+class ObjectViewInterface {
+    public:
+        /**
+         * Adds the given object to the objects that this view draws. objectIndex is the index of the object in Simulation::getObjects,
+         * which is also its index in a SimulationSnapshot.
+         */
+        virtual void addObject(ObjectInterface* object, int objectIndex) = 0;
+
+        /**
+         * Submits the draw packets that draw the objects of this view at their positions in the given snapshot to the given queue.
+         * Objects for which objectVisibilities (indexed like the snapshot) is false are outside of the view frustum and are skipped.
+         */
+        virtual void submit(const SimulationSnapshot* snapshot, const vector<bool>& objectVisibilities, RenderQueue* renderQueue) = 0;
+
+        virtual ~ObjectViewInterface() {}
+};
+
+#endif
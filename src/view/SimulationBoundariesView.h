@@ -0,0 +1,44 @@
+/*
+ * Copyright (c) 2018 A.C. Kockx, All Rights Reserved.
+ */
+
+#include "model/SimulationBoundaries.h"
+#include "shader/BasicShader.h"
+#include "util/RenderQueue.h"
+
+#ifndef INCLUDED_SIMULATIONBOUNDARIESVIEW_H
+#define INCLUDED_SIMULATIONBOUNDARIESVIEW_H
+
+/**
+ * Draws SimulationBoundaries as a wireframe box using OpenGL.
+ */
+class SimulationBoundariesView : public DrawableInterface {
+    private:
+        mat4 modelMatrix;
+
+        //geometry.
+        GLuint vertexArrayObjectId;
+        GLuint indexBufferObjectId;
+        int indexCount;
+
+        //material.
+        BasicShader shader = BasicShader();
+
+    public:
+        /**
+         * Creates the geometry that is needed to draw the given bounds.
+         */
+        SimulationBoundariesView(SimulationBoundaries* bounds);
+
+        /**
+         * Submits a draw packet that draws the boundaries to the given queue.
+         */
+        void submit(RenderQueue* renderQueue);
+
+        /**
+         * Draws the lines of the boundaries, see DrawableInterface.
+         */
+        virtual void draw();
+};
+
+#endif
@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2018 A.C. Kockx, All Rights Reserved.
+ */
+
+#include "view/WaterSurfaceHeightTexture.h"
+
+#include <algorithm>
+
+#include "util/Profiler.h"
+
+WaterSurfaceHeightTexture::WaterSurfaceHeightTexture(WaterSurface* waterSurface, bool mipmapsEnabled) {
+    this->waterSurface = waterSurface;
+    this->mipmapsEnabled = mipmapsEnabled;
+    int rowCount = waterSurface->getRowCount();
+    int columnCount = waterSurface->getColumnCount();
+    int rowPitch = waterSurface->getRowPitch();
+
+    //one texel per vertex. The surface heights have padding at the end of each row, which is skipped while uploading,
+    //so that the padding does not end up in the mipmaps.
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, rowPitch);
+    textureId = createFloatTexture(columnCount, rowCount, waterSurface->getSurfaceHeightValues());
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    if (mipmapsEnabled) {
+        int levelCount = 1;
+        while ((std::max(rowCount, columnCount) >> levelCount) > 0) {
+            levelCount++;
+        }
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levelCount - 1);
+        glGenerateMipmap(GL_TEXTURE_2D);
+    }
+
+    //the buffer uses the same padded row layout as the surface heights, so that the changed vertices can be copied in one go.
+    buffer = new StreamingBuffer(GL_PIXEL_UNPACK_BUFFER, rowCount * rowPitch * sizeof(float));
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    version = 0;
+}
+
+WaterSurfaceHeightTexture::~WaterSurfaceHeightTexture() {
+    delete buffer;
+    glDeleteTextures(1, &textureId);
+}
+
+void WaterSurfaceHeightTexture::update(const float* surfaceHeightValues, const unsigned int* tileVersions, unsigned int surfaceVersion) {
+    if (version == surfaceVersion) {
+        return;
+    }
+    ProfilerScope scope("updateHeightTexture");
+
+    //copy the z displacements that changed since the last update of the texture directly to graphics card memory,
+    //then let the graphics card copy them from there to the texture, one rectangle per tile row.
+    float* memory = (float*) buffer->beginWrite();
+    waterSurface->copyChangedVertices(tileVersions, version, false, surfaceHeightValues, memory);
+    GLintptr offset = buffer->endWrite();
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, textureId);
+    int rowPitch = waterSurface->getRowPitch();
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, rowPitch);
+    for (int tileRow = 0; tileRow < waterSurface->getTileRowCount(); tileRow++) {
+        int beginColumn, endColumn;
+        waterSurface->getChangedColumnRange(tileVersions, version, tileRow, false, beginColumn, endColumn);
+        if (endColumn > beginColumn) {
+            int beginRow = waterSurface->getTileBeginRow(tileRow);
+            int endRow = waterSurface->getTileBeginRow(tileRow + 1);
+            GLintptr rectangleOffset = offset + (GLintptr) (beginRow * rowPitch + beginColumn) * sizeof(float);
+            glTexSubImage2D(GL_TEXTURE_2D, 0, beginColumn, beginRow, endColumn - beginColumn, endRow - beginRow, GL_RED, GL_FLOAT, (void*) rectangleOffset);
+        }
+    }
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    //unbind, otherwise other texture uploads would also read from this buffer.
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    if (mipmapsEnabled) {
+        glGenerateMipmap(GL_TEXTURE_2D);
+    }
+    version = surfaceVersion;
+}
+
+void WaterSurfaceHeightTexture::bind(int textureUnit) {
+    glActiveTexture(GL_TEXTURE0 + textureUnit);
+    glBindTexture(GL_TEXTURE_2D, textureId);
+}
+
+void WaterSurfaceHeightTexture::endRead() {
+    //the streaming buffer region of this frame can be reused as soon as the graphics card has finished drawing (also if it was not written this frame).
+    buffer->endRead();
+}
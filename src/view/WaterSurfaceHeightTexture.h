@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2018 A.C. Kockx, All Rights Reserved.
+ */
+
+#include "model/WaterSurface.h"
+#include "util/StreamingBuffer.h"
+
+#ifndef INCLUDED_WATERSURFACEHEIGHTTEXTURE_H
+#define INCLUDED_WATERSURFACEHEIGHTTEXTURE_H
+
+/**
+ * Single-channel float texture with the surface heights of a WaterSurface, one texel per vertex (columnCount x rowCount texels).
+ * Only the tiles of the water surface that changed since the texture was last written are sent to the graphics card,
+ * via a streaming pixel unpack buffer, see WaterSurface::getTileVersions and StreamingBuffer.
+ *
+ * Optionally the texture has mipmaps, so that a shader can sample the surface heights at a lower resolution,
+ * e.g. for parts of the surface that are far away from the camera. The mipmaps are regenerated by the graphics card
+ * every time the texture changes.
+ *
+ * Usage per frame: call update, bind the texture, issue the draw calls that read it and then call endRead.
+ */
+class WaterSurfaceHeightTexture {
+    private:
+        WaterSurface* waterSurface;
+        GLuint textureId;
+        bool mipmapsEnabled;
+        StreamingBuffer* buffer;
+        unsigned int version;//surface version of the data in the texture, 0 if none.
+
+    public:
+        /**
+         * Creates a texture with the current surface heights of the given waterSurface.
+         */
+        WaterSurfaceHeightTexture(WaterSurface* waterSurface, bool mipmapsEnabled);
+
+        ~WaterSurfaceHeightTexture();
+
+        /**
+         * Updates the texture to the given surface heights (see WaterSurface::getSurfaceHeightValues), e.g. from a SimulationSnapshot.
+         * tileVersions and surfaceVersion must be the tile versions and the surface version of the given data (see WaterSurface::getTileVersions).
+         */
+        void update(const float* surfaceHeightValues, const unsigned int* tileVersions, unsigned int surfaceVersion);
+
+        /**
+         * Binds the texture to the given texture unit.
+         */
+        void bind(int textureUnit);
+
+        /**
+         * Must be called after the draw calls that read the texture in the current frame have been issued.
+         */
+        void endRead();
+};
+
+#endif
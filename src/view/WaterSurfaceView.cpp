@@ -0,0 +1,177 @@
+/*
+ * Copyright (c) 2018 A.C. Kockx, All Rights Reserved.
+ */
+
+#include "view/WaterSurfaceView.h"
+
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "util/ModelUtils.h"
+#include "util/OpenGLUtils.h"
+#include "util/Profiler.h"
+
+WaterSurfaceView::WaterSurfaceView(WaterSurface* waterSurface, SimulationBoundaries* bounds, int displacementType) : shader(0.9f, 15, displacementType) {
+    this->waterSurface = waterSurface;
+    this->displacementType = displacementType;
+    int rowCount = waterSurface->getRowCount();
+    int columnCount = waterSurface->getColumnCount();
+    int rowPitch = waterSurface->getRowPitch();
+    //the vertex buffers use the same padded row layout as the surface heights, so that the heights can be copied in one go.
+    vertexCount = rowCount * rowPitch;
+
+    //create geometry.
+    vector<float> vertices = vector<float>(vertexCount * dimensionCount);//vertex coordinates (x, y, z) in model space.
+    vector<float> normals = vector<float>(vertexCount * dimensionCount);//vertex normal vectors (x, y, z) in model space.
+    vector<float> colors(vertexCount * dimensionCount);//vertex colors (r, g, b).
+    createHorizontal2DGrid(rowCount, columnCount, rowPitch, waterSurface->getXSize(), waterSurface->getYSize(), waterColor, vertices, normals, colors);
+
+    //create vertex array object.
+    glGenVertexArrays(1, &vertexArrayObjectId);
+    glBindVertexArray(vertexArrayObjectId);
+    createVertexBufferObject(0, vertexCount, dimensionCount, &vertices[0], GL_STATIC_DRAW);
+    createVertexBufferObject(2, vertexCount, dimensionCount, &colors[0], GL_STATIC_DRAW);
+    if (displacementType == HEIGHT_TEXTURE_DISPLACEMENT_TYPE) {
+        //the shader reads one texel per vertex with texelFetch, so no mipmaps are needed.
+        heightTexture = new WaterSurfaceHeightTexture(waterSurface, false);
+        shader.setGrid(rowCount, columnCount, rowPitch, waterSurface->getXSize() / (columnCount - 1), waterSurface->getYSize() / (rowCount - 1));
+        //the normals are calculated by the shader.
+        waterSurface->setNormalVectorsEnabled(false);
+    } else {
+        //the buffers are filled and attached to the attributes every frame.
+        normalsBuffer = new StreamingBuffer(GL_ARRAY_BUFFER, vertexCount * dimensionCount * sizeof(float));
+        glEnableVertexAttribArray(1);
+        zDisplacementsBuffer = new StreamingBuffer(GL_ARRAY_BUFFER, vertexCount * sizeof(float));
+        glEnableVertexAttribArray(3);
+        normalsRegionVersions.assign(normalsBuffer->getRegionCount(), 0);
+        zDisplacementsRegionVersions.assign(zDisplacementsBuffer->getRegionCount(), 0);
+    }
+
+    //create index buffer object: the indices of a band, and of the last band if it has fewer rows.
+    int quadRowCount = rowCount - 1;
+    int bandQuadRowCount = std::min(getMaxShortIndexQuadRowCount(columnCount, rowPitch), quadRowCount);
+    if (bandQuadRowCount == 0) {
+        fprintf(stderr, "Water surface rows are too long for 16-bit indices: %i\n", rowPitch);
+        glfwTerminate();
+        exit(-1);
+    }
+    bandCount = (quadRowCount + bandQuadRowCount - 1) / bandQuadRowCount;
+    bandVertexCount = bandQuadRowCount * rowPitch;
+    int lastBandQuadRowCount = quadRowCount - (bandCount - 1) * bandQuadRowCount;
+    vector<unsigned int> indices;
+    createGridIndices(0, 0, bandQuadRowCount, columnCount - 1, rowPitch, BLOCK_INDEX_ORDER, VERTEX_CACHE_SIZE, indices);
+    bandIndexCount = (int) indices.size();
+    if (lastBandQuadRowCount < bandQuadRowCount) {
+        createGridIndices(0, 0, lastBandQuadRowCount, columnCount - 1, rowPitch, BLOCK_INDEX_ORDER, VERTEX_CACHE_SIZE, indices);
+    }
+    lastBandIndexCount = (int) indices.size() - (lastBandQuadRowCount < bandQuadRowCount ? bandIndexCount : 0);
+    lastBandIndexOffset = (GLintptr) (indices.size() - lastBandIndexCount) * sizeof(unsigned short);
+    vector<unsigned short> shortIndices;
+    convertToShortIndices(indices, shortIndices);
+    indexBufferObjectId = createIndexBufferObject((int) shortIndices.size(), &shortIndices[0]);
+
+    //bounding box per band: the surface heights stay within the simulation boundaries.
+    BoundingBox box = bounds->getBoundingBox();
+    float dY = waterSurface->getYSize() / (rowCount - 1);
+    float yMin = waterSurface->getY() - 0.5f * waterSurface->getYSize();
+    for (int band = 0; band < bandCount; band++) {
+        int endRow = std::min((band + 1) * bandQuadRowCount, quadRowCount);
+        bandMinimums.push_back(vec3(waterSurface->getX() - 0.5f * waterSurface->getXSize(), yMin + band * bandQuadRowCount * dY, box.getMinZ()));
+        bandMaximums.push_back(vec3(waterSurface->getX() + 0.5f * waterSurface->getXSize(), yMin + endRow * dY, box.getMaxZ()));
+    }
+    bandVisibilities.assign(bandCount, true);
+
+    //init model matrix.
+    modelMatrix = createModelMatrix(waterSurface->getX(), waterSurface->getY(), waterSurface->getZ(), 0, 0, 0, 1, 1, 1);
+}
+
+WaterSurfaceView::~WaterSurfaceView() {
+    if (displacementType == HEIGHT_TEXTURE_DISPLACEMENT_TYPE) {
+        delete heightTexture;
+    } else {
+        delete normalsBuffer;
+        delete zDisplacementsBuffer;
+    }
+}
+
+void WaterSurfaceView::updateZDisplacements(const float* surfaceHeightValues, const unsigned int* tileVersions, unsigned int surfaceVersion) {
+    //if the region of the previous frame already contains this version, then draw it again.
+    if (zDisplacementsRegionVersions[zDisplacementsBuffer->getRegionIndex()] == surfaceVersion) {
+        return;
+    }
+    ProfilerScope scope("updateZDisplacements");
+
+    //copy the z displacements that changed since the next region was written directly to graphics card memory.
+    float* memory = (float*) zDisplacementsBuffer->beginWrite();
+    unsigned int& regionVersion = zDisplacementsRegionVersions[zDisplacementsBuffer->getRegionIndex()];
+    unsigned int sinceVersion = zDisplacementsBuffer->isPersistentlyMapped() ? regionVersion : 0;
+    waterSurface->copyChangedVertices(tileVersions, sinceVersion, false, surfaceHeightValues, memory);
+    regionVersion = surfaceVersion;
+    glBindVertexArray(vertexArrayObjectId);
+    GLintptr offset = zDisplacementsBuffer->endWrite();
+    glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, 0, (void*) offset);
+}
+
+void WaterSurfaceView::updateNormalVectors(const float* normalVectors, const unsigned int* tileVersions, unsigned int surfaceVersion) {
+    //the same as updateZDisplacements.
+    if (normalsRegionVersions[normalsBuffer->getRegionIndex()] == surfaceVersion) {
+        return;
+    }
+    ProfilerScope scope("updateNormalVectors");
+
+    float* memory = (float*) normalsBuffer->beginWrite();
+    unsigned int& regionVersion = normalsRegionVersions[normalsBuffer->getRegionIndex()];
+    unsigned int sinceVersion = normalsBuffer->isPersistentlyMapped() ? regionVersion : 0;
+    waterSurface->copyChangedVertices(tileVersions, sinceVersion, true, normalVectors, memory);
+    regionVersion = surfaceVersion;
+    glBindVertexArray(vertexArrayObjectId);
+    GLintptr offset = normalsBuffer->endWrite();
+    glVertexAttribPointer(1, dimensionCount, GL_FLOAT, GL_FALSE, 0, (void*) offset);
+}
+
+void WaterSurfaceView::submit(const float* surfaceHeightValues, const float* normalVectors, const unsigned int* tileVersions, unsigned int surfaceVersion, const ViewFrustum& frustum, RenderQueue* renderQueue) {
+    if (displacementType == HEIGHT_TEXTURE_DISPLACEMENT_TYPE) {
+        heightTexture->update(surfaceHeightValues, tileVersions, surfaceVersion);
+    } else {
+        updateZDisplacements(surfaceHeightValues, tileVersions, surfaceVersion);
+        updateNormalVectors(normalVectors, tileVersions, surfaceVersion);
+    }
+
+    for (int band = 0; band < bandCount; band++) {
+        bandVisibilities[band] = frustum.intersects(bandMinimums[band], bandMaximums[band]);
+    }
+
+    //the water surface can be seen from below, so do not cull back faces.
+    renderQueue->submit(shader.getShaderProgramId(), vertexArrayObjectId, 0, this);
+}
+
+void WaterSurfaceView::draw() {
+    //prepare shader.
+    shader.setModelMatrix(modelMatrix);
+
+    //draw triangles.
+    if (displacementType == HEIGHT_TEXTURE_DISPLACEMENT_TYPE) {
+        heightTexture->bind(0);
+    }
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBufferObjectId);
+    for (int band = 0; band < bandCount; band++) {
+        if (!bandVisibilities[band]) {
+            continue;
+        }
+        if (band < bandCount - 1) {
+            glDrawElementsBaseVertex(GL_TRIANGLES, bandIndexCount, GL_UNSIGNED_SHORT, 0, band * bandVertexCount);
+        } else {
+            glDrawElementsBaseVertex(GL_TRIANGLES, lastBandIndexCount, GL_UNSIGNED_SHORT, (void*) lastBandIndexOffset, band * bandVertexCount);
+        }
+    }
+
+    //the streaming buffer regions of this frame can be reused as soon as the graphics card has finished drawing (also if they were not written this frame).
+    if (displacementType == HEIGHT_TEXTURE_DISPLACEMENT_TYPE) {
+        heightTexture->endRead();
+    } else {
+        zDisplacementsBuffer->endRead();
+        normalsBuffer->endRead();
+    }
+}
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2018 A.C. Kockx, All Rights Reserved.
+ */
+
+#include "model/WaterSurface.h"
+#include "model/SimulationBoundaries.h"
+#include "shader/DisplacedZPhongShader.h"
+#include "util/StreamingBuffer.h"
+#include "view/WaterSurfaceHeightTexture.h"
+#include "util/RenderQueue.h"
+#include "util/ViewFrustum.h"
+
+#ifndef INCLUDED_WATERSURFACEVIEW_H
+#define INCLUDED_WATERSURFACEVIEW_H
+
+/**
+ * Draws a WaterSurface using OpenGL.
+ * The surface heights are sent to the graphics card every frame, either as a vertex attribute together with
+ * the normal vectors that are calculated on the CPU, or as a height texture from which the normal vectors are
+ * calculated on the graphics card, see DisplacedZPhongShader. The data is written to streaming buffers,
+ * so that the graphics card can still draw the previous frame in the meantime.
+ * Only the tiles of the water surface that changed since the data in graphics card memory was written are sent,
+ * see WaterSurface::getTileVersions, so nothing is sent while the water surface is flat.
+ * The triangles are ordered for the post-transform vertex cache of the graphics card, see BLOCK_INDEX_ORDER.
+ * Bands of rows that are outside of the view frustum are not drawn.
+ */
+class WaterSurfaceView : public DrawableInterface {
+    private:
+        WaterSurface* waterSurface;
+        mat4 modelMatrix;
+
+        //geometry.
+        //vertices are in 3D, i.e. 3 coordinates together form 1 vertex.
+        const GLint dimensionCount = 3;
+        int vertexCount;//including the padding vertices at the end of each row, see WaterSurface::getRowPitch.
+        GLuint vertexArrayObjectId;
+        StreamingBuffer* normalsBuffer;//only used with VERTEX_ATTRIBUTE_DISPLACEMENT_TYPE.
+        StreamingBuffer* zDisplacementsBuffer;//only used with VERTEX_ATTRIBUTE_DISPLACEMENT_TYPE.
+        vector<unsigned int> normalsRegionVersions;//per region of normalsBuffer: surface version of its data, 0 if none.
+        vector<unsigned int> zDisplacementsRegionVersions;//per region of zDisplacementsBuffer: surface version of its data, 0 if none.
+        WaterSurfaceHeightTexture* heightTexture;//only used with HEIGHT_TEXTURE_DISPLACEMENT_TYPE.
+        //the triangles are drawn in horizontal bands of rows with 16-bit indices, one draw call per band with the first vertex of the band as base vertex.
+        //All bands share the same indices, except for the last band if it has fewer rows, whose indices follow those of the other bands.
+        GLuint indexBufferObjectId;
+        int bandCount;
+        int bandVertexCount;//number of vertices between the first vertices of adjacent bands.
+        int bandIndexCount;
+        int lastBandIndexCount;
+        GLintptr lastBandIndexOffset;//in bytes.
+        vector<vec3> bandMinimums;//per band: minimum of its bounding box in world space.
+        vector<vec3> bandMaximums;//per band: maximum of its bounding box in world space.
+        vector<bool> bandVisibilities;//per band: true if its bounding box intersects the view frustum of the current frame.
+
+        //material.
+        int displacementType;
+        DisplacedZPhongShader shader;
+        float waterColor[3] = {0, 0, 1};//blue.
+
+        //update z displacements or normals in graphics card memory to the given surface version.
+        void updateZDisplacements(const float* surfaceHeightValues, const unsigned int* tileVersions, unsigned int surfaceVersion);
+        void updateNormalVectors(const float* normalVectors, const unsigned int* tileVersions, unsigned int surfaceVersion);
+
+    public:
+        /**
+         * Creates the geometry that is needed to draw the given waterSurface, whose heights stay within the given bounds.
+         * displacementType determines how the surface heights are sent to the graphics card, see DisplacedZPhongShader.
+         * With HEIGHT_TEXTURE_DISPLACEMENT_TYPE the water surface no longer calculates normal vectors for all vertices every time step.
+         */
+        WaterSurfaceView(WaterSurface* waterSurface, SimulationBoundaries* bounds, int displacementType);
+
+        ~WaterSurfaceView();
+
+        /**
+         * Sends the given surface heights and normal vectors (see WaterSurface::getSurfaceHeightValues and WaterSurface::getNormalVectors)
+         * to the graphics card, e.g. from a SimulationSnapshot, and submits a draw packet that draws the part of the water surface
+         * in the given view frustum (in world space) to the given queue.
+         * tileVersions and surfaceVersion must be the tile versions and the surface version of the given data (see WaterSurface::getTileVersions).
+         * normalVectors is only used with VERTEX_ATTRIBUTE_DISPLACEMENT_TYPE.
+         */
+        void submit(const float* surfaceHeightValues, const float* normalVectors, const unsigned int* tileVersions, unsigned int surfaceVersion, const ViewFrustum& frustum, RenderQueue* renderQueue);
+
+        /**
+         * Draws the triangles of the visible bands of the water surface, see DrawableInterface.
+         */
+        virtual void draw();
+};
+
+#endif